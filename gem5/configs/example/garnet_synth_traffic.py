@@ -50,7 +50,25 @@ Options.addNoISAOptions(parser)
 parser.add_option("--synthetic", type="choice", default="uniform_random",
                   choices=['uniform_random', 'tornado', 'bit_complement', \
                            'bit_reverse', 'bit_rotation', 'neighbor', \
-                            'shuffle', 'transpose'])
+                            'shuffle', 'transpose', 'hotspot', \
+                            'permutation', 'rate_matrix'])
+parser.add_option("--hotspot-nodes", type="string", default="",
+                  help="Comma separated destinations of hotspot traffic.")
+parser.add_option("--hotspot-fraction", type="float", default=0.0,
+                  help="Fraction of hotspot traffic sent to the hotspot\
+                        nodes; the rest is uniform random.")
+parser.add_option("--permutation-file", type="string", default="",
+                  help="Destination of each source, in order, for\
+                        permutation traffic.")
+parser.add_option("--rate-matrix-file", type="string", default="",
+                  help="num-dirs x num-dirs packets/cycle (one row per\
+                        source) for rate_matrix traffic. Overrides\
+                        --injectionrate.")
+parser.add_option("--burst-on-cycles", type="float", default=0,
+                  help="Mean on period of bursty (on/off) injection, with\
+                        the same average rate. 0 disables bursts.")
+parser.add_option("--burst-off-cycles", type="float", default=0,
+                  help="Mean off period of bursty injection.")
 
 parser.add_option("-i", "--injectionrate", type="float", default=0.1,
                   metavar="I",
@@ -81,6 +99,31 @@ parser.add_option("--inj-vnet", type="int", default=-1,
                   help="Only inject in this vnet (0, 1 or 2).\
                         0 and 1 are 1-flit, 2 is 5-flit.\
                         Set to -1 to inject randomly in all vnets.")
+parser.add_option("--skip-ahead", type="int", default=0,
+                  help="0: an injection trial every cycle per node.\
+                        1: sample the gap to the next injection and only\
+                        wake up then (much cheaper at low load).\
+                        2: as 1, with the same packets as 0 for a seed.")
+parser.add_option("--direct-injection", action="store_true", default=False,
+                  help="Generate the traffic right at the network interfaces\
+                        (GarnetTrafficSource) instead of through the\
+                        testers, sequencers and controllers. The testers\
+                        only end the simulation after --sim-cycles.")
+parser.add_option("--closed-loop-window", type="int", default=0,
+                  help="Closed-loop traffic (needs --direct-injection):\
+                        every packet is a request answered by its\
+                        destination, with at most this many requests in\
+                        flight per source. 0 is open loop.")
+parser.add_option("--service-cycles", type="int", default=1,
+                  help="Cycles a destination takes to answer a\
+                        closed-loop request.")
+parser.add_option("--service-queue-depth", type="int", default=16,
+                  help="Closed-loop requests a destination serves at\
+                        once; further requests wait in the network.\
+                        0 is no limit.")
+parser.add_option("--response-vnet", type="int", default=-1,
+                  help="Vnet of the closed-loop responses.\
+                        Set to -1 for the data (response) vnet.")
 parser.add_option("--sim-type", type="int", default=1,
                   help="to run the garnet simulation in default mode\
                   or run it in warm-up -- cool-down mode.")
@@ -105,17 +148,38 @@ if options.inj_vnet > 2:
           "or 2 (5-flit) or -1 (random)" % (options.inj_vnet))
     sys.exit(1)
 
+# the traffic pattern, for the testers or the direct traffic sources;
+# the coordinate based patterns lay the destinations out as the mesh
+pattern = dict(traffic_type=options.synthetic,
+               num_rows=options.mesh_rows,
+               hotspot_nodes=[int(n) for n in options.hotspot_nodes.split(",")
+                              if n != ""],
+               hotspot_fraction=options.hotspot_fraction,
+               permutation_file=options.permutation_file,
+               rate_matrix_file=options.rate_matrix_file,
+               burst_on_cycles=options.burst_on_cycles,
+               burst_off_cycles=options.burst_off_cycles)
+tester_pattern = pattern
+tester_skip_ahead = options.skip_ahead
+if options.direct_injection:
+    tester_pattern = dict(traffic_type="uniform_random")
+    # the testers never inject: with skip-ahead they only wake up
+    # to end the simulation rather than every cycle
+    tester_skip_ahead = 1
 
 cpus = [ GarnetSyntheticTraffic(
                      num_packets_max=options.num_packets_max,
                      single_sender=options.single_sender_id,
                      single_dest=options.single_dest_id,
                      sim_cycles=options.sim_cycles,
-                     traffic_type=options.synthetic,
-                     inj_rate=options.injectionrate,
+                     inj_rate=(0 if options.direct_injection
+                               else options.injectionrate),
                      inj_vnet=options.inj_vnet,
                      precision=options.precision,
-                     num_dest=options.num_dirs) \
+                     skip_ahead=tester_skip_ahead,
+                     rng_seed=options.garnet_rng_seed,
+                     num_dest=options.num_dirs,
+                     **tester_pattern) \
          for i in range(options.num_cpus) ]
 
 # create the desired simulated system
@@ -134,6 +198,35 @@ Ruby.create_system(options, False, system)
 system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
                                         voltage_domain = system.voltage_domain)
 
+# The cpus' L1 controllers come first in the network interfaces,
+# followed by the directories (see ruby/Garnet_standalone.py)
+if options.closed_loop_window > 0 and not options.direct_injection:
+    print("Error: --closed-loop-window needs --direct-injection")
+    sys.exit(1)
+
+if options.direct_injection:
+    if options.network != "garnet2.0":
+        print("Error: --direct-injection needs --network=garnet2.0")
+        sys.exit(1)
+    for i in range(options.num_cpus):
+        system.ruby.network.netifs[i].traffic_source = GarnetTrafficSource(
+                     num_packets_max=options.num_packets_max,
+                     single_dest=options.single_dest_id,
+                     inj_rate=options.injectionrate,
+                     inj_vnet=options.inj_vnet,
+                     precision=options.precision,
+                     skip_ahead=options.skip_ahead,
+                     num_dest=options.num_dirs,
+                     dest_base=options.num_cpus,
+                     max_outstanding=options.closed_loop_window,
+                     service_cycles=options.service_cycles,
+                     response_vnet=options.response_vnet,
+                     **pattern)
+        if options.single_sender_id >= 0 and i != options.single_sender_id:
+            system.ruby.network.netifs[i].traffic_source.num_packets_max = 0
+    for netif in system.ruby.network.netifs:
+        netif.service_queue_depth = options.service_queue_depth
+
 i = 0
 for ruby_port in system.ruby._cpu_ports:
      #
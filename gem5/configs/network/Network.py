@@ -44,9 +44,14 @@ def define_options(parser):
     parser.add_option("--network-trace-enable", action="store_true", default=False,
                        help="enable trace simulation")
     parser.add_option("--network-trace-file", type="string", default=" ",
-                       help="name of trace file")
+                       help="""name of trace file: text, or binary if
+                            named *.gntr (see util/encode_network_trace.py);
+                            gzipped if named *.gz""")
     parser.add_option("--network-trace-max-packets", type="int", default=-1,
                       help="maximum packets in trace to inject")
+    parser.add_option("--network-trace-buffer-packets", type="int",
+                      default=65536,
+                      help="trace packets read ahead of the simulation")
     parser.add_option("--router-latency", action="store", type="int",
                       default=1,
                       help="""number of pipeline stages in the garnet router.
@@ -60,16 +65,43 @@ def define_options(parser):
                             in the topology file.""")
     parser.add_option("--link-width-bits", action="store", type="int",
                       default=128,
-                      help="width in bits for all links inside garnet.")
+                      help="""width in bits for all links inside garnet
+                      (the flit size); see --int-link-width-bits""")
+    parser.add_option("--int-link-width-bits", action="store", type="int",
+                      default=0,
+                      help="""width in bits of every router-to-router link
+                      (0: one flit). Wider links carry several flits per
+                      cycle; narrower ones serialize each flit. Overrides
+                      the width set in the topology file.""")
+    parser.add_option("--link-serdes-latency", action="store", type="int",
+                      default=0,
+                      help="""serialization/deserialization latency added
+                      on every router-to-router link (garnet). Overrides
+                      the latency set in the topology file.""")
     parser.add_option("--vcs-per-vnet", action="store", type="int", default=4,
                       help="""number of virtual channels per virtual network
                             inside garnet network.""")
+    parser.add_option("--buffers-per-data-vc", action="store", type="int",
+                      default=4,
+                      help="""flit buffers of each data virtual channel
+                            (garnet2.0); DRAIN needs a whole data packet.""")
     parser.add_option("--routing-algorithm", action="store", type="int",
                       default=0,
                       help="""routing algorithm in network.
                             0: weight-based table
                             1: XY (for Mesh. see garnet2.0/RoutingUnit.cc)
-                            2: Custom (see garnet2.0/RoutingUnit.cc""")
+                            2: Random, 3: Adaptive-random,
+                            4: West-first, 5: Adaptive west-first (Mesh)
+                            6: Custom (see garnet2.0/RoutingUnit.cc)
+                            7: Up*/Down* (any topology)
+                            8: Escape-VC: minimal adaptive on normal vcs,
+                               Up*/Down* on vc-0 of each vnet
+                            9: Minimal adaptive on the hop-distance table
+                               (any topology, e.g. irregular meshes;
+                               pair with DRAIN for deadlock freedom)
+                            10: Bufferless deflection (any topology;
+                               flits are never buffered in the network,
+                               oldest flit first; not with --spin)""")
     parser.add_option("--network-fault-model", action="store_true",
                       default=False,
                       help="""enable network fault model:
@@ -97,6 +129,27 @@ def define_options(parser):
     parser.add_option("--spin-file", type="string",
                     default="SR_64_nodes-connectivity_matrix_0-links_removed_0.txt",
                     help="file path containg SPIN-ring information for DRAIN")
+    parser.add_option("--topology-gen", action="store_true", default=False,
+                      help="""irregularMesh_XY: generate a random irregular
+                      mesh (and its DRAIN ring) instead of reading
+                      --conf-file and --spin-file; both are written to
+                      the output directory""")
+    parser.add_option("--topology-gen-links-removed", action="store",
+                      type="int", default=0,
+                      help="links removed from the generated mesh")
+    parser.add_option("--topology-gen-fault-prob", action="store",
+                      type="float", default=0.0,
+                      help="""probability of removing each link of the
+                      generated mesh (if --topology-gen-links-removed
+                      is 0)""")
+    parser.add_option("--topology-gen-seed", action="store", type="int",
+                      default=1, help="seed of the topology generator")
+    parser.add_option("--topology-file-native", action="store_true",
+                      default=False,
+                      help="""irregularMesh_XY with garnet2.0: read
+                      --conf-file in garnet itself rather than creating a
+                      Python link per link (much faster for large meshes,
+                      also takes binary edge lists; no checkpoints)""")
     parser.add_option("--spin", action="store",
                       type="int", default=0,
                       help="""To enable the spin-ing of the ring specified
@@ -110,6 +163,10 @@ def define_options(parser):
                       type="int", default=0,
                       help="""Provides the number of cycles after which spin
                       is performed for example after every 100 cycles""")
+    parser.add_option("--spin-freq-per-vnet", type="string", default="",
+                      help="""comma separated spin period (in cycles) of
+                      each vnet, e.g. 4096,4096,512. A period of 0 never
+                      drains that vnet. Overrides `spin-freq` when given""")
     parser.add_option("--spin-mult", action="store",
                       type="int", default=0,
                       help="""How many multiple times would spin be performed
@@ -118,6 +175,74 @@ def define_options(parser):
                       type="int", default=0,
                       help="""when set to 1 all vcs across vnets will be DRAINed
                       by getting spun by the spin-ring.""")
+    parser.add_option("--escalation-threshold", action="store",
+                      type="int", default=0,
+                      help="""packets misrouted by DRAIN this many times get
+                      priority in switch allocation and drain placement.
+                      0 disables escalation""")
+    parser.add_option("--livelock-threshold", action="store",
+                      type="int", default=0,
+                      help="""stop the simulation (keeping its stats) once a
+                      flit has been in the network for this many cycles.
+                      0 disables the livelock monitor""")
+    parser.add_option("--garnet-multicast", action="store_true",
+                      default=False,
+                      help="""send single-flit multicast messages as one
+                      packet replicated in the routers where the routes to
+                      its destinations diverge, instead of one unicast per
+                      destination""")
+    parser.add_option("--sw-allocator", action="store", type="choice",
+                      default="separable",
+                      choices=["separable", "islip", "wavefront",
+                               "oldest_first"],
+                      help="""switch allocator of the garnet routers:
+                      separable input-first round robin (default),
+                      iSLIP, wavefront, or oldest flit first""")
+    parser.add_option("--islip-iterations", action="store", type="int",
+                      default=1,
+                      help="iterations of the iSLIP switch allocator")
+    parser.add_option("--smart-hpc-max", action="store", type="int",
+                      default=0,
+                      help="""SMART: maximum number of hops a single-flit
+                      packet may cross in one cycle, bypassing the routers
+                      on a straight path (0 or 1: disabled)""")
+    parser.add_option("--energy-tech-file", action="store", type="string",
+                      default="",
+                      help="""per-event energies for the runtime energy
+                      model of garnet (see
+                      src/mem/ruby/network/garnet2.0/NetworkEnergyModel.hh);
+                      writes garnet_energy.txt""")
+    parser.add_option("--energy-epoch", action="store", type="int",
+                      default=10000,
+                      help="""cycles per epoch of the runtime energy model
+                      (0: one epoch per stats dump)""")
+    parser.add_option("--shared-input-buffers", action="store_true",
+                      default=False,
+                      help="""router input ports share one pool of buffers
+                      among their vcs (DAMQ)""")
+    parser.add_option("--damq-buffers-per-port", action="store", type="int",
+                      default=0,
+                      help="""DAMQ: buffers per input port (0: the sum of
+                      the per-vc buffers)""")
+    parser.add_option("--damq-reserved-per-vc", action="store", type="int",
+                      default=1,
+                      help="""DAMQ: buffers of the pool reserved to each
+                      vc""")
+    parser.add_option("--lookahead-routing", action="store_true",
+                      default=False,
+                      help="""compute the outport of a head flit at the next
+                      router one hop ahead, taking route computation off
+                      the router pipeline""")
+    parser.add_option("--router-bypass", action="store_true",
+                      default=False,
+                      help="""a flit reaching an empty router goes to switch
+                      allocation on arrival, traversing the router in one
+                      cycle when its output is free""")
+    parser.add_option("--garnet-rng-seed", action="store",
+                      type="int", default=0,
+                      help="""seed of the counter-based random streams used
+                      by routing, DRAIN and the synthetic traffic testers.
+                      Runs with the same seed are bit-identical""")
     parser.add_option("--ni-inj", type="string", default="fcfs",
                       help="'rr'|'fcfs'")
     parser.add_option("--inj-single-vnet", action="store",
@@ -154,18 +279,43 @@ def init_network(options, network, InterfaceClass):
     if options.network == "garnet2.0":
         network.num_rows = options.mesh_rows
         network.vcs_per_vnet = options.vcs_per_vnet
+        network.buffers_per_data_vc = options.buffers_per_data_vc
         network.ni_flit_size = options.link_width_bits / 8
         network.routing_algorithm = options.routing_algorithm
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
         network.trace_enable  = options.network_trace_enable
         network.trace_file = options.network_trace_file
         network.trace_max_packets = options.network_trace_max_packets
+        network.trace_buffer_packets = \
+            options.network_trace_buffer_packets
         network.sim_type = options.sim_type
         network.warmup_cycles = options.warmup_cycles
         network.marked_flits = options.marked_flits
         network.ni_inj = options.ni_inj
         network.inj_single_vnet = options.inj_single_vnet
         network.spin_file = options.spin_file
+        network.escalation_threshold = options.escalation_threshold
+        network.livelock_threshold = options.livelock_threshold
+        network.rng_seed = options.garnet_rng_seed
+        network.enable_multicast = options.garnet_multicast
+        network.sw_allocator = options.sw_allocator
+        network.islip_iterations = options.islip_iterations
+        network.smart_hpc_max = options.smart_hpc_max
+        network.lookahead_routing = options.lookahead_routing
+        network.router_bypass = options.router_bypass
+        network.shared_input_buffers = options.shared_input_buffers
+        network.energy_tech_file = options.energy_tech_file
+        network.energy_epoch = options.energy_epoch
+        for link in network.int_links:
+            if options.int_link_width_bits > 0:
+                link.width_bits = options.int_link_width_bits
+            if options.link_serdes_latency > 0:
+                link.serdes_latency = options.link_serdes_latency
+        # the links of a topology file are made in C++
+        network.topology_link_width_bits = options.int_link_width_bits
+        network.topology_link_serdes_latency = options.link_serdes_latency
+        network.damq_buffers_per_port = options.damq_buffers_per_port
+        network.damq_reserved_per_vc = options.damq_reserved_per_vc
 
     if options.network == "simple":
         network.setup_buffers()
@@ -193,6 +343,12 @@ def init_network(options, network, InterfaceClass):
       print "setting spin-freq to: ", options.spin_freq
       network.spin_freq = options.spin_freq
 
+    if options.spin == 1 and options.spin_freq_per_vnet != "":
+      assert(options.network == "garnet2.0")
+      print "setting per-vnet spin-freq to: ", options.spin_freq_per_vnet
+      network.spin_freq_per_vnet = \
+        [int(f) for f in options.spin_freq_per_vnet.split(',')]
+
     if options.spin == 1:
       assert(options.network == "garnet2.0")
       print "setting spin-mult to: ", options.spin_mult
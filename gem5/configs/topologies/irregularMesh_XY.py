@@ -106,7 +106,27 @@ class irregularMesh_XY(SimpleTopology):
 
         network.ext_links = ext_links
 
+        # garnet generates a mesh with links removed at random, which
+        # stays connected (see garnet2.0/TopologyFile.hh)
+        if options.network == "garnet2.0" and options.topology_gen:
+            network.topology_gen = True
+            network.topology_gen_links_removed = \
+                options.topology_gen_links_removed
+            network.topology_gen_fault_prob = options.topology_gen_fault_prob
+            network.topology_gen_seed = options.topology_gen_seed
+            network.topology_link_latency = link_latency
+            return
+
         print(options.conf_file)
+        # garnet may read the links itself (see garnet2.0/TopologyFile.hh),
+        # without a SimObject per link: much faster for large meshes,
+        # and the file may also be a binary edge list. The links and
+        # ports come in the same order as below.
+        if options.network == "garnet2.0" and options.topology_file_native:
+            network.topology_file = options.conf_file
+            network.topology_link_latency = link_latency
+            return
+
         # Do the file-handling stuff here...
         input_ = options.conf_file
         with open (input_, "r") as f:
@@ -37,7 +37,6 @@
 #include <vector>
 
 #include "base/logging.hh"
-#include "base/random.hh"
 #include "base/statistics.hh"
 #include "debug/GarnetSyntheticTraffic.hh"
 #include "mem/mem_object.hh"
@@ -93,24 +92,55 @@ GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
       injRate(p->inj_rate),
       injVnet(p->inj_vnet),
       precision(p->precision),
+      skipAhead((SkipAheadMode) p->skip_ahead),
+      nextInjection(INJECTION_NEVER),
+      rngSeed(p->rng_seed),
       responseLimit(p->response_limit),
       masterId(p->system->getMasterId(this))
 {
     // set up counters
     noResponseCycles = 0;
+    lastTickCycle = Cycles(0);
     schedule(tickEvent, 0);
 
-    initTrafficType();
-    if (trafficStringToEnum.count(trafficType) == 0) {
-        fatal("Unknown Traffic Type: %s!\n", traffic);
-    }
-    traffic = trafficStringToEnum[trafficType];
-
     id = TESTER_NETWORK++;
+    // same derivation as the network-side streams, so a single seed
+    // reproduces the whole run
+    rng = CounterRNG(rngSeed).split(TRAFFIC_RNG_).split(id);
+
+    TrafficPatternConfig config;
+    config.type = trafficType;
+    config.num_dest = numDestinations;
+    config.num_rows = p->num_rows;
+    config.hotspot_nodes = p->hotspot_nodes;
+    config.hotspot_fraction = p->hotspot_fraction;
+    config.permutation_file = p->permutation_file;
+    config.rate_matrix_file = p->rate_matrix_file;
+    pattern = new TrafficPattern(config, id);
+    // a rate matrix sets the rate of every source
+    if (pattern->source_rate() >= 0)
+        injRate = pattern->source_rate();
+
+    injection = new InjectionProcess(injRate, precision, skipAhead,
+                                     p->burst_on_cycles,
+                                     p->burst_off_cycles, rng);
+
+    // the first injection may be in cycle 0 (the first tick)
+    if (skipAhead != NO_SKIP_) {
+        uint64_t gap = injection->gap(rng);
+        if (gap != INJECTION_NEVER)
+            nextInjection = gap - 1;
+    }
     DPRINTF(GarnetSyntheticTraffic,"Config Created: Name = %s , and id = %d\n",
             name(), id);
 }
 
+GarnetSyntheticTraffic::~GarnetSyntheticTraffic()
+{
+    delete pattern;
+    delete injection;
+}
+
 BaseMasterPort &
 GarnetSyntheticTraffic::getMasterPort(const std::string &if_name, PortID idx)
 {
@@ -144,34 +174,48 @@ GarnetSyntheticTraffic::completeRequest(PacketPtr pkt)
 void
 GarnetSyntheticTraffic::tick()
 {
-    if (++noResponseCycles >= responseLimit) {
+    noResponseCycles += curCycle() - lastTickCycle;
+    lastTickCycle = curCycle();
+    if (noResponseCycles >= responseLimit) {
 //        fatal("%s deadlocked at cycle %d\n", name(), curTick());
     }
 
-    // make new request based on injection rate
-    // (injection rate's range depends on precision)
-    // - generate a random number between 0 and 10^precision
-    // - send pkt if this number is < injRate*(10^precision)
+    // make new request based on injection rate: a trial every
+    // cycle, or (skip-ahead) only wake up at the injections
     bool sendAllowedThisCycle;
-    double injRange = pow((double) 10, (double) precision);
-    unsigned trySending = random_mt.random<unsigned>(0, (int) injRange);
-    if (trySending < injRate*injRange)
-        sendAllowedThisCycle = true;
+    if (skipAhead == NO_SKIP_)
+        sendAllowedThisCycle = injection->trial(rng);
     else
-        sendAllowedThisCycle = false;
+        sendAllowedThisCycle = (uint64_t(curCycle()) == nextInjection);
 
     // always generatePkt unless fixedPkts or singleSender is enabled
-    if (sendAllowedThisCycle) {
-        bool senderEnable = true;
+    bool senderEnable = true;
+
+    if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
+        senderEnable = false;
 
-        if (numPacketsMax >= 0 && numPacketsSent >= numPacketsMax)
-            senderEnable = false;
+    if (singleSender >= 0 && id != singleSender)
+        senderEnable = false;
 
-        if (singleSender >= 0 && id != singleSender)
-            senderEnable = false;
+    if (sendAllowedThisCycle && senderEnable)
+        generatePkt();
 
-        if (senderEnable)
-            generatePkt();
+    if (skipAhead != NO_SKIP_ && sendAllowedThisCycle) {
+        // a disabled sender stays disabled
+        uint64_t gap = INJECTION_NEVER;
+        if (senderEnable && !(numPacketsMax >= 0 &&
+                              numPacketsSent >= numPacketsMax)) {
+            gap = injection->gap(rng);
+        }
+        nextInjection = (gap == INJECTION_NEVER) ? INJECTION_NEVER :
+            nextInjection + gap;
+    }
+
+    // next wakeup: the next cycle, or the next injection
+    Tick next_tick = clockEdge(Cycles(1));
+    if (skipAhead != NO_SKIP_) {
+        next_tick = (nextInjection == INJECTION_NEVER) ? MaxTick :
+            clockEdge(Cycles(nextInjection - curCycle()));
     }
 
     // Schedule wakeup
@@ -179,12 +223,14 @@ GarnetSyntheticTraffic::tick()
         if (curTick() >= simCycles)
             exitSimLoop("Network Tester completed simCycles");
         else {
+            // first clock edge at or after simCycles
+            Tick end_tick = clockEdge(ticksToCycles(simCycles - curTick()));
             if (!tickEvent.scheduled())
-                schedule(tickEvent, clockEdge(Cycles(1)));
+                schedule(tickEvent, std::min(next_tick, end_tick));
         }
     } else if(sim_type == 2) {
-        if (!tickEvent.scheduled())
-        schedule(tickEvent, clockEdge(Cycles(1)));
+        if (!tickEvent.scheduled() && (next_tick != MaxTick))
+        schedule(tickEvent, next_tick);
 //        fatal("sim_type: %d is not implemented currently!", sim_type);
     } else {
         fatal("unknown 'sim_type: %d' option given", sim_type);
@@ -194,62 +240,13 @@ GarnetSyntheticTraffic::tick()
 void
 GarnetSyntheticTraffic::generatePkt()
 {
-    int num_destinations = numDestinations;
-    int radix = (int) sqrt(num_destinations);
-    unsigned destination = id;
-    int dest_x = -1;
-    int dest_y = -1;
-    int source = id;
-    int src_x = id%radix;
-    int src_y = id/radix;
+    unsigned destination;
 
     if (singleDest >= 0)
     {
         destination = singleDest;
-    } else if (traffic == UNIFORM_RANDOM_) {
-        destination = random_mt.random<unsigned>(0, num_destinations - 1);
-    } else if (traffic == BIT_COMPLEMENT_) {
-        dest_x = radix - src_x - 1;
-        dest_y = radix - src_y - 1;
-        destination = dest_y*radix + dest_x;
-    } else if (traffic == BIT_REVERSE_) {
-        unsigned int straight = source;
-        unsigned int reverse = source & 1; // LSB
-
-        int num_bits = (int) log2(num_destinations);
-
-        for (int i = 1; i < num_bits; i++)
-        {
-            reverse <<= 1;
-            straight >>= 1;
-            reverse |= (straight & 1); // LSB
-        }
-        destination = reverse;
-    } else if (traffic == BIT_ROTATION_) {
-        if (source%2 == 0)
-            destination = source/2;
-        else // (source%2 == 1)
-            destination = ((source/2) + (num_destinations/2));
-    } else if (traffic == NEIGHBOR_) {
-            dest_x = (src_x + 1) % radix;
-            dest_y = src_y;
-            destination = dest_y*radix + dest_x;
-    } else if (traffic == SHUFFLE_) {
-        if (source < num_destinations/2)
-            destination = source*2;
-        else
-            destination = (source*2 - num_destinations + 1);
-    } else if (traffic == TRANSPOSE_) {
-            dest_x = src_y;
-            dest_y = src_x;
-            destination = dest_y*radix + dest_x;
-    } else if (traffic == TORNADO_) {
-        dest_x = (src_x + (int) ceil(radix/2) - 1) % radix;
-        dest_y = src_y;
-        destination = dest_y*radix + dest_x;
-    }
-    else {
-        fatal("Unknown Traffic Type: %s!\n", traffic);
+    } else {
+        destination = pattern->destination(rng);
     }
 
     // The source of the packets is a cache.
@@ -296,7 +293,7 @@ GarnetSyntheticTraffic::generatePkt()
     if (injReqType < 0 || injReqType > 2)
     {
         // randomly inject in any vnet
-        injReqType = random_mt.random(0, 2);
+        injReqType = rng.random(0, 2);
     }
 
     if (injReqType == 0) {
@@ -332,19 +329,6 @@ GarnetSyntheticTraffic::generatePkt()
     sendPkt(pkt);
 }
 
-void
-GarnetSyntheticTraffic::initTrafficType()
-{
-    trafficStringToEnum["bit_complement"] = BIT_COMPLEMENT_;
-    trafficStringToEnum["bit_reverse"] = BIT_REVERSE_;
-    trafficStringToEnum["bit_rotation"] = BIT_ROTATION_;
-    trafficStringToEnum["neighbor"] = NEIGHBOR_;
-    trafficStringToEnum["shuffle"] = SHUFFLE_;
-    trafficStringToEnum["tornado"] = TORNADO_;
-    trafficStringToEnum["transpose"] = TRANSPOSE_;
-    trafficStringToEnum["uniform_random"] = UNIFORM_RANDOM_;
-}
-
 void
 GarnetSyntheticTraffic::doRetry()
 {
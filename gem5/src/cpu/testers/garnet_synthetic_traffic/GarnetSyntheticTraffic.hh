@@ -35,6 +35,8 @@
 
 #include "base/statistics.hh"
 #include "mem/mem_object.hh"
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "mem/ruby/network/garnet2.0/TrafficPattern.hh"
 #include "mem/port.hh"
 #include "params/GarnetSyntheticTraffic.hh"
 #include "sim/eventq.hh"
@@ -42,22 +44,13 @@
 #include "sim/sim_object.hh"
 #include "sim/stats.hh"
 
-enum TrafficType {BIT_COMPLEMENT_ = 0,
-                  BIT_REVERSE_ = 1,
-                  BIT_ROTATION_ = 2,
-                  NEIGHBOR_ = 3,
-                  SHUFFLE_ = 4,
-                  TORNADO_ = 5,
-                  TRANSPOSE_ = 6,
-                  UNIFORM_RANDOM_ = 7,
-                  NUM_TRAFFIC_PATTERNS_};
-
 class Packet;
 class GarnetSyntheticTraffic : public MemObject
 {
   public:
     typedef GarnetSyntheticTrafficParams Params;
     GarnetSyntheticTraffic(const Params *p);
+    ~GarnetSyntheticTraffic();
 
     virtual void init();
 
@@ -113,11 +106,12 @@ class GarnetSyntheticTraffic : public MemObject
     unsigned size;
     int id;
 
-    std::map<std::string, TrafficType> trafficStringToEnum;
-
     unsigned blockSizeBits;
 
     Tick noResponseCycles;
+    // cycle of the previous tick; under skip-ahead it can be many
+    // cycles back
+    Cycles lastTickCycle;
 
     int numDestinations;
     Tick simCycles;
@@ -128,10 +122,17 @@ class GarnetSyntheticTraffic : public MemObject
     int sim_type;
 
     std::string trafficType; // string
-    TrafficType traffic; // enum from string
+    TrafficPattern *pattern;
+    InjectionProcess *injection;
     double injRate;
     int injVnet;
     int precision;
+    SkipAheadMode skipAhead;
+    // cycle of the next injection when skipping ahead
+    uint64_t nextInjection;
+
+    uint64_t rngSeed;
+    CounterRNG rng;
 
     const Cycles responseLimit;
 
@@ -141,7 +142,6 @@ class GarnetSyntheticTraffic : public MemObject
 
     void generatePkt();
     void sendPkt(PacketPtr pkt);
-    void initTrafficType();
 
     void doRetry();
 
@@ -45,12 +45,32 @@ class GarnetSyntheticTraffic(MemObject):
     single_dest = Param.Int(-1, "Send only to this dest. \
                                  Default depends on traffic_type")
     traffic_type = Param.String("uniform_random", "Traffic type")
+    num_rows = Param.Int(0, "rows of the mesh the destinations are laid " \
+                            "out on (coordinate based traffic types); " \
+                            "0: a square mesh")
+    hotspot_nodes = VectorParam.Int([], "destinations of hotspot traffic")
+    hotspot_fraction = Param.Float(0.0, "fraction of the hotspot traffic " \
+                                        "sent to the hotspot nodes")
+    permutation_file = Param.String("", "destination of each source, " \
+                                        "for permutation traffic")
+    rate_matrix_file = Param.String("", "num_dest x num_dest matrix of " \
+                          "packets/cycle, for rate_matrix traffic; " \
+                          "overrides inj_rate")
+    burst_on_cycles = Param.Float(0, "mean on period of bursty injection;" \
+                                     " 0: not bursty")
+    burst_off_cycles = Param.Float(0, "mean off period of bursty injection")
     inj_rate = Param.Float(0.1, "Packet injection rate")
     inj_vnet = Param.Int(-1, "Vnet to inject in. \
                               0 and 1 are 1-flit, 2 is 5-flit. \
                                 Default is to inject in all three vnets")
     precision = Param.Int(3, "Number of digits of precision \
                               after decimal point")
+    skip_ahead = Param.Int(0, "0: an injection trial every cycle, " \
+                  "1: sample the gap to the next injection and only " \
+                  "wake up then, 2: as 1, with the same random draws " \
+                  "(and packets for a seed) as 0")
+    rng_seed = Param.UInt64(0, "seed of the random stream of this tester; " \
+                               "every tester derives its own stream from it")
     response_limit = Param.Cycles(5000000, "Cycles before exiting \
                                             due to lack of progress")
     test = MasterPort("Port to the memory system to test")
@@ -46,7 +46,8 @@ enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
 enum link_type { EXT_IN_, EXT_OUT_, INT_, NUM_LINK_TYPES_ };
 enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, RANDOM_ = 2, ADAPT_RAND_ = 3,
                         WestFirst_ = 4, ADAPT_WestFirst_ = 5, CUSTOM_ = 6,
-                        NUM_ROUTING_ALGORITHM_};
+                        UP_DN_ = 7, ESCAPE_VC_UP_DN_ = 8, MIN_ADAPT_ = 9,
+                        DEFLECTION_ = 10, NUM_ROUTING_ALGORITHM_};
 
 struct RouteInfo
 {
@@ -60,6 +61,8 @@ struct RouteInfo
         dest_ni = -1;
         dest_router = -1;
         hops_traversed = -1;
+        escape_vc = false;
+        multicast = false;
     }
     // destination format for table-based routing
     int vnet;
@@ -71,6 +74,13 @@ struct RouteInfo
     int dest_ni;
     int dest_router;
     int hops_traversed;
+    // set once the packet has moved to the escape vc
+    // (ESCAPE_VC_UP_DN_ routing); it then stays there
+    bool escape_vc;
+    // a packet (or a branch of it) of an in-network multicast; while
+    // it has more than one destination (dest_ni == -1) it is routed
+    // on the routing table and replicated where the routes diverge
+    bool multicast;
 };
 
 #define INFINITE_ 10000
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_COUNTERRNG_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_COUNTERRNG_HH__
+
+#include <cassert>
+#include <cstdint>
+
+// Sub-streams of the root stream of a simulation; each component
+// further splits its sub-stream by its own id.
+enum RngStreamType { DRAIN_RNG_ = 0, ROUTING_RNG_ = 1, TRAFFIC_RNG_ = 2,
+                     TOPOLOGY_RNG_ = 3, NUM_RNG_STREAM_TYPE_};
+
+// Counter-based random number stream.
+// Every draw is a pure function of (seed, stream, counter), so a
+// component's sequence only depends on how many numbers it has drawn
+// itself and never on the order in which other components draw.
+// Streams are split by hashing a sub-stream id into the stream key,
+// which lets each router, the drain logic and each traffic source own
+// an independent sequence derived from one global seed.
+class CounterRNG
+{
+  public:
+    CounterRNG(uint64_t seed = 0, uint64_t stream = 0)
+        : m_key(mix(seed ^ mix(stream + kGolden))), m_counter(0)
+    {}
+
+    // Derive an independent child stream
+    CounterRNG
+    split(uint64_t sub_stream) const
+    {
+        CounterRNG child;
+        child.m_key = mix(m_key ^ mix(sub_stream + kGolden));
+        return child;
+    }
+
+    // Value at an arbitrary position of this stream (no state change)
+    uint64_t at(uint64_t counter) const
+    { return mix(m_key + kGolden * (counter + 1)); }
+
+    uint64_t next() { return at(m_counter++); }
+
+    // Uniform integer in [lo, hi] (inclusive)
+    uint64_t
+    random(uint64_t lo, uint64_t hi)
+    {
+        assert(hi >= lo);
+        uint64_t range = hi - lo + 1;
+        if (range == 0)
+            return next();
+        // reject the biased tail so every value is equally likely
+        uint64_t limit = UINT64_MAX - (UINT64_MAX % range);
+        uint64_t r;
+        do {
+            r = next();
+        } while (r >= limit);
+        return lo + r % range;
+    }
+
+    // Uniform double in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    uint64_t get_counter() const { return m_counter; }
+
+  private:
+    static const uint64_t kGolden = 0x9e3779b97f4a7c15ULL;
+
+    // SplitMix64 finalizer
+    static uint64_t
+    mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t m_key;
+    uint64_t m_counter;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_COUNTERRNG_HH__
@@ -80,11 +80,12 @@ CrossbarSwitch::wakeup()
             m_router->get_id(), m_router->curCycle());
 
     for (int inport = 0; inport < m_num_inports; inport++) {
-        if (!m_switch_buffer[inport]->isReady(m_router->curCycle()))
-            continue;
+        // an inport with speedup (wide links) may send several flits
+        while (m_switch_buffer[inport]->isReady(m_router->curCycle())) {
+            flit *t_flit = m_switch_buffer[inport]->peekTopFlit();
+            if (!t_flit->is_stage(ST_, m_router->curCycle()))
+                break;
 
-        flit *t_flit = m_switch_buffer[inport]->peekTopFlit();
-        if (t_flit->is_stage(ST_, m_router->curCycle())) {
             int outport = t_flit->get_outport();
             // cout << "flit: " << *t_flit << " is scheduled to be on the link in next cycle" << endl;
             // flit performs LT_ in the next cycle
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/FlitStatsAccumulator.hh"
+
+FlitStatsAccumulator::FlitStatsAccumulator(int num_vnets)
+    : flits_received(num_vnets), packets_received(num_vnets),
+      flit_network_latency(num_vnets), flit_queueing_latency(num_vnets),
+      packet_network_latency(num_vnets), packet_queueing_latency(num_vnets),
+      network_latency_histogram(21), latency_hist(256),
+      network_latency_hist(256), queueing_latency_hist(256),
+      drain_count_hist(16)
+{
+    clear();
+}
+
+void
+FlitStatsAccumulator::clear()
+{
+    num_flits = 0;
+    for (int vnet = 0; vnet < flits_received.size(); vnet++) {
+        flits_received[vnet] = 0;
+        packets_received[vnet] = 0;
+        flit_network_latency[vnet] = 0;
+        flit_queueing_latency[vnet] = 0;
+        packet_network_latency[vnet] = 0;
+        packet_queueing_latency[vnet] = 0;
+    }
+    total_hops = 0;
+    for (int i = 0; i < network_latency_histogram.size(); i++)
+        network_latency_histogram[i] = 0;
+
+    max_latency = max_network_latency = max_queueing_latency = Cycles(0);
+    min_latency = min_network_latency = min_queueing_latency =
+        Cycles(MaxTick);
+    max_age = Cycles(0);
+    max_drain_count = 0;
+}
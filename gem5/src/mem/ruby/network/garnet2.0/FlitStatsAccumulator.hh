@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_FLITSTATSACCUMULATOR_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_FLITSTATSACCUMULATOR_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "base/types.hh"
+
+// Samples of a Stats::Histogram, counted per value, and added to the
+// histogram by flush(). Values below 'size' (the common case, e.g.
+// latencies well under 256 cycles) are counted in a dense array, the
+// others in a map. The histogram buckets do not depend on the order
+// of the samples, so it ends up as if they were sampled one by one.
+class LocalHistogram
+{
+  public:
+    LocalHistogram(int size) : m_counts(size, 0), m_max(-1) {}
+
+    void
+    sample(uint64_t val)
+    {
+        if (val < m_counts.size()) {
+            m_counts[val]++;
+            if ((int) val > m_max)
+                m_max = val;
+        } else {
+            m_overflow[val]++;
+        }
+    }
+
+    template <class Histogram>
+    void
+    flush(Histogram& hist)
+    {
+        for (int val = 0; val <= m_max; val++) {
+            if (m_counts[val] > 0) {
+                assert(m_counts[val] <= INT32_MAX);
+                hist.sample(val, (int) m_counts[val]);
+                m_counts[val] = 0;
+            }
+        }
+        for (std::map<uint64_t, uint32_t>::iterator it = m_overflow.begin();
+             it != m_overflow.end(); ++it) {
+            assert(it->second <= INT32_MAX);
+            hist.sample(it->first, (int) it->second);
+        }
+        m_overflow.clear();
+        m_max = -1;
+    }
+
+  private:
+    std::vector<uint32_t> m_counts;
+    int m_max; // largest value in m_counts
+    std::map<uint64_t, uint32_t> m_overflow;
+};
+
+// Statistics of the (unmarked) flits ejected at one NI, in plain
+// counters, until GarnetNetwork::merge_flit_stats() adds them to the
+// stats of the network when they are collated or reset.
+class FlitStatsAccumulator
+{
+  public:
+    FlitStatsAccumulator(int num_vnets);
+
+    void
+    sample(int vnet, Cycles network_delay, Cycles queueing_delay,
+           Cycles age, int hops, int drain_count, bool is_tail)
+    {
+        Cycles total_delay = queueing_delay + network_delay;
+
+        num_flits++;
+        flits_received[vnet]++;
+        flit_network_latency[vnet] += network_delay;
+        flit_queueing_latency[vnet] += queueing_delay;
+        total_hops += hops;
+        if (is_tail) {
+            packets_received[vnet]++;
+            packet_network_latency[vnet] += network_delay;
+            packet_queueing_latency[vnet] += queueing_delay;
+            drain_count_hist.sample(drain_count);
+        }
+
+        latency_hist.sample(total_delay);
+        network_latency_hist.sample(network_delay);
+        queueing_latency_hist.sample(queueing_delay);
+        // buckets of 5 cycles, the last one open
+        int index = uint64_t(network_delay) / 5;
+        network_latency_histogram[(index < 20) ? index : 20]++;
+
+        max_latency = std::max(max_latency, total_delay);
+        max_network_latency = std::max(max_network_latency, network_delay);
+        max_queueing_latency = std::max(max_queueing_latency,
+                                        queueing_delay);
+        min_latency = std::min(min_latency, total_delay);
+        min_network_latency = std::min(min_network_latency, network_delay);
+        min_queueing_latency = std::min(min_queueing_latency,
+                                        queueing_delay);
+        max_age = std::max(max_age, age);
+        max_drain_count = std::max(max_drain_count, drain_count);
+    }
+
+    // back to no samples (after a merge)
+    void clear();
+
+    uint64_t num_flits;
+    std::vector<uint64_t> flits_received;
+    std::vector<uint64_t> packets_received;
+    std::vector<uint64_t> flit_network_latency;
+    std::vector<uint64_t> flit_queueing_latency;
+    std::vector<uint64_t> packet_network_latency;
+    std::vector<uint64_t> packet_queueing_latency;
+    uint64_t total_hops;
+    std::vector<uint64_t> network_latency_histogram;
+
+    LocalHistogram latency_hist;
+    LocalHistogram network_latency_hist;
+    LocalHistogram queueing_latency_hist;
+    LocalHistogram drain_count_hist;
+
+    Cycles max_latency, max_network_latency, max_queueing_latency;
+    Cycles min_latency, min_network_latency, min_queueing_latency;
+    Cycles max_age;
+    int max_drain_count;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_FLITSTATSACCUMULATOR_HH__
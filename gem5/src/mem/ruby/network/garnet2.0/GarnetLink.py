@@ -42,10 +42,18 @@ class NetworkLink(ClockedObject):
                               "virtual channels per virtual network")
     virt_nets = Param.Int(Parent.number_of_virtual_networks,
                           "number of virtual networks")
+    width_bits = Param.UInt32(Parent.width_bits, "link width in bits")
+    serdes_latency = Param.Cycles(Parent.serdes_latency,
+                                  "serialization/deserialization latency")
+    flit_size = Param.UInt32(Parent.ni_flit_size, "flit size in bytes")
 
 class CreditLink(NetworkLink):
     type = 'CreditLink'
     cxx_header = "mem/ruby/network/garnet2.0/CreditLink.hh"
+    # credits are a few bits on their own wires: they are neither
+    # serialized nor pay the SerDes latency of a narrow data link
+    width_bits = 0
+    serdes_latency = 0
 
 # Interior fixed pipeline links between routers
 class GarnetIntLink(BasicIntLink):
@@ -55,6 +63,12 @@ class GarnetIntLink(BasicIntLink):
     # and one backward flow-control link (for credit)
     network_link = Param.NetworkLink(NetworkLink(), "forward link")
     credit_link  = Param.CreditLink(CreditLink(), "backward flow-control link")
+    # A link wider than a flit carries several flits per cycle (the
+    # routers at its ends get a matching speedup); a narrower one
+    # serializes each flit over several cycles
+    width_bits = Param.UInt32(0, "link width in bits (0: one flit)")
+    serdes_latency = Param.Cycles(0, "serialization/deserialization " \
+                                  "latency added to each flit")
 
 # Exterior fixed pipeline links between a router and a controller
 class GarnetExtLink(BasicExtLink):
@@ -77,3 +91,7 @@ class GarnetExtLink(BasicExtLink):
     # Out uni-directional link
     _cls.append(CreditLink());
     credit_links = VectorParam.CreditLink(_cls, "backward flow-control links")
+    # see GarnetIntLink
+    width_bits = Param.UInt32(0, "link width in bits (0: one flit)")
+    serdes_latency = Param.Cycles(0, "serialization/deserialization " \
+                                  "latency added to each flit")
@@ -33,16 +33,24 @@
 
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <stdio.h>
 #include <unistd.h>
 #include <fstream>
+#include <queue>
 
+#include "base/callback.hh"
 #include "base/cast.hh"
+#include "base/output.hh"
+#include "base/statistics.hh"
 #include "base/stl_helpers.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/system/Sequencer.hh"
+#include "mem/ruby/network/BasicRouter.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
@@ -53,6 +61,7 @@
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
 #include "mem/ruby/network/garnet2.0/OutputUnit.hh"
+#include "mem/ruby/network/garnet2.0/TopologyFile.hh"
 #include "mem/ruby/system/RubySystem.hh"
 #include "sim/sim_exit.hh"
 
@@ -70,7 +79,8 @@ using m5::stl_helpers::deletePointers;
  */
 
 GarnetNetwork::GarnetNetwork(const Params *p)
-    : Network(p), Consumer(this)
+    : Network(p), Consumer(this), m_vc_store(p->vcs_per_vnet),
+      m_energy_event([this]{ sample_energy(); }, "GarnetNetwork energy")
 {
     m_num_rows = p->num_rows;
     m_ni_flit_size = p->ni_flit_size;
@@ -78,6 +88,8 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_buffers_per_data_vc = p->buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p->buffers_per_ctrl_vc;
     m_routing_algorithm = p->routing_algorithm;
+    m_sw_allocator = p->sw_allocator;
+    m_islip_iterations = p->islip_iterations;
     warmup_cycles = p->warmup_cycles;
     marked_flits = p->marked_flits;
     marked_flt_injected = 0;
@@ -111,11 +123,61 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_spin_mult = p->spin_mult;
     m_conf_file = p->conf_file;
     m_spin_file = p->spin_file;
+    m_native_links = p->topology_gen || !p->topology_file.empty();
     m_uTurn_crossbar = p->uTurn_crossbar;
     drain_all_vc = p->drain_all_vc;
 
+    m_escalation_thrshld = p->escalation_threshold;
+    m_enable_multicast = p->enable_multicast;
+    m_lookahead_routing = p->lookahead_routing;
+    m_router_bypass = p->router_bypass;
+    m_smart_hpc_max = p->smart_hpc_max;
+    m_shared_input_buffers = p->shared_input_buffers;
+    m_damq_buffers_per_port = p->damq_buffers_per_port;
+    m_damq_reserved_per_vc = p->damq_reserved_per_vc;
+    m_energy_model = nullptr;
+    m_full_mesh = false;
+    m_energy_tech_file = p->energy_tech_file;
+    m_energy_output = p->energy_output;
+    m_energy_epoch = Cycles(p->energy_epoch);
+    m_livelock_thrshld = p->livelock_threshold;
+    m_next_progress_check = Cycles(0);
+
+    m_rng_seed = p->rng_seed;
+    m_rng_root = CounterRNG(m_rng_seed);
+    m_drain_rng = get_rng_stream(DRAIN_RNG_, 0);
+
+    max_flit_age = Cycles(0);
+    max_flit_drain_count = 0;
+
     lock = -1;
 
+    // per-vnet drain periods: when not given every vnet drains
+    // every 'spin_freq' cycles (the original behavior). Otherwise
+    // the network halts every gcd(periods) cycles and only the
+    // vnets whose period divides the epoch start get drained.
+    m_vnet_spin_freq.assign(m_virtual_networks, m_spin_thrshld);
+    if (m_spin && !p->spin_freq_per_vnet.empty()) {
+        if (p->spin_freq_per_vnet.size() != m_virtual_networks)
+            fatal("spin_freq_per_vnet has %d entries but there are %d "
+                  "vnets\n", p->spin_freq_per_vnet.size(),
+                  m_virtual_networks);
+        uint32_t epoch = 0;
+        for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+            m_vnet_spin_freq[vnet] = p->spin_freq_per_vnet[vnet];
+            uint32_t a = m_vnet_spin_freq[vnet];
+            // gcd(epoch, a)
+            while (a != 0) {
+                uint32_t t = epoch % a;
+                epoch = a;
+                a = t;
+            }
+        }
+        if (epoch == 0)
+            fatal("spin_freq_per_vnet disables DRAIN on every vnet\n");
+        m_spin_thrshld = epoch;
+    }
+
     if (m_spin) {
         // If ''spin' is set then 'm_spin_thrshld' and 'm_spin_mult' should
         // not be equal to 0. Assert.
@@ -140,6 +202,10 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_trace_enable = p->trace_enable;
     m_trace_filename = p->trace_file;
     m_trace_max_packets = p->trace_max_packets;
+    m_trace_buffer_packets = p->trace_buffer_packets;
+    m_trace_ni_queue_depth = p->trace_ni_queue_depth;
+    m_trace_reader = NULL;
+    m_trace_done = false;
 
     m_vnet_type.resize(m_virtual_networks);
 
@@ -150,6 +216,40 @@ GarnetNetwork::GarnetNetwork(const Params *p)
             m_vnet_type[i] = CTRL_VNET_; // carries only ctrl packets
     }
 
+    // drains move whole packets only, so a data vc that cannot
+    // buffer a complete data packet would never be drained
+    if (m_spin) {
+        int data_flits = (int) ceil((double) MessageSizeType_to_int(
+            MessageSizeType_Data) / m_ni_flit_size);
+        if (m_buffers_per_data_vc < data_flits) {
+            fatal("DRAIN needs buffers_per_data_vc (--buffers-per-data-vc) "
+                  "of at least %d, one data packet of %d-byte flits, "
+                  "not %d\n", data_flits, m_ni_flit_size,
+                  m_buffers_per_data_vc);
+        }
+    }
+
+    // by default a shared port holds as many flits as its vcs did
+    if (m_shared_input_buffers) {
+        int num_vcs = m_virtual_networks * m_vcs_per_vnet;
+        if (m_damq_buffers_per_port == 0) {
+            for (int vc = 0; vc < num_vcs; vc++) {
+                m_damq_buffers_per_port +=
+                    (get_vnet_type(vc) == DATA_VNET_) ?
+                    m_buffers_per_data_vc : m_buffers_per_ctrl_vc;
+            }
+        }
+        if (m_damq_reserved_per_vc < 1)
+            fatal("DAMQ needs at least one buffer reserved per vc\n");
+        if (m_damq_buffers_per_port < num_vcs * m_damq_reserved_per_vc)
+            fatal("damq_buffers_per_port (%d) cannot reserve %d buffers "
+                  "to each of %d vcs\n", m_damq_buffers_per_port,
+                  m_damq_reserved_per_vc, num_vcs);
+        cout << "DAMQ: " << m_damq_buffers_per_port << " buffers per "
+             << "input port, " << m_damq_reserved_per_vc
+             << " reserved per vc" << endl;
+    }
+
     // record the routers
     for (vector<BasicRouter*>::const_iterator i =  p->routers.begin();
          i != p->routers.end(); ++i) {
@@ -159,6 +259,9 @@ GarnetNetwork::GarnetNetwork(const Params *p)
         // initialize the router's network pointers
         router->init_net_ptr(this);
     }
+    m_link_dest.resize(m_routers.size());
+    m_link_src.resize(m_routers.size());
+    m_link_dest_inport.resize(m_routers.size());
 
     // record the network interfaces
     for (vector<ClockedObject*>::const_iterator i = p->netifs.begin();
@@ -225,8 +328,10 @@ GarnetNetwork::init_spinRing()
         spinRing[0].router_id_ = 0;
         spinRing[0].inport_dir_ = "East";
     }
-    else if ( spinRing[lst_indx].router_id_ == m_num_rows ) {
-        // because 'm_num_cols' is initialized later in the code
+    else if ( spinRing[lst_indx].router_id_ ==
+              params()->routers.size() / m_num_rows ) {
+        // the router north of router-0: its id is the number of
+        // columns, and 'm_num_cols' is initialized later in the code
         spinRing[0].router_id_ = 0;
         spinRing[0].inport_dir_ = "North";
     }
@@ -246,11 +351,25 @@ GarnetNetwork::init_spinRing()
 
 void
 GarnetNetwork::doSpin(int vc_) {
-    // go the corresponding router and its input-port vc-0
+    doSpin(std::vector<int>(1, vc_));
+}
+
+// Drain all the vcs in 'vcs' in a single walk of the spinRing.
+// Each ring node carries one slot per vc, so the upstream router
+// and outport lookups are done once per node instead of once per
+// node per vc.
+// A vc is moved as a whole packet: it is only drained if it buffers
+// every flit of its packet. A vc holding part of a wormhole packet
+// (its head already left, or its tail is still upstream) stays put,
+// and so does every vc that would be drained into a vc that stays.
+void
+GarnetNetwork::doSpin(const std::vector<int>& vcs) {
+    // go the corresponding router and its input-port vcs
     // if it has flit take the and put it in the next member
     // of the deque..
     // update -- stats:
-    // put asserts: number of pkts present in VC-base ('vc_')
+    // put asserts: number of pkts present in 'vcs'
+    int num_vcs = vcs.size();
     int spun_pkt_num = 0;
     for (vector<Router*>::const_iterator itr= m_routers.begin();
          itr != m_routers.end(); ++itr) {
@@ -258,9 +377,9 @@ GarnetNetwork::doSpin(int vc_) {
         for (int inport = 0; inport < router->get_num_inports(); inport++) {
             assert(inport == router->get_inputUnit_ref()[inport]->get_id());
             if (router->get_inputUnit_ref()[inport]->get_direction() != "Local") {
-                if(router->get_inputUnit_ref()[inport]->vc_isEmpty(vc_)) {
-                } else {
-                    spun_pkt_num++;
+                for (int k = 0; k < num_vcs; k++) {
+                    if(!router->get_inputUnit_ref()[inport]->vc_isEmpty(vcs[k]))
+                        spun_pkt_num++;
                 }
             }
         }
@@ -270,6 +389,46 @@ GarnetNetwork::doSpin(int vc_) {
 
     m_total_spins++;
     int num_pkts = 0; // number of packets taken out and inserted must be same.
+    int num_pinned = 0;
+
+    for (int idx = 0; idx < spinRing.size(); idx++)
+        spinRing[idx].pkts_.assign(num_vcs, std::vector<flit*>());
+
+    // find the vcs that have to stay put; the last ring node is the
+    // first one again, so node 'idx' drains into node
+    // '(idx + 1) % num_nodes'
+    int num_nodes = spinRing.size() - 1;
+    std::vector<std::vector<bool> > occupied(num_nodes,
+                                             std::vector<bool>(num_vcs));
+    std::vector<std::vector<bool> > pinned(num_nodes,
+                                           std::vector<bool>(num_vcs));
+    for (int idx = 0; idx < num_nodes; idx++) {
+        Router* router = m_routers[spinRing[idx].router_id_];
+        int inport = router->m_routing_unit\
+                                ->m_inports_dirn2idx[spinRing[idx].inport_dir_];
+        InputUnit* input_unit = router->get_inputUnit_ref()[inport];
+        for (int k = 0; k < num_vcs; k++) {
+            occupied[idx][k] = !input_unit->vc_isEmpty(vcs[k]);
+            // an empty but active vc still belongs to a packet
+            // whose tail is upstream; nothing may be drained into it
+            pinned[idx][k] = occupied[idx][k] ?
+                !input_unit->vc_has_whole_packet(vcs[k]) :
+                (input_unit->get_vc_state(vcs[k]) == ACTIVE_);
+        }
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int idx = num_nodes - 1; idx >= 0; idx--) {
+            int next = (idx + 1) % num_nodes;
+            for (int k = 0; k < num_vcs; k++) {
+                if (occupied[idx][k] && !pinned[idx][k] && pinned[next][k]) {
+                    pinned[idx][k] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
 
     // 2-stage credit management
     for (int idx = 0; idx < spinRing.size() - 1; idx++) { // stage to remove flits
@@ -279,30 +438,40 @@ GarnetNetwork::doSpin(int vc_) {
 
         int inport = router->m_routing_unit\
                                 ->m_inports_dirn2idx[spinRing[idx].inport_dir_];
-        if(router->get_inputUnit_ref()[inport]->vc_isEmpty(vc_)) {
-            // 'idx+1' node alredy populated with 'NULL' for member flit_
-            // populate every flit...
-            // this just means that flit should be nullptr
-
-            spinRing[idx+1].flit_ = nullptr;
-            m_bubble++;
-
-        } else {
-            // take this flit out... and put it in the next node
+        InputUnit* input_unit = router->get_inputUnit_ref()[inport];
+
+        // upstream router feeding this inport; same for all vcs
+        Router* upstream_router = nullptr;
+        int outport = -1;
+
+        for (int k = 0; k < num_vcs; k++) {
+            int vc_ = vcs[k];
+            if(!occupied[idx][k]) {
+                // 'idx+1' node alredy populated with 'NULL' for this vc
+                m_bubble++;
+                continue;
+            }
+            if (pinned[idx][k]) {
+                m_drain_pinned++;
+                num_pinned++;
+                continue;
+            }
+            // take this packet out... and put it in the next node
             //////////////////////////////////////////////////
             //
-            flit* t_flit = router->get_inputUnit_ref()[inport]->peekTopFlit(vc_);
+            flit* t_flit = input_unit->peekTopFlit(vc_); // head flit
             std::vector<int> pref_outport = router->m_routing_unit\
                                ->lookupRoutingTable_pref_outport(t_flit->get_vnet(),
                                t_flit->get_route().net_dest);
-            spinRing[idx+1].flit_ =
-                    router->get_inputUnit_ref()[inport]->getTopFlit(vc_); // ptr-cpy
+            std::vector<flit*>& pkt = spinRing[idx+1].pkts_[k];
+            while (!input_unit->vc_isEmpty(vc_))
+                pkt.push_back(input_unit->getTopFlit(vc_)); // ptr-cpy
+            assert(pkt.size() == t_flit->get_size());
             num_pkts++;
             int idx_;
             for (idx_ = 0; idx_ < pref_outport.size(); idx_++) {
                 // check if the outport leads to router_id
                 // present at spinRing[idx+1].router_id_
-                // cout << pref_outport[idx_] << " ";
                 PortDirection next_hop_dir_ = \
                 router->get_outputUnit_ref().at(pref_outport[idx_])->get_direction();
                 int pref_router_id = get_upstreamId(next_hop_dir_, router->get_id());
@@ -319,38 +488,46 @@ GarnetNetwork::doSpin(int vc_) {
                 m_misroute++;
             }
 
+            // every flit carries the forward progress of its packet,
+            // which is escalated once
+            for (int f = 0; f < pkt.size(); f++)
+                pkt[f]->increment_drain_count(idx_ == pref_outport.size());
+            if ((idx_ == pref_outport.size()) &&
+                (m_escalation_thrshld > 0) &&
+                (t_flit->get_drain_misroutes() == m_escalation_thrshld)) {
+                m_escalated_pkts++;
+            }
 
             // update the hops_needed_efore_spin, in the flit here
-            assert(spinRing[idx+1].flit_->hops_needed_before_spin == -1);\
-
-            spinRing[idx+1].flit_->hops_needed_before_spin = router\
-                                             ->compute_hops_remaining(spinRing[idx+1].flit_);
+            assert(t_flit->hops_needed_before_spin == -1);
+            t_flit->hops_needed_before_spin =
+                router->compute_hops_remaining(t_flit);
 
             // set vc idle:
-            router->get_inputUnit_ref()[inport]->set_vc_idle(vc_/*vc-id*/, curCycle());
+            input_unit->set_vc_idle(vc_/*vc-id*/, curCycle());
             // credit management stage-1:
             // from whichever router's input port you are taking out flit..
             // increment the credits in the outVC state of corresponding
             // upstream router.. and update the vc_state for outvc.
-            Router* upstream_router = get_upstreamrouter(spinRing[idx].inport_dir_,
-                                                            router->get_id());
-            assert(upstream_router != nullptr);
-            // now you have got the upstream router...mark the outvc0 as IDLE and
-            // increment credit.
-            PortDirection outportDirn = get_upstreamOutportDirn(spinRing[idx].inport_dir_);
-            assert(outportDirn != "Local");
-            int outport = upstream_router->m_routing_unit\
-                                                    ->m_outports_dirn2idx[outportDirn];
-
-            upstream_router->get_outputUnit_ref()[outport]->increment_credit(vc_);
+            if (upstream_router == nullptr) {
+                upstream_router = get_upstreamrouter(spinRing[idx].inport_dir_,
+                                                     router->get_id());
+                assert(upstream_router != nullptr);
+                PortDirection outportDirn =
+                    get_upstreamOutportDirn(spinRing[idx].inport_dir_);
+                assert(outportDirn != "Local");
+                outport = upstream_router->m_routing_unit\
+                                            ->m_outports_dirn2idx[outportDirn];
+            }
+            // now you have got the upstream router...mark the outvc as IDLE and
+            // return one credit per flit taken out.
+            for (int f = 0; f < pkt.size(); f++)
+                upstream_router->get_outputUnit_ref()[outport]->increment_credit(vc_);
             upstream_router->get_outputUnit_ref()[outport]->set_vc_state(IDLE_, vc_, curCycle());
         }
     }
     // cout << "Packets actually spun: " << num_pkts << endl;
-    assert( spun_pkt_num == num_pkts );
-    // cout << "num_pkts spun: " << num_pkts << endl;
-    // print_spinRing();
-    // print out the spin-ring structure here...
+    assert(spun_pkt_num == num_pkts + num_pinned);
 
     // Stage-2 of credit management...
     // decrement the credits in corresponding upstream router whenever
@@ -358,17 +535,24 @@ GarnetNetwork::doSpin(int vc_) {
     // by deque--spinRing. update the vc state as well for both input vc
     // and outvc.
     for (int idx = 1; idx < spinRing.size(); idx++) { // stage to insert flit.
+        Router* router = m_routers[spinRing[idx].router_id_];
+        int inport = router->m_routing_unit\
+                                ->m_inports_dirn2idx[spinRing[idx].inport_dir_];
+        assert(inport < router->get_inputUnit_ref().size());
 
-        if(spinRing[idx].flit_ != nullptr) {
+        Router* upstream_router = nullptr;
+        int upstream_outport = -1;
 
-            Router* router = m_routers[spinRing[idx].router_id_];
+        for (int k = 0; k < num_vcs; k++) {
+            std::vector<flit*>& pkt = spinRing[idx].pkts_[k];
+            if (pkt.empty())
+                continue;
 
-            int inport = router->m_routing_unit\
-                                    ->m_inports_dirn2idx[spinRing[idx].inport_dir_];
-            assert(inport < router->get_inputUnit_ref().size());
-            flit *t_flit;
-            t_flit = spinRing[idx].flit_;
+            int vc_ = vcs[k];
             num_pkts--;
+            // route is computed for the head flit; the rest of the
+            // packet follows it
+            flit *t_flit = pkt[0];
             int outport = router->route_compute(t_flit->get_route(),
                     inport, spinRing[idx].inport_dir_);
 
@@ -379,9 +563,13 @@ GarnetNetwork::doSpin(int vc_) {
             PortDirection outdir;
             outdir = router->getOutportDirection(outport);
             t_flit->set_outport_dir(outdir);
-            // increment the number of hops here for the flit
-            t_flit->increment_hops();
-            router->get_inputUnit_ref()[inport]->m_vcs[vc_]->insertFlit(t_flit);
+            assert(router->get_inputUnit_ref()[inport]->vc_isEmpty(vc_));
+            for (int f = 0; f < pkt.size(); f++) {
+                // increment the number of hops here for the flit
+                pkt[f]->increment_hops();
+                router->get_inputUnit_ref()[inport]->insert_flit(vc_, pkt[f]);
+            }
+            router->m_drain_flits += pkt.size();
 
             // stats update:
             assert(t_flit->hops_needed_after_spin == -1);
@@ -394,54 +582,87 @@ GarnetNetwork::doSpin(int vc_) {
             // reset the stats in flit object
             t_flit->hops_needed_after_spin = -1;
             t_flit->hops_needed_before_spin = -1;
-            assert(router->get_inputUnit_ref()[inport]->m_vcs[vc_]->get_state() == IDLE_);
+            assert(router->get_inputUnit_ref()[inport]->get_vc_state(vc_) == IDLE_);
             // set-vc active
             router->get_inputUnit_ref()[inport]->set_vc_active(vc_, curCycle());
 
             //////////////////////////////////////////
             // decrement-credit from upstream router... and mark out-vc as active
-            Router* upstream_router = get_upstreamrouter(spinRing[idx].inport_dir_,
-                                                                router->get_id());
-            assert(upstream_router != nullptr);
-            // Mark outVC-0 of this router as ACTIVE_ and decrement credit.
-            PortDirection outportDirn = get_upstreamOutportDirn(spinRing[idx].inport_dir_);
-            assert(outportDirn != "Local");
-            int upstream_outport = upstream_router->m_routing_unit\
-                                        ->m_outports_dirn2idx[outportDirn];
-            upstream_router->get_outputUnit_ref()[upstream_outport]->decrement_credit(vc_);
+            if (upstream_router == nullptr) {
+                upstream_router = get_upstreamrouter(spinRing[idx].inport_dir_,
+                                                     router->get_id());
+                assert(upstream_router != nullptr);
+                PortDirection outportDirn =
+                    get_upstreamOutportDirn(spinRing[idx].inport_dir_);
+                assert(outportDirn != "Local");
+                upstream_outport = upstream_router->m_routing_unit\
+                                            ->m_outports_dirn2idx[outportDirn];
+            }
+            // Mark outVC of this router as ACTIVE_ and take one credit
+            // per flit put in.
+            for (int f = 0; f < pkt.size(); f++)
+                upstream_router->get_outputUnit_ref()[upstream_outport]->decrement_credit(vc_);
             upstream_router->get_outputUnit_ref()[upstream_outport]->set_vc_state(ACTIVE_,
                                                         vc_, curCycle());
-
-
-        }
-        else {
-            // cout << "Not inserting at this iteration number.." << endl;
         }
     }
 
     assert(num_pkts == 0);
     // scanNetwork();
     // clean ring.
-    for(auto itr : spinRing ) {
-        itr.flit_ = nullptr; // ptr-cpy
-    }
+    for (int idx = 0; idx < spinRing.size(); idx++)
+        spinRing[idx].pkts_.clear();
 
     return;
 }
 
+bool
+GarnetNetwork::is_drain_due(int vnet, Cycles epoch_start)
+{
+    uint32_t freq = m_vnet_spin_freq[vnet];
+    return ((freq != 0) && (uint64_t(epoch_start) % freq == 0));
+}
+
+bool
+GarnetNetwork::any_drain_due(Cycles epoch_start)
+{
+    for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+        if (is_drain_due(vnet, epoch_start))
+            return true;
+    }
+    return false;
+}
+
+// collect the vcs to be drained in the epoch starting at
+// 'epoch_start': the base vc of each due vnet, or every vc
+// of each due vnet when 'base_vc_only' is false.
+void
+GarnetNetwork::get_drain_vcs(Cycles epoch_start, bool base_vc_only,
+                             std::vector<int>& vcs)
+{
+    vcs.clear();
+    for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+        if (!is_drain_due(vnet, epoch_start))
+            continue;
+        int vc_base = vnet * m_vcs_per_vnet;
+        int num = base_vc_only ? 1 : m_vcs_per_vnet;
+        for (int vc_ = vc_base; vc_ < vc_base + num; vc_++)
+            vcs.push_back(vc_);
+    }
+}
+
 
 void
 GarnetNetwork::print_spinRing() {
     for( int kk=0; kk < spinRing.size(); kk++) {
         cout << "------------" << endl;
-        if (spinRing[kk].flit_ != NULL) {
-            cout << "[spinRing-Node: "<< kk <<" ] Router-id: " << spinRing[kk].router_id_ \
-                << " inport_dir_: " << spinRing[kk].inport_dir_ << " " <<*(spinRing[kk].flit_) << endl;
-            cout << *(spinRing[kk].flit_->m_msg_ptr) << endl;
-        }
-        else {
-            cout << "[spinRing-Node: "<< kk <<" ] Router-id: " << spinRing[kk].router_id_ \
-                << " inport_dir_: " << spinRing[kk].inport_dir_ << endl;
+        cout << "[spinRing-Node: "<< kk <<" ] Router-id: " << spinRing[kk].router_id_ \
+            << " inport_dir_: " << spinRing[kk].inport_dir_ << endl;
+        for (int k = 0; k < spinRing[kk].pkts_.size(); k++) {
+            for (int f = 0; f < spinRing[kk].pkts_[k].size(); f++) {
+                cout << *(spinRing[kk].pkts_[k][f]) << endl;
+                cout << *(spinRing[kk].pkts_[k][f]->m_msg_ptr) << endl;
+            }
         }
     }
 }
@@ -453,6 +674,12 @@ GarnetNetwork::print_spinRing() {
 // and at vc = vc_
 void
 GarnetNetwork::set_flit_time(int vc_)
+{
+    set_flit_time(std::vector<int>(1, vc_));
+}
+
+void
+GarnetNetwork::set_flit_time(const std::vector<int>& vcs)
 {
     for (vector<Router*>::const_iterator itr= m_routers.begin();
         itr != m_routers.end(); ++itr) {
@@ -460,18 +687,26 @@ GarnetNetwork::set_flit_time(int vc_)
         // in this 'router' set time of flit accordingly for
         // "North"; "East"; "South"; "West" ports accordingly.
         for (int inport = 0; inport < router->get_num_inports(); inport++) {
-            if(router->get_inputUnit_ref()[inport]->vc_isEmpty(vc_) == false) {
-                PortDirection dirn_ = router->get_inputUnit_ref()[inport]->get_direction();
-                if ((dirn_ == "North") || (dirn_ == "South") ||
-                    (dirn_ == "East") || (dirn_ == "West")) {
-                        flit* t_flit;
-                        t_flit = (router->get_inputUnit_ref()[inport]->peekTopFlit(vc_));
-                        assert(t_flit != nullptr);
-                        // t_flit->set_time(curCycle() + Cycles(2*m_spin_mult));
-                        t_flit->advance_stage(SA_, curCycle() + Cycles(2*m_spin_mult));
+            PortDirection dirn_ = router->get_inputUnit_ref()[inport]->get_direction();
+            if ((dirn_ != "North") && (dirn_ != "South") &&
+                (dirn_ != "East") && (dirn_ != "West"))
+                continue;
+            for (int k = 0; k < vcs.size(); k++) {
+                if(router->get_inputUnit_ref()[inport]->vc_isEmpty(vcs[k]) == false) {
+                    flit* t_flit;
+                    t_flit = (router->get_inputUnit_ref()[inport]->peekTopFlit(vcs[k]));
+                    assert(t_flit != nullptr);
+                    // escalated flits are not held back after the drain;
+                    // they compete in SA from the next cycle on
+                    if (is_escalated(t_flit)) {
+                        t_flit->advance_stage(SA_, curCycle());
+                        router->schedule_wakeup(Cycles(1));
+                        continue;
+                    }
+                    // t_flit->set_time(curCycle() + Cycles(2*m_spin_mult));
+                    t_flit->advance_stage(SA_, curCycle() + Cycles(2*m_spin_mult));
                 }
             }
-
         }
     }
 }
@@ -500,7 +735,160 @@ GarnetNetwork::wakeup_all_output_unit() {
 
 void
 GarnetNetwork::wakeup() {
+    if ((m_trace_reader != NULL) && !m_trace_done)
+        replay_trace();
+
+    // periodic livelock monitor
+    if ((m_livelock_thrshld > 0) && (curCycle() >= m_next_progress_check)) {
+        check_forward_progress();
+        Cycles period = Cycles(std::max(m_livelock_thrshld / 2, 1u));
+        m_next_progress_check = curCycle() + period;
+        scheduleEvent(period);
+    }
+}
 
+// Hand the trace packets that are due to their source NIs. An NI takes
+// up to 'm_trace_ni_queue_depth' packets; the due packets beyond that
+// wait in its own 'm_trace_pending' queue, so that a busy NI does not
+// hold back the others. Reading only stops while
+// 'm_trace_buffer_packets' packets are pending, which (with the bounded
+// read-ahead of the reader) bounds the memory used by the trace.
+void
+GarnetNetwork::replay_trace()
+{
+    if (m_trace_num_pending > 0) {
+        for (int ni = 0; ni < m_nodes; ni++) {
+            std::deque<NetworkTraceRecord>& pending = m_trace_pending[ni];
+            while (!pending.empty() && (m_nis[ni]->get_direct_queue_size()
+                                        < m_trace_ni_queue_depth)) {
+                inject_trace_packet(pending.front());
+                pending.pop_front();
+                m_trace_num_pending--;
+            }
+        }
+    }
+
+    while (!m_trace_eof) {
+        if (!trace_next_packet.valid) {
+            if (m_trace_num_pending >= m_trace_buffer_packets)
+                break;
+            if (!m_trace_reader->next(trace_next_packet)) {
+                m_trace_eof = true;
+                break;
+            }
+
+            NetworkTraceRecord& rec = trace_next_packet;
+            if ((rec.src_id < 0) || (rec.src_id >= m_nodes) ||
+                (rec.dest_id < 0) || (rec.dest_id >= m_nodes) ||
+                (rec.vnet < 0) || (rec.vnet >= m_virtual_networks) ||
+                (rec.num_flits <= 0)) {
+                fatal("network trace packet %d: bad src %d, dest %d, "
+                      "vnet %d or number of flits %d\n",
+                      m_trace_reader->get_num_read(), rec.src_id,
+                      rec.dest_id, rec.vnet, rec.num_flits);
+            }
+            rec.src_router_id = get_router_id(rec.src_id);
+            rec.dest_router_id = get_router_id(rec.dest_id);
+        }
+
+        if (trace_next_packet.time > curCycle()) {
+            scheduleEvent(trace_next_packet.time - curCycle());
+            break;
+        }
+
+        int src = trace_next_packet.src_id;
+        if (m_trace_pending[src].empty() &&
+            (m_nis[src]->get_direct_queue_size() < m_trace_ni_queue_depth)) {
+            inject_trace_packet(trace_next_packet);
+        } else {
+            m_trace_pending[src].push_back(trace_next_packet);
+            m_trace_num_pending++;
+        }
+        trace_next_packet.valid = false;
+    }
+
+    if (m_trace_num_pending > 0) {
+        scheduleEvent(Cycles(1));
+    } else if (m_trace_eof) {
+        m_trace_done = true;
+        cout << "trace replay: all " << trace_num_packets_injected
+             << " packets injected at cycle " << curCycle() << endl;
+        check_trace_done();
+    }
+}
+
+void
+GarnetNetwork::inject_trace_packet(const NetworkTraceRecord& record)
+{
+    m_nis[record.src_id]->enqueueDirectPacket(record);
+    trace_num_packets_injected++;
+    trace_num_flits_injected += record.num_flits;
+}
+
+void
+GarnetNetwork::increment_trace_flits_received()
+{
+    trace_num_flits_received++;
+    check_trace_done();
+}
+
+// the replay ends once every trace flit has been received
+void
+GarnetNetwork::check_trace_done()
+{
+    if (m_trace_done &&
+        (trace_num_flits_received == trace_num_flits_injected)) {
+        cout << "trace replay: " << trace_num_packets_injected
+             << " packets (" << trace_num_flits_injected
+             << " flits) received by cycle " << curCycle() << endl;
+        exitSimLoop("network trace replay complete");
+    }
+}
+
+// Walk every network input vc and find the oldest flit. A flit
+// that has been in the network for more than 'm_livelock_thrshld'
+// cycles is taken as a livelock (or deadlock) and the simulation
+// is stopped right away, so that the stats collected so far are
+// still dumped instead of the run being killed from outside.
+void
+GarnetNetwork::check_forward_progress()
+{
+    flit* oldest_flit = nullptr;
+    Cycles oldest_age = Cycles(0);
+    int oldest_router = -1;
+
+    for (vector<Router*>::const_iterator itr= m_routers.begin();
+         itr != m_routers.end(); ++itr) {
+        Router* router = safe_cast<Router*>(*itr);
+        for (int inport = 0; inport < router->get_num_inports(); inport++) {
+            InputUnit* input_unit = router->get_inputUnit_ref()[inport];
+            for (int vc_ = 0; vc_ < router->get_num_vcs(); vc_++) {
+                if (input_unit->vc_isEmpty(vc_))
+                    continue;
+                flit* t_flit = input_unit->peekTopFlit(vc_);
+                Cycles age = curCycle() - t_flit->get_enqueue_time();
+                if (age > oldest_age) {
+                    oldest_age = age;
+                    oldest_flit = t_flit;
+                    oldest_router = router->get_id();
+                }
+            }
+        }
+    }
+
+    update_max_flit_age(oldest_age);
+
+    if (oldest_age > Cycles(m_livelock_thrshld)) {
+        assert(oldest_flit != nullptr);
+        cout << "livelock monitor: flit at router " << oldest_router
+             << " is " << oldest_age << " cycles old (drained "
+             << oldest_flit->get_drain_count() << " times, misrouted "
+             << oldest_flit->get_drain_misroutes() << " times) at cycle "
+             << curCycle() << endl;
+        cout << *oldest_flit << endl;
+        m_livelock_exit++;
+        exitSimLoop("livelock detected: flit exceeded livelock threshold");
+    }
 }
 
 void
@@ -537,6 +925,57 @@ GarnetNetwork::init()
         m_num_cols = -1;
     }
 
+    if ((m_routing_algorithm == UP_DN_) ||
+        (m_routing_algorithm == ESCAPE_VC_UP_DN_) ||
+        (m_routing_algorithm == MIN_ADAPT_) ||
+        (m_routing_algorithm == DEFLECTION_)) {
+        init_routing_tables();
+    }
+    if ((m_routing_algorithm == ESCAPE_VC_UP_DN_) && (m_vcs_per_vnet < 2)) {
+        fatal("Escape-VC routing needs at least 2 vcs per vnet\n");
+    }
+    // SMART takes the first free vc of the vnet at each hop
+    if ((m_smart_hpc_max > 1) && (m_routing_algorithm == ESCAPE_VC_UP_DN_))
+        fatal("SMART bypass does not support escape-vc routing\n");
+    // multicasts are routed on the routing table, which breaks the
+    // deadlock freedom of up*/down* paths
+    if (m_enable_multicast && ((m_routing_algorithm == UP_DN_) ||
+                               (m_routing_algorithm == ESCAPE_VC_UP_DN_))) {
+        fatal("In-network multicast does not support up*/down* routing\n");
+    }
+    if (isDeflectionEnabled()) {
+        if (m_spin)
+            fatal("Deflection routing is bufferless: DRAIN (spin) has "
+                  "nothing to drain\n");
+        if (m_enable_multicast)
+            fatal("In-network multicast does not support deflection "
+                  "routing\n");
+        if (m_lookahead_routing || m_router_bypass ||
+            (m_smart_hpc_max > 1))
+            fatal("Deflection routing has its own single-cycle pipeline: "
+                  "no lookahead routing, router bypass or SMART\n");
+        if (m_shared_input_buffers)
+            fatal("Deflection routing is bufferless: no shared input "
+                  "buffers\n");
+        for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+            if (m_ordered[vnet])
+                fatal("Deflection routing reorders packets but vnet %d is "
+                      "ordered\n", vnet);
+        }
+        // every flit arriving at a router must find an outport
+        for (int router = 0; router < m_routers.size(); router++) {
+            int num_in = 0, num_out = 0;
+            for (int port = 0; port < m_link_src[router].size(); port++)
+                num_in += (m_link_src[router][port] != -1);
+            for (int port = 0; port < m_link_dest[router].size(); port++)
+                num_out += (m_link_dest[router][port] != -1);
+            if (num_out < num_in)
+                fatal("Router %d has %d links in but %d links out: "
+                      "deflection routing needs as many\n",
+                      router, num_in, num_out);
+        }
+    }
+
     // FaultModel: declare each router to the fault model
     if (isFaultModelEnabled()) {
         for (vector<Router*>::const_iterator i= m_routers.begin();
@@ -554,102 +993,42 @@ GarnetNetwork::init()
         }
     }
 
-    const char *trace_filename; //[100];
-    trace_filename = m_trace_filename.c_str();
-    //strcpy(trace_filename, m_trace_filename);
-    char  command_string[512];
-
-    sprintf(command_string,"gunzip -c %s", trace_filename);
-    if (( tracefile= popen(command_string, "r")) == NULL){
-        printf("Command string is %s\n", command_string);
-    }
-
-    // Read first thirteen lines of the trace
-    int count = 13;
-    char trstring [1000];
-
-    while (count > 0) {
-        if ( fgets (trstring , 1000, tracefile) != NULL ) {
-            count--;
-            //puts (trstring);
-        } else {
-            break;
-        }
-    }
-
-/*
-    char trstring [1000];
-    bool done = false;
-
-    // Read trace up to point when packets start
-    while (!done) {
-        if ( fgets (trstring , 1000, tracefile) != NULL ) {
-            puts (trstring);
-
-            // Step 2: Get tokens
-
-            // array to store memory addresses of the tokens in buf
-            const char* first_token;
-
-            first_token = strtok(trstring, " "); // first token
-            std::string trace_start = "info";
-
-            if (strcmp(first_token, trace_start.c_str())) {
-                done = true;
-            }
-        } else {
-            done = true;
-        }
-    }
-*/
     trace_num_packets_injected = 0;
     trace_num_flits_injected = 0;
     trace_num_flits_received = 0;
 
-    trace_start_time = 0;
-
     // Initialize next packet
     trace_next_packet.valid = false;
     trace_next_packet.time = Cycles(0);
     trace_next_packet.src_id = -1;
     trace_next_packet.dest_id = -1;
+    m_trace_eof = false;
+    m_trace_pending.resize(m_nodes);
+    m_trace_num_pending = 0;
+
+    // the trace is read in the background, and handed to the NIs
+    // by wakeup() as its packets become due
+    if (m_trace_enable) {
+        m_trace_reader = new NetworkTraceReader(m_trace_filename,
+                                                m_trace_max_packets,
+                                                m_trace_buffer_packets);
+        scheduleEvent(Cycles(1));
+    }
 
-    /*
-    // Trace Read
-    ifstream fin;
-    fin.open("data.txt");
-    if (!fin.good())
-        exit(0);
-
-    // read each line of the file
-    while (!fin.eof())
-    {
-        // read an entire line into memory
-        char buf[MAX_CHARS_PER_LINE];
-        fin.getline(buf, MAX_CHARS_PER_LINE);
-
-        // parse the line into blank-delimited tokens
-        int n = 0; // loop idex
-
-        // array to store memory addresses of the tokens in buf
-        const char* token[MAX_TOKENS_PER_LINE] = {}; // initialize to 0
-
-        // parse the line
-        token[0] = strtok(buf, DELIMITER); // first token
-        if (token[0]) // zero if line is blank
-        {
-            for (n = 1; n < MAX_TOKENS_PER_LINE; n++)
-            {
-                token[n] = strtok(0, DELIMITER); // subsequent tokens
-                if (!token[n]) break; // no more tokens
-            }
-        }
+    // start the livelock monitor
+    if (m_livelock_thrshld > 0) {
+        Cycles period = Cycles(std::max(m_livelock_thrshld / 2, 1u));
+        m_next_progress_check = period;
+        scheduleEvent(period);
+    }
 
-        // process (print) the tokens
-        for (int i = 0; i < n; i++) // n = #of tokens
-            DPRINTF(NetworkTrace, "Token[%d] = %s\n", i, token[i]);
+    // runtime energy accounting
+    if (!m_energy_tech_file.empty()) {
+        m_energy_model = new NetworkEnergyModel(this, m_energy_tech_file,
+                                                m_energy_output);
+        if (m_energy_epoch > 0)
+            schedule(m_energy_event, clockEdge(m_energy_epoch));
     }
-    */
 
 //    scheduleWakeupAbsolute(curCycle() + Cycles(1));
 	Sequencer::gnet = this;
@@ -837,36 +1216,15 @@ GarnetNetwork::check_mrkd_flt()
 }
 
 
+// true if no flit is on a link leaving a router (the outlinks of
+// the routers, read from one array rather than router by router)
 bool
 GarnetNetwork::chck_link_state() {
-    bool spin_safe_ = true;
-    // cout << "^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^" << endl;
-    for (vector<Router*>::const_iterator itr= m_routers.begin();
-         itr != m_routers.end(); ++itr) {
-        Router* router = safe_cast<Router*>(*itr);
-        // cout << "--------" << endl;
-        // cout << "~~~~~~~~~~~~~~~" << endl;
-        // cout << "Router_id: " << router->get_id() << " Cycle: " << curCycle() << endl;
-        for (int outport = 0; outport < router->get_num_outports(); outport++) {
-            // print here the outport ID and flit in that outport Link...
-            PortDirection direction_ = router->get_outputUnit_ref()[outport]\
-                                                                ->get_direction();
-            // cout << "outport: " << outport << " direction: " << direction_ << endl;
-            assert(outport == router->get_outputUnit_ref()[outport]->get_id());
-            if(router->get_outputUnit_ref()[outport]->m_out_link->linkBuffer->isEmpty()) {
-                /*cout << "outport: " << outport << " direction(link): " << direction_ \
-                    << " is EMPTY" << endl;*/
-            } else {
-                spin_safe_ = false;
-                /*cout << "outport: " << outport << " direction(link): " << direction_ \
-                    << " is NOT-EMPTY" << endl;
-                cout << *(router->get_outputUnit_ref()[outport]->m_out_link\
-                            ->linkBuffer->peekTopFlit()) << endl;*/
-            }
-        }
+    for (int i = 0; i < m_router_out_links.size(); i++) {
+        if (!m_router_out_links[i]->linkBuffer->isEmpty())
+            return false;
     }
-    // cout << "^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^" << endl;
-    return (spin_safe_);
+    return true;
 }
 
 GarnetNetwork::~GarnetNetwork()
@@ -875,6 +1233,15 @@ GarnetNetwork::~GarnetNetwork()
     deletePointers(m_nis);
     deletePointers(m_networklinks);
     deletePointers(m_creditlinks);
+    delete m_trace_reader;
+    delete m_energy_model;
+}
+
+void
+GarnetNetwork::sample_energy()
+{
+    m_energy_model->sample();
+    schedule(m_energy_event, clockEdge(m_energy_epoch));
 }
 
 /*
@@ -929,6 +1296,8 @@ GarnetNetwork::makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    m_router_out_links.push_back(net_link);
+
     PortDirection src_outport_dirn = "Local";
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
@@ -956,11 +1325,262 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
 
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
+    m_router_out_links.push_back(net_link);
 
     m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
                                link->m_weight, credit_link);
+    add_router_link(src, dest);
+}
+
+// Record the link just added from the last outport of 'src' to the
+// last inport of 'dest'.
+void
+GarnetNetwork::add_router_link(SwitchID src, SwitchID dest)
+{
+    int outport = m_routers[src]->get_num_outports() - 1;
+    int inport = m_routers[dest]->get_num_inports() - 1;
+
+    if (m_link_dest[src].size() <= outport)
+        m_link_dest[src].resize(outport + 1, -1);
+    m_link_dest[src][outport] = dest;
+    if (m_link_dest_inport[src].size() <= outport)
+        m_link_dest_inport[src].resize(outport + 1, -1);
+    m_link_dest_inport[src][outport] = inport;
+
+    if (m_link_src[dest].size() <= inport)
+        m_link_src[dest].resize(inport + 1, -1);
+    m_link_src[dest][inport] = src;
+}
+
+int
+GarnetNetwork::get_link_dest(int router, int outport)
+{
+    if (outport >= m_link_dest[router].size())
+        return -1;
+    return m_link_dest[router][outport];
+}
+
+// router connected to the outport of 'router_id' in direction
+// 'dirn'; NULL if that link does not exist (irregular mesh)
+Router*
+GarnetNetwork::get_neighbor_router(int router_id, PortDirection dirn)
+{
+    int outport = m_routers[router_id]->m_routing_unit->get_outport(dirn);
+    if (outport == -1)
+        return NULL;
+
+    int dest = get_link_dest(router_id, outport);
+    if (dest == -1)
+        return NULL;
+    return m_routers[dest];
+}
+
+int
+GarnetNetwork::get_link_dest_inport(int router, int outport)
+{
+    if (outport >= m_link_dest_inport[router].size())
+        return -1;
+    return m_link_dest_inport[router][outport];
+}
+
+int
+GarnetNetwork::get_link_src(int router, int inport)
+{
+    if (inport >= m_link_src[router].size())
+        return -1;
+    return m_link_src[router][inport];
+}
+
+bool
+GarnetNetwork::is_up_link(int src, int dest)
+{
+    return ((m_updn_level[dest] < m_updn_level[src]) ||
+            ((m_updn_level[dest] == m_updn_level[src]) && (dest < src)));
+}
+
+int
+GarnetNetwork::mesh_hop_dist(int router, int dest) const
+{
+    return std::abs(router % m_num_cols - dest % m_num_cols) +
+           std::abs(router / m_num_cols - dest / m_num_cols);
+}
+
+int
+GarnetNetwork::get_hop_dist(int router, int dest)
+{
+    if (m_full_mesh)
+        return mesh_hop_dist(router, dest);
+    return m_hop_dist[router][dest];
+}
+
+int
+GarnetNetwork::get_updn_dist(int router, int dest, bool down_only)
+{
+    if (m_full_mesh) {
+        // the level of a router is its row plus its column: up links
+        // go West or South, down links East or North, and a shortest
+        // path takes all of its up links first
+        if (down_only && ((dest % m_num_cols < router % m_num_cols) ||
+                          (dest / m_num_cols < router / m_num_cols))) {
+            return INFINITE_;
+        }
+        return mesh_hop_dist(router, dest);
+    }
+    return down_only ? m_updn_dist_down[router][dest] :
+                       m_updn_dist[router][dest];
+}
+
+/*
+ * Build the tables used by the topology-agnostic routing algorithms
+ * from the links that actually exist:
+ *  - the minimal hop distance between every pair of routers,
+ *  - a BFS spanning tree rooted at router 0, which orients every
+ *    link 'up' (towards the root) or 'down', and the length of the
+ *    shortest legal up/down path (never a down link followed by an
+ *    up link) between every pair of routers.
+ * Distances are computed by a backwards BFS from each destination.
+ * On a full mesh they follow from the coordinates instead: the
+ * num_routers^2 tables would take 32 MB each at 4096 routers.
+ */
+void
+GarnetNetwork::init_routing_tables()
+{
+    int num_routers = m_routers.size();
+
+    m_full_mesh = (m_num_rows > 0);
+    for (int r = 0; m_full_mesh && (r < num_routers); r++) {
+        std::vector<int> neighbours;
+        int col = r % m_num_cols, row = r / m_num_cols;
+        if (col + 1 < m_num_cols)
+            neighbours.push_back(r + 1);
+        if (col > 0)
+            neighbours.push_back(r - 1);
+        if (row + 1 < m_num_rows)
+            neighbours.push_back(r + m_num_cols);
+        if (row > 0)
+            neighbours.push_back(r - m_num_cols);
+        std::vector<int> links;
+        for (int outport = 0; outport < m_link_dest[r].size(); outport++) {
+            if (m_link_dest[r][outport] != -1)
+                links.push_back(m_link_dest[r][outport]);
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        std::sort(links.begin(), links.end());
+        links.erase(std::unique(links.begin(), links.end()), links.end());
+        m_full_mesh = (links == neighbours);
+    }
+
+    // spanning tree levels: hops from the root
+    m_updn_level.assign(num_routers, INFINITE_);
+    std::queue<int> from_root;
+    m_updn_level[0] = 0;
+    from_root.push(0);
+    while (!from_root.empty()) {
+        int v = from_root.front();
+        from_root.pop();
+        for (int outport = 0; outport < m_link_dest[v].size(); outport++) {
+            int u = m_link_dest[v][outport];
+            if ((u != -1) && (m_updn_level[u] == INFINITE_)) {
+                m_updn_level[u] = m_updn_level[v] + 1;
+                from_root.push(u);
+            }
+        }
+    }
+    if (m_full_mesh)
+        return;
+
+    // upstream routers of each router
+    std::vector<std::vector<int> > preds(num_routers);
+    for (int src = 0; src < num_routers; src++) {
+        for (int outport = 0; outport < m_link_dest[src].size(); outport++) {
+            if (m_link_dest[src][outport] != -1)
+                preds[m_link_dest[src][outport]].push_back(src);
+        }
+    }
+
+    m_hop_dist.assign(num_routers,
+                      std::vector<uint16_t>(num_routers, INFINITE_));
+    for (int dest = 0; dest < num_routers; dest++) {
+        std::queue<int> bfs;
+        m_hop_dist[dest][dest] = 0;
+        bfs.push(dest);
+        while (!bfs.empty()) {
+            int v = bfs.front();
+            bfs.pop();
+            for (int i = 0; i < preds[v].size(); i++) {
+                int u = preds[v][i];
+                if (m_hop_dist[u][dest] == INFINITE_) {
+                    m_hop_dist[u][dest] = m_hop_dist[v][dest] + 1;
+                    bfs.push(u);
+                }
+            }
+        }
+    }
+
+    for (int src = 0; src < num_routers; src++) {
+        for (int dest = 0; dest < num_routers; dest++) {
+            if (m_hop_dist[src][dest] == INFINITE_) {
+                fatal("Router %d cannot reach router %d over the "
+                      "network links\n", src, dest);
+            }
+        }
+    }
+
+    m_updn_dist_down.assign(num_routers,
+                            std::vector<uint16_t>(num_routers, INFINITE_));
+    m_updn_dist.assign(num_routers,
+                       std::vector<uint16_t>(num_routers, INFINITE_));
+    typedef std::pair<int, int> DistNode;
+    for (int dest = 0; dest < num_routers; dest++) {
+        // down links only
+        std::queue<int> bfs;
+        m_updn_dist_down[dest][dest] = 0;
+        bfs.push(dest);
+        while (!bfs.empty()) {
+            int v = bfs.front();
+            bfs.pop();
+            for (int i = 0; i < preds[v].size(); i++) {
+                int u = preds[v][i];
+                if (!is_up_link(u, v) &&
+                    (m_updn_dist_down[u][dest] == INFINITE_)) {
+                    m_updn_dist_down[u][dest] =
+                        m_updn_dist_down[v][dest] + 1;
+                    bfs.push(u);
+                }
+            }
+        }
+
+        // up links followed by the down-only path
+        std::priority_queue<DistNode, std::vector<DistNode>,
+                            std::greater<DistNode> > pq;
+        for (int r = 0; r < num_routers; r++) {
+            m_updn_dist[r][dest] = m_updn_dist_down[r][dest];
+            if (m_updn_dist[r][dest] != INFINITE_)
+                pq.push(DistNode(m_updn_dist[r][dest], r));
+        }
+        while (!pq.empty()) {
+            DistNode top = pq.top();
+            pq.pop();
+            int v = top.second;
+            if (top.first != m_updn_dist[v][dest])
+                continue;
+            for (int i = 0; i < preds[v].size(); i++) {
+                int u = preds[v][i];
+                if (is_up_link(u, v) &&
+                    (m_updn_dist[v][dest] + 1 < m_updn_dist[u][dest])) {
+                    m_updn_dist[u][dest] = m_updn_dist[v][dest] + 1;
+                    pq.push(DistNode(m_updn_dist[u][dest], u));
+                }
+            }
+        }
+    }
+
+    for (int src = 0; src < num_routers; src++) {
+        for (int dest = 0; dest < num_routers; dest++)
+            assert(m_updn_dist[src][dest] != INFINITE_);
+    }
 }
 
 // Total routers in the network
@@ -1061,6 +1681,21 @@ GarnetNetwork::regStats()
     total_pre_drain_deadlock
         .name(name() + ".total_pre_drain_deadlock");
 
+    // Forward progress
+    m_livelock_exit
+        .name(name() + ".livelock_exit");
+    m_escalated_pkts
+        .name(name() + ".escalated_packets");
+    m_max_flit_age
+        .name(name() + ".max_flit_age");
+    m_max_flit_drain_count
+        .name(name() + ".max_flit_drain_count");
+    m_flt_drain_count_hist
+        .init(16)
+        .name(name() + ".flit_drain_count_histogram")
+        .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
+        ;
+
     total_post_drain_deadlock
         .name(name() + ".total_post_drain_deadlock");
 
@@ -1187,6 +1822,24 @@ GarnetNetwork::regStats()
         .name(name() + ".total_flit_misroute");
     m_bubble
         .name(name() + ".total_bubble_movement");
+    m_drain_pinned
+        .name(name() + ".total_drain_pinned_vcs");
+    m_escape_vc_pkts
+        .name(name() + ".escape_vc_packets");
+    m_multicast_pkts
+        .name(name() + ".multicast_packets");
+    m_multicast_forks
+        .name(name() + ".multicast_forks");
+    m_deflections
+        .name(name() + ".deflected_flits");
+    m_lookahead_routes
+        .name(name() + ".lookahead_routed_flits");
+    m_bypassed_flits
+        .name(name() + ".router_bypass_flits");
+    m_smart_bypassed_hops
+        .name(name() + ".smart_bypassed_hops");
+    m_smart_halted
+        .name(name() + ".smart_bypass_halted");
     m_num_drain
         .name(name() + ".total_DRAIN_spins");
 
@@ -1408,11 +2061,21 @@ GarnetNetwork::regStats()
 
     m_misroute_per_pkt
         .name(name() + ".misroute_per_pkt");
-    m_misroute_per_pkt = m_total_misroute / sum(m_flits_received);
+    m_misroute_per_pkt = m_total_misroute / sum(m_packets_received);
 
     m_total_spins
         .name(name() + ".total_spins");
 
+    m_energy_dynamic
+        .name(name() + ".energy_dynamic")
+        .flags(Stats::nozero);
+    m_energy_leakage
+        .name(name() + ".energy_leakage")
+        .flags(Stats::nozero);
+    m_energy_drain
+        .name(name() + ".energy_drain")
+        .flags(Stats::nozero);
+
     m_average_vc_load
         .init(m_virtual_networks * m_vcs_per_vnet)
         .name(name() + ".avg_vc_load")
@@ -1439,6 +2102,9 @@ GarnetNetwork::collateStats()
     RubySystem *rs = params()->ruby_system;
     double time_delta = double(curCycle() - rs->getStartCycle());
 
+    for (int i = 0; i < m_nis.size(); i++)
+        m_nis[i]->flushStats();
+
     for (int i = 0; i < m_networklinks.size(); i++) {
         link_type type = m_networklinks[i]->getType();
         int activity = m_networklinks[i]->getLinkUtilization();
@@ -1463,6 +2129,71 @@ GarnetNetwork::collateStats()
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
     }
+
+    // the last (partial) energy epoch ends here
+    if (m_energy_model != nullptr) {
+        m_energy_model->sample();
+        m_energy_dynamic = m_energy_model->get_dynamic_energy();
+        m_energy_leakage = m_energy_model->get_leakage_energy();
+        m_energy_drain = m_energy_model->get_drain_energy();
+    }
+}
+
+// The same updates as the increment_*() and update_*() functions
+// above for each flit, minus those of marked flits, which do not go
+// through the accumulators.
+void
+GarnetNetwork::merge_flit_stats(FlitStatsAccumulator& flit_stats)
+{
+    if (flit_stats.num_flits == 0)
+        return;
+
+    for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+        m_flits_received[vnet] += flit_stats.flits_received[vnet];
+        m_packets_received[vnet] += flit_stats.packets_received[vnet];
+        m_flit_network_latency[vnet] +=
+            flit_stats.flit_network_latency[vnet];
+        m_flit_queueing_latency[vnet] +=
+            flit_stats.flit_queueing_latency[vnet];
+        m_packet_network_latency[vnet] +=
+            flit_stats.packet_network_latency[vnet];
+        m_packet_queueing_latency[vnet] +=
+            flit_stats.packet_queueing_latency[vnet];
+    }
+    m_total_hops += flit_stats.total_hops;
+    for (int i = 0; i < flit_stats.network_latency_histogram.size(); i++)
+        m_network_latency_histogram[i] +=
+            flit_stats.network_latency_histogram[i];
+
+    flit_stats.latency_hist.flush(m_flt_latency_hist);
+    flit_stats.network_latency_hist.flush(m_flt_network_latency_hist);
+    flit_stats.queueing_latency_hist.flush(m_flt_queueing_latency_hist);
+    flit_stats.drain_count_hist.flush(m_flt_drain_count_hist);
+
+    max_flit_latency = std::max(max_flit_latency, flit_stats.max_latency);
+    max_flit_network_latency = std::max(max_flit_network_latency,
+                                        flit_stats.max_network_latency);
+    max_flit_queueing_latency = std::max(max_flit_queueing_latency,
+                                         flit_stats.max_queueing_latency);
+    min_flit_latency = std::min(min_flit_latency, flit_stats.min_latency);
+    min_flit_network_latency = std::min(min_flit_network_latency,
+                                        flit_stats.min_network_latency);
+    min_flit_queueing_latency = std::min(min_flit_queueing_latency,
+                                         flit_stats.min_queueing_latency);
+    m_max_flit_latency = max_flit_latency;
+    m_max_flit_network_latency = max_flit_network_latency;
+    m_max_flit_queueing_latency = max_flit_queueing_latency;
+    m_min_flit_latency = min_flit_latency;
+    m_min_flit_network_latency = min_flit_network_latency;
+    m_min_flit_queueing_latency = min_flit_queueing_latency;
+
+    update_max_flit_age(flit_stats.max_age);
+    if (flit_stats.max_drain_count > max_flit_drain_count) {
+        max_flit_drain_count = flit_stats.max_drain_count;
+        m_max_flit_drain_count = max_flit_drain_count;
+    }
+
+    flit_stats.clear();
 }
 
 void
@@ -1471,9 +2202,184 @@ GarnetNetwork::print(ostream& out) const
     out << "[GarnetNetwork]";
 }
 
+// the links of a topology file are not SimObjects of the
+// configuration, so a checkpoint would not match the system restored
+// from it (see make_topology_links())
+void
+GarnetNetwork::serialize(CheckpointOut &cp) const
+{
+    if (m_native_links)
+        fatal("%s: no checkpoints with topology_file or topology_gen; "
+              "use the Python links of the topology instead\n", name());
+    Network::serialize(cp);
+}
+
+void
+GarnetNetwork::unserialize(CheckpointIn &cp)
+{
+    if (m_native_links)
+        fatal("%s: no checkpoints with topology_file or topology_gen\n",
+              name());
+    Network::unserialize(cp);
+}
+
+// Parameters of a NetworkLink (or CreditLink) as the Python
+// GarnetIntLink would set them.
+static void
+init_link_params(NetworkLinkParams *lp, const GarnetNetworkParams *p,
+                 const std::string& name, int link_id)
+{
+    lp->name = name;
+    lp->eventq_index = p->eventq_index;
+    lp->clk_domain = p->clk_domain;
+    lp->default_p_state = p->default_p_state;
+    lp->p_state_clk_gate_bins = p->p_state_clk_gate_bins;
+    lp->p_state_clk_gate_max = p->p_state_clk_gate_max;
+    lp->p_state_clk_gate_min = p->p_state_clk_gate_min;
+    lp->link_id = link_id;
+    lp->link_latency = p->topology_link_latency;
+    lp->vcs_per_vnet = p->vcs_per_vnet;
+    lp->virt_nets = p->number_of_virtual_networks;
+    lp->width_bits = p->topology_link_width_bits;
+    lp->serdes_latency = p->topology_link_serdes_latency;
+    lp->flit_size = p->ni_flit_size;
+}
+
+// Position of the link src -> dest in the order irregularMesh_XY.py
+// creates the links of a connectivity matrix: the East links, then
+// West, North and South, each group by row or by column. Keeping it
+// keeps the link ids and the port numbering of the routers.
+static std::pair<int, int>
+python_link_order(int src, int dest, int rows, int cols)
+{
+    if (dest == src + 1)
+        return std::make_pair(0, src);
+    if (dest == src - 1)
+        return std::make_pair(1, dest);
+    if (dest == src + cols)
+        return std::make_pair(2, (src % cols) * rows + src / cols);
+    return std::make_pair(3, (dest % cols) * rows + dest / cols);
+}
+
+// Create the internal links of 'p->topology_file' (or of the
+// topology generated from p->topology_gen_*) and add them to
+// 'p->int_links', before the Topology is built from them, in the
+// order irregularMesh_XY.py creates them.
+// This skips the Python SimObjects of large topologies, so the links
+// are outside the SimObject tree: they get no init(), startup() or
+// regStats() (they have none; the network collects their stats), only
+// reset callbacks, and no checkpoint section, so GarnetNetwork refuses
+// to checkpoint with them (see serialize()). They still drain, as
+// every Drainable is known to the DrainManager.
+static void
+make_topology_links(GarnetNetworkParams *p)
+{
+    int num_routers = p->routers.size();
+    if (p->topology_gen) {
+        if ((p->num_rows <= 0) || (num_routers % p->num_rows != 0))
+            fatal("topology_gen: %d routers do not make a mesh of %d "
+                  "rows\n", num_routers, p->num_rows);
+        if ((p->topology_gen_fault_prob < 0) ||
+            (p->topology_gen_fault_prob > 1))
+            fatal("topology_gen_fault_prob %f is not a probability\n",
+                  p->topology_gen_fault_prob);
+    }
+    TopologyFile topology = p->topology_gen ?
+        TopologyFile::generate(p->num_rows, num_routers / p->num_rows,
+                 p->topology_gen_links_removed, p->topology_gen_fault_prob,
+                 p->topology_gen_seed) :
+        TopologyFile(p->topology_file);
+
+    if (topology.get_rows() * topology.get_cols() != num_routers)
+        fatal("%s: %d x %d mesh for %d routers\n", topology.get_name(),
+              topology.get_rows(), topology.get_cols(), num_routers);
+    if (topology.get_rows() != p->num_rows)
+        fatal("%s: %d rows, but the network has %d\n", topology.get_name(),
+              topology.get_rows(), p->num_rows);
+
+    // a generated topology is kept in the output directory, to be
+    // replayed with topology_file / spin_file; DRAIN spins its ring
+    if (p->topology_gen) {
+        OutputStream *matrix = simout.create("topology_matrix.txt");
+        topology.write_matrix(*matrix->stream());
+        simout.close(matrix);
+        OutputStream *ring = simout.create("SR_topology_matrix.txt");
+        topology.write_spin_ring(*ring->stream());
+        simout.close(ring);
+        if (p->topology_gen_spin_ring)
+            p->spin_file = simout.resolve("SR_topology_matrix.txt");
+    }
+
+    std::vector<BasicRouter *> routers(num_routers, nullptr);
+    for (int i = 0; i < num_routers; i++) {
+        int id = p->routers[i]->params()->router_id;
+        assert((id >= 0) && (id < num_routers));
+        routers[id] = p->routers[i];
+    }
+
+    // every link joins neighbours (see add_link())
+    std::vector<std::pair<int, int> > links = topology.get_links();
+    int rows = topology.get_rows(), cols = topology.get_cols();
+    std::sort(links.begin(), links.end(),
+              [rows, cols](const std::pair<int, int>& a,
+                           const std::pair<int, int>& b) {
+                  return python_link_order(a.first, a.second, rows, cols) <
+                      python_link_order(b.first, b.second, rows, cols);
+              });
+
+    // these objects are not in the Python hierarchy: stats resets
+    // reach their links through the reset callbacks
+    int link_id = p->ext_links.size() + p->int_links.size();
+    for (int i = 0; i < links.size(); i++, link_id++) {
+        std::string name = csprintf("%s.topology_links%d", p->name, i);
+
+        NetworkLinkParams *net_params = new NetworkLinkParams;
+        init_link_params(net_params, p, name + ".network_link", link_id);
+        NetworkLink *net_link = net_params->create();
+        Stats::registerResetCallback(
+            new MakeCallback<NetworkLink, &NetworkLink::resetStats>(
+                net_link));
+
+        CreditLinkParams *credit_params = new CreditLinkParams;
+        init_link_params(credit_params, p, name + ".credit_link", link_id);
+        // as in GarnetLink.py, credits are not serialized
+        credit_params->width_bits = 0;
+        credit_params->serdes_latency = Cycles(0);
+        CreditLink *credit_link = credit_params->create();
+        Stats::registerResetCallback(
+            new MakeCallback<NetworkLink, &NetworkLink::resetStats>(
+                credit_link));
+
+        GarnetIntLinkParams *link_params = new GarnetIntLinkParams;
+        link_params->name = name;
+        link_params->eventq_index = p->eventq_index;
+        link_params->link_id = link_id;
+        link_params->latency = p->topology_link_latency;
+        link_params->bandwidth_factor = 16; // only used by simple network
+        link_params->weight = 1;
+        link_params->src_node = routers[links[i].first];
+        link_params->dst_node = routers[links[i].second];
+        topology.get_directions(links[i].first, links[i].second,
+                                link_params->src_outport,
+                                link_params->dst_inport);
+        link_params->width_bits = p->topology_link_width_bits;
+        link_params->serdes_latency = p->topology_link_serdes_latency;
+        link_params->network_link = net_link;
+        link_params->credit_link = credit_link;
+        p->int_links.push_back(link_params->create());
+    }
+
+    inform("%s: %d links between %d routers\n", topology.get_name(),
+           links.size(), num_routers);
+}
+
 GarnetNetwork *
 GarnetNetworkParams::create()
 {
+    // the links of a topology file join the Python ones before the
+    // Topology is built from them
+    if (topology_gen || !topology_file.empty())
+        make_topology_links(this);
     return new GarnetNetwork(this);
 }
 
@@ -43,6 +43,11 @@
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "mem/ruby/network/garnet2.0/FlitStatsAccumulator.hh"
+#include "mem/ruby/network/garnet2.0/NetworkEnergyModel.hh"
+#include "mem/ruby/network/garnet2.0/NetworkTraceReader.hh"
+#include "mem/ruby/network/garnet2.0/VcStateStore.hh"
 #include "mem/ruby/network/garnet2.0/flit.hh"
 #include "params/GarnetNetwork.hh"
 #include "sim/sim_exit.hh"
@@ -58,17 +63,6 @@ class NetworkLink;
 class CreditLink;
 class flit;
 
-struct NetworkTraceRecord {
-    bool valid;
-    Cycles time;
-    int src_id;
-    int src_router_id;
-    int dest_id;
-    int dest_router_id;
-    int vnet;
-    int num_flits;
-};
-
 class GarnetNetwork : public Network, public Consumer
 {
   public:
@@ -77,6 +71,8 @@ class GarnetNetwork : public Network, public Consumer
 
     ~GarnetNetwork();
     void init();
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
     void wakeup();
     void scheduleWakeupAbsolute(Cycles time);
 
@@ -92,6 +88,15 @@ class GarnetNetwork : public Network, public Consumer
     uint32_t getBuffersPerDataVC() { return m_buffers_per_data_vc; }
     uint32_t getBuffersPerCtrlVC() { return m_buffers_per_ctrl_vc; }
     int getRoutingAlgorithm() const { return m_routing_algorithm; }
+    const std::string& getSwAllocator() const { return m_sw_allocator; }
+    int getIslipIterations() const { return m_islip_iterations; }
+
+    // reproducible random streams: one per component, all derived
+    // from 'rng_seed'
+    uint64_t getRngSeed() const { return m_rng_seed; }
+    CounterRNG get_rng_stream(RngStreamType type, int id) const
+    { return m_rng_root.split(type).split(id); }
+    CounterRNG& drain_rng() { return m_drain_rng; }
 
     bool isFaultModelEnabled() const { return m_enable_fault_model; }
     FaultModel* fault_model;
@@ -110,12 +115,31 @@ class GarnetNetwork : public Network, public Consumer
     }
     int getNumRouters();
     int get_router_id(int ni);
+    NetworkInterface* get_ni(int ni) { return m_nis[ni]; }
 
 
     int get_upstreamId(PortDirection outport_dir, int upstream_id);
     Router* get_upstreamrouter(PortDirection outport_dir, int upstream_id);
     PortDirection get_upstreamOutportDirn(PortDirection outport_dir);
 
+    // router-level graph over the network links; -1 for
+    // ports connected to a network interface
+    int get_link_dest(int router, int outport);
+    int get_link_src(int router, int inport);
+    // inport of the downstream router behind 'outport' of 'router'
+    int get_link_dest_inport(int router, int outport);
+    Router* get_neighbor_router(int router_id, PortDirection dirn);
+
+    // distances for topology-agnostic routing, from the actual
+    // links: tables built at init, or from the coordinates of the
+    // routers if the links make a full mesh
+    void init_routing_tables();
+    int get_hop_dist(int router, int dest);
+    // up*/down*: a link is 'up' if it goes towards the root of
+    // the BFS spanning tree (router 0)
+    bool is_up_link(int src, int dest);
+    int get_updn_dist(int router, int dest, bool down_only);
+
     // Methods used by Topology to setup the network
     void makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
                      const NetDest& routing_table_entry);
@@ -132,6 +156,9 @@ class GarnetNetwork : public Network, public Consumer
 
     // Stats
     void collateStats();
+    // add the flits ejected at an NI since the last merge to the
+    // stats, and clear 'flit_stats'
+    void merge_flit_stats(FlitStatsAccumulator& flit_stats);
     void regStats();
     void print(std::ostream& out) const;
 
@@ -321,6 +348,51 @@ class GarnetNetwork : public Network, public Consumer
     void
     increment_num_drain() { m_num_drain++; }
 
+    // number of DRAIN spins a flit went through before ejection; the
+    // histogram is sampled once per packet, at its tail
+    void
+    update_flit_drain_count(int count, bool is_tail)
+    {
+        if (is_tail)
+            m_flt_drain_count_hist.sample(count);
+        if (count > max_flit_drain_count) {
+            max_flit_drain_count = count;
+            m_max_flit_drain_count = max_flit_drain_count;
+        }
+    }
+
+    // cycles a flit spent in the network, at ejection or in the
+    // livelock monitor
+    void
+    update_max_flit_age(Cycles age)
+    {
+        if (age > max_flit_age) {
+            max_flit_age = age;
+            m_max_flit_age = max_flit_age;
+        }
+    }
+
+    // a flit misrouted by DRAIN at least 'm_escalation_thrshld'
+    // times gets priority in SA and in drain placement
+    bool
+    is_escalated(flit* t_flit)
+    {
+        return ((m_escalation_thrshld > 0) &&
+                (t_flit->get_drain_misroutes() >= m_escalation_thrshld));
+    }
+    bool isEscalationEnabled() const { return (m_escalation_thrshld > 0); }
+    bool isMulticastEnabled() const { return m_enable_multicast; }
+    bool isLookaheadEnabled() const { return m_lookahead_routing; }
+    bool isRouterBypassEnabled() const { return m_router_bypass; }
+    int getSmartHpcMax() const { return m_smart_hpc_max; }
+    bool isSharedInputBuffers() const { return m_shared_input_buffers; }
+    int getDamqBuffersPerPort() const { return m_damq_buffers_per_port; }
+    int getDamqReservedPerVC() const { return m_damq_reserved_per_vc; }
+    bool isDeflectionEnabled() const
+    { return (m_routing_algorithm == DEFLECTION_); }
+    VcStateStore *get_vc_store() { return &m_vc_store; }
+    void check_forward_progress();
+
     void
     check_network_saturation()
     {
@@ -335,7 +407,9 @@ class GarnetNetwork : public Network, public Consumer
             exitSimLoop("avg flit latency exceeded threshold!.");
         // Due to livelock if sim-type-2 takes a very long time
         // then exit thsi simulation so that other can procced.
-        if(curCycle() > 1000000 ) {
+        // When the livelock monitor is enabled it detects this
+        // much earlier (see check_forward_progress()).
+        if((m_livelock_thrshld == 0) && (curCycle() > 1000000)) {
             m_pre_mature_exit++;
             exitSimLoop("Simulation exceed its cycle quota!");
         }
@@ -350,18 +424,45 @@ class GarnetNetwork : public Network, public Consumer
     void scanNetwork(int vnet);
     bool chck_link_state();
     void doSpin( int vc_ );
+    void doSpin(const std::vector<int>& vcs);
     void init_spinRing();
     void set_flit_time(int vc_);
+    void set_flit_time(const std::vector<int>& vcs);
+    // per-vnet drain schedule
+    bool is_drain_due(int vnet, Cycles epoch_start);
+    bool any_drain_due(Cycles epoch_start);
+    void get_drain_vcs(Cycles epoch_start, bool base_vc_only,
+                       std::vector<int>& vcs);
     void wakeup_all_input_unit();
     void wakeup_all_output_unit();
     // member-varibles for spin-technique
     bool m_spin;
     uint32_t m_spin_thrshld;
+    // drain period of each vnet; 'm_spin_thrshld' is their gcd
+    std::vector<uint32_t> m_vnet_spin_freq;
     uint32_t m_spin_mult;
     uint32_t drain_all_vc;
+    // forward-progress guarantee and livelock monitor
+    uint32_t m_escalation_thrshld;
+    bool m_enable_multicast;
+    bool m_lookahead_routing;
+    bool m_router_bypass;
+    int m_smart_hpc_max;
+    // DAMQ: input buffers shared by the vcs of a port
+    bool m_shared_input_buffers;
+    int m_damq_buffers_per_port;
+    int m_damq_reserved_per_vc;
+    uint32_t m_livelock_thrshld;
+    Cycles m_next_progress_check;
+    // random streams
+    uint64_t m_rng_seed;
+    CounterRNG m_rng_root;
+    CounterRNG m_drain_rng;
     // int m_spin_config;
     std::string m_conf_file;
     std::string m_spin_file;
+    // links of a topology file (see GarnetNetworkParams::create())
+    bool m_native_links;
     int m_uTurn_crossbar;
 //    Cycles print_cycle;
     int lock;
@@ -369,6 +470,25 @@ class GarnetNetwork : public Network, public Consumer
     Stats::Scalar m_total_uturn_request;
     Stats::Scalar m_success_uturn;
     Stats::Scalar m_total_misroute;
+    Stats::Scalar m_escape_vc_pkts;
+    Stats::Scalar m_multicast_pkts;
+    // copies made where the branches of a multicast diverge
+    Stats::Scalar m_multicast_forks;
+    // flits sent on a non-productive link by deflection routing
+    Stats::Scalar m_deflections;
+    // head flits routed one router ahead, and flits which traversed
+    // a router in one cycle on the bypass path
+    Stats::Scalar m_lookahead_routes;
+    Stats::Scalar m_bypassed_flits;
+    // SMART: routers bypassed, and bypasses refused by routers
+    // halted for a DRAIN spin
+    Stats::Scalar m_smart_bypassed_hops;
+    Stats::Scalar m_smart_halted;
+    // runtime energy model (pJ); drain moves are part of the dynamic
+    // energy
+    Stats::Scalar m_energy_dynamic;
+    Stats::Scalar m_energy_leakage;
+    Stats::Scalar m_energy_drain;
     Stats::Scalar m_total_spins;
     Stats::Formula m_misroute_per_pkt;
     Stats::Vector m_pre_drain_deadlock_cycles;
@@ -384,14 +504,15 @@ class GarnetNetwork : public Network, public Consumer
                     router_id_( id_ ),
                     inport_dir_( dirn_)
         {
-            flit_ = nullptr;
         }
         int router_id_;
         PortDirection inport_dir_;
-        // flit that needs to be put in the router
-        // at above populated router-id and inputport
-        // unit.. we are always using vc-0
-        flit* flit_;
+        // packets (all their flits, head first) that need
+        // to be put in the router at above populated
+        // router-id and inputport unit.. one slot per vc
+        // drained in this ring pass (same order as the
+        // 'vcs' given to doSpin)
+        std::vector<std::vector<flit*> > pkts_;
     };
 
     // flit *dummy_flit_ = new flit();
@@ -406,6 +527,13 @@ class GarnetNetwork : public Network, public Consumer
     uint64_t pre_drain_deadlock_cycle_idx;
     uint64_t post_drain_deadlock_cycle_idx;
     Stats::Scalar m_pre_mature_exit;
+    Stats::Scalar m_livelock_exit;
+    Stats::Scalar m_escalated_pkts;
+    Stats::Scalar m_max_flit_age;
+    Stats::Scalar m_max_flit_drain_count;
+    Stats::Histogram m_flt_drain_count_hist;
+    Cycles max_flit_age;
+    int max_flit_drain_count;
 
     uint64_t marked_flt_injected;
     uint64_t marked_flt_received;
@@ -446,10 +574,14 @@ class GarnetNetwork : public Network, public Consumer
     uint32_t m_buffers_per_ctrl_vc;
     uint32_t m_buffers_per_data_vc;
     int m_routing_algorithm;
+    std::string m_sw_allocator;
+    int m_islip_iterations;
     bool m_enable_fault_model;
     bool m_trace_enable;
     std::string m_trace_filename;
     int m_trace_max_packets;
+    uint32_t m_trace_buffer_packets;
+    uint32_t m_trace_ni_queue_depth;
 
     // Statistical variables
     Stats::Vector m_network_latency_histogram;
@@ -464,6 +596,7 @@ class GarnetNetwork : public Network, public Consumer
     Stats::Scalar m_fwd_progress;
     Stats::Scalar m_misroute;
     Stats::Scalar m_bubble;
+    Stats::Scalar m_drain_pinned;
     Stats::Scalar m_num_drain;
     Stats::Formula m_fwd_progress_per_drain;
     Stats::Formula m_misroute_per_drain;
@@ -546,14 +679,53 @@ class GarnetNetwork : public Network, public Consumer
     std::vector<NetworkLink *> m_networklinks; // All flit links in the network
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
-
-    // Trace File
-    FILE * tracefile;
+    // the links leaving the routers, for chck_link_state()
+    std::vector<NetworkLink *> m_router_out_links;
+    // state of all the vcs of the routers and NIs (see VcStateStore.hh)
+    VcStateStore m_vc_store;
+
+    // [router][outport] -> downstream router and
+    // [router][inport] -> upstream router (-1: NI)
+    std::vector<std::vector<int> > m_link_dest;
+    std::vector<std::vector<int> > m_link_src;
+    std::vector<std::vector<int> > m_link_dest_inport;
+    void add_router_link(SwitchID src, SwitchID dest);
+
+    // no tables: every router has its mesh neighbours, and only them
+    bool m_full_mesh;
+    int mesh_hop_dist(int router, int dest) const;
+    // [router][dest] minimal hops over the network links
+    std::vector<std::vector<uint16_t> > m_hop_dist;
+    // level of each router in the up*/down* spanning tree
+    std::vector<int> m_updn_level;
+    // [router][dest] hops of the shortest legal up*/down* path
+    // (any number of up links followed by down links), and of
+    // the shortest path using down links only
+    std::vector<std::vector<uint16_t> > m_updn_dist;
+    std::vector<std::vector<uint16_t> > m_updn_dist_down;
+
+    // runtime energy, sampled every m_energy_epoch cycles
+    void sample_energy();
+    NetworkEnergyModel *m_energy_model;
+    std::string m_energy_tech_file;
+    std::string m_energy_output;
+    Cycles m_energy_epoch;
+    EventFunctionWrapper m_energy_event;
+
+    // Trace replay
+    void replay_trace();
+    void inject_trace_packet(const NetworkTraceRecord& record);
+    void check_trace_done();
+    NetworkTraceReader *m_trace_reader;
+    bool m_trace_eof; // every trace packet read
+    bool m_trace_done; // every trace packet handed to its NI
     NetworkTraceRecord trace_next_packet;
-    int trace_num_packets_injected; // number of packets injected so far
-    int trace_num_flits_injected;
-    int trace_num_flits_received; // number of trace flits received
-    int trace_start_time; // time-stamp of first packet in trace
+    // due packets waiting for their NI to take them, per NI
+    std::vector<std::deque<NetworkTraceRecord>> m_trace_pending;
+    uint64_t m_trace_num_pending;
+    uint64_t trace_num_packets_injected; // number of packets injected so far
+    uint64_t trace_num_flits_injected;
+    uint64_t trace_num_flits_received; // number of trace flits received
 };
 
 inline std::ostream&
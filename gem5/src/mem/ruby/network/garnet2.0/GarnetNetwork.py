@@ -44,8 +44,20 @@ class GarnetNetwork(RubyNetwork):
     spin = Param.UInt32(0, "To enable spin technique")
     drain_all_vc = Param.UInt32(0, "when set all vcs will be drained")
     spin_freq = Param.UInt32(0, "How often are we going to spin")
+    spin_freq_per_vnet = VectorParam.UInt32([],
+                 "per-vnet spin period in cycles (0: never drain that vnet);" \
+                 " when empty every vnet spins every spin_freq cycles")
     spin_mult = Param.UInt32(0,
                  "How many multiple times are we going to spin on its turn")
+    escalation_threshold = Param.UInt32(0,
+                 "drain misroutes after which a packet gets priority in SA " \
+                 "and drain placement (0: disabled)")
+    livelock_threshold = Param.UInt32(0,
+                 "exit the simulation once a flit has been in the network " \
+                 "for this many cycles (0: disabled)")
+    rng_seed = Param.UInt64(0,
+                 "seed of the random streams used by routing and drains; " \
+                 "every router gets its own stream derived from it")
     conf_file = Param.String("up-down routing configuration file")
     uTurn_crossbar = Param.Int32(1,
                   "If check if uTurns are allowed (1) or not(0). uTurns are " \
@@ -53,12 +65,65 @@ class GarnetNetwork(RubyNetwork):
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel");
     routing_algorithm = Param.Int(0,
-        "0: Weight-based Table, 1: XY, 2: Custom");
+        "0: Weight-based Table, 1: XY, 2: Random, 3: Adaptive-Random, " \
+        "4: West-First, 5: Adaptive West-First, 6: Custom, " \
+        "7: Up*/Down*, 8: Escape-VC Up*/Down*, " \
+        "9: Minimal Adaptive (distance table), " \
+        "10: Bufferless Deflection");
+    enable_multicast = Param.Bool(False, "send single-flit multicasts as " \
+                  "one packet replicated in the routers, instead of a " \
+                  "unicast per destination")
+    lookahead_routing = Param.Bool(False, "compute the outport of head " \
+                  "flits one router ahead (saves a pipeline stage)")
+    router_bypass = Param.Bool(False, "flits reaching an empty router " \
+                  "go to switch allocation on arrival")
+    smart_hpc_max = Param.UInt32(0, "SMART: maximum hops a flit may " \
+                  "cross in one cycle along a straight path (0 or 1: off)")
+    sw_allocator = Param.String("separable", "switch allocator: " \
+                  "separable (input-first round robin), islip, " \
+                  "wavefront or oldest_first")
+    islip_iterations = Param.UInt32(1, "iterations of the iSLIP allocator")
+    shared_input_buffers = Param.Bool(False, "router input ports share " \
+                  "one pool of buffers among their vcs (DAMQ)")
+    damq_buffers_per_port = Param.UInt32(0, "DAMQ: buffers per input " \
+                  "port (0: as many as the per-vc buffers add up to)")
+    damq_reserved_per_vc = Param.UInt32(1, "DAMQ: buffers of the pool " \
+                  "reserved to each vc")
     enable_fault_model = Param.Bool(False, "enable network fault model");
     fault_model = Param.FaultModel(NULL, "network fault model");
     trace_enable = Param.Bool(False, "enable trace simulation");
     trace_file  = Param.String(" ", "network trace input file");
     trace_max_packets = Param.Int(-1, "maximum trace packets to inject");
+    trace_buffer_packets = Param.UInt32(65536,
+                  "trace packets read ahead of the simulation");
+    trace_ni_queue_depth = Param.UInt32(1024,
+                  "trace packets queued at an NI; later ones wait in a " \
+                  "per-NI queue of the network");
+    topology_file = Param.String("", "router-to-router links of a " \
+                  "mesh, read natively (connectivity matrix or binary " \
+                  "edge list, see garnet2.0/TopologyFile.hh)")
+    topology_link_latency = Param.Cycles(1, "latency of the links of " \
+                  "topology_file")
+    topology_link_width_bits = Param.UInt32(0, "width in bits of the " \
+                  "links of topology_file (0: one flit)")
+    topology_link_serdes_latency = Param.Cycles(0, "serialization/" \
+                  "deserialization latency of the links of topology_file")
+    topology_gen = Param.Bool(False, "generate a random irregular mesh " \
+                  "of num_rows rows instead of reading topology_file")
+    topology_gen_links_removed = Param.UInt32(0, "bidirectional links " \
+                  "removed from the generated mesh")
+    topology_gen_fault_prob = Param.Float(0.0, "probability of removing " \
+                  "each link of the generated mesh " \
+                  "(if topology_gen_links_removed is 0)")
+    topology_gen_seed = Param.UInt32(1, "seed of the topology generator")
+    topology_gen_spin_ring = Param.Bool(True, "DRAIN spins a ring " \
+                  "generated with the topology instead of spin_file")
+    energy_tech_file = Param.String("", "per-event energies of the " \
+                  "runtime energy model (empty: no energy accounting)")
+    energy_epoch = Param.UInt32(10000, "cycles per energy epoch " \
+                  "(0: one epoch per stats dump)")
+    energy_output = Param.String("garnet_energy.txt",
+                  "per-epoch energy of each router, in the output directory")
     garnet_deadlock_threshold = Param.UInt32(50000,
                               "network-level deadlock threshold")
     sim_type = Param.Int(Parent.sim_type, "simulation_type")
@@ -72,6 +137,40 @@ class GarnetNetwork(RubyNetwork):
     spin_file = Param.String(Parent.spin_file,
 					"file path containing SPIN-ring information for DRAIN")
 
+class GarnetTrafficSource(ClockedObject):
+    type = 'GarnetTrafficSource'
+    cxx_header = "mem/ruby/network/garnet2.0/GarnetTrafficSource.hh"
+
+    traffic_type = Param.String("uniform_random", "Traffic type")
+    inj_rate = Param.Float(0.1, "Packet injection rate")
+    inj_vnet = Param.Int(-1, "Vnet to inject in. \
+                              Default is to inject in all vnets")
+    precision = Param.Int(3, "Number of digits of precision \
+                              after decimal point")
+    num_dest = Param.Int(1, "Number of Destinations")
+    dest_base = Param.Int(0, "NI id of the first destination")
+    single_dest = Param.Int(-1, "Send only to this dest. \
+                                 Default depends on traffic_type")
+    num_packets_max = Param.Int(-1, "Max number of packets to send. \
+                        Default is to keep sending till simulation ends")
+    max_queued_packets = Param.UInt32(64,
+                  "packets waiting at the NI before the source throttles")
+    skip_ahead = Param.Int(0, "as for GarnetSyntheticTraffic")
+    num_rows = Param.Int(0, "as for GarnetSyntheticTraffic")
+    hotspot_nodes = VectorParam.Int([], "as for GarnetSyntheticTraffic")
+    hotspot_fraction = Param.Float(0.0, "as for GarnetSyntheticTraffic")
+    permutation_file = Param.String("", "as for GarnetSyntheticTraffic")
+    rate_matrix_file = Param.String("", "as for GarnetSyntheticTraffic")
+    burst_on_cycles = Param.Float(0, "as for GarnetSyntheticTraffic")
+    burst_off_cycles = Param.Float(0, "as for GarnetSyntheticTraffic")
+    max_outstanding = Param.Int(0, "closed loop: requests in flight " \
+                  "before the source stalls, each answered by its " \
+                  "destination; 0: open loop")
+    service_cycles = Param.Cycles(1, "closed loop: cycles a destination " \
+                                     "takes to answer a request")
+    response_vnet = Param.Int(-1, "closed loop: vnet of the responses; " \
+                                  "-1: the first data vnet")
+
 class GarnetNetworkInterface(ClockedObject):
     type = 'GarnetNetworkInterface'
     cxx_class = 'NetworkInterface'
@@ -84,6 +183,11 @@ class GarnetNetworkInterface(ClockedObject):
                           "number of virtual networks")
     garnet_deadlock_threshold = Param.UInt32(Parent.garnet_deadlock_threshold,
                                       "network-level deadlock threshold")
+    traffic_source = Param.GarnetTrafficSource(NULL,
+                  "synthetic traffic injected directly at this NI")
+    service_queue_depth = Param.UInt32(16, "closed loop: requests " \
+                  "served at once here; further requests wait in the " \
+                  "network (0: no limit)")
 
 class GarnetRouter(BasicRouter):
     type = 'GarnetRouter'
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/GarnetTrafficSource.hh"
+
+#include <cmath>
+
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
+#include "sim/stats.hh"
+
+GarnetTrafficSource::GarnetTrafficSource(const Params *p)
+    : ClockedObject(p),
+      m_tick_event([this]{ tick(); }, "GarnetTrafficSource tick",
+                   false, Event::CPU_Tick_Pri),
+      m_ni(NULL), m_net_ptr(NULL),
+      m_pattern(NULL), m_injection(NULL),
+      m_inj_rate(p->inj_rate),
+      m_burst_on_cycles(p->burst_on_cycles),
+      m_burst_off_cycles(p->burst_off_cycles),
+      m_inj_vnet(p->inj_vnet),
+      m_precision(p->precision),
+      m_num_dest(p->num_dest),
+      m_dest_base(p->dest_base),
+      m_single_dest(p->single_dest),
+      m_num_packets_max(p->num_packets_max),
+      m_num_packets_sent(0),
+      m_max_queued_packets(p->max_queued_packets),
+      m_skip_ahead((SkipAheadMode) p->skip_ahead),
+      m_next_injection(INJECTION_NEVER),
+      m_max_outstanding(p->max_outstanding),
+      m_service_cycles(p->service_cycles),
+      m_response_vnet(p->response_vnet),
+      m_next_req_id(0)
+{
+    if ((m_skip_ahead < NO_SKIP_) || (m_skip_ahead >= NUM_SKIP_AHEAD_MODES_))
+        fatal("%s: unknown skip_ahead mode %d\n", name(), m_skip_ahead);
+    if ((m_max_outstanding > 0) && (m_service_cycles < 1))
+        fatal("%s: service_cycles must be at least 1\n", name());
+
+    m_pattern_config.type = p->traffic_type;
+    m_pattern_config.num_dest = m_num_dest;
+    m_pattern_config.num_rows = p->num_rows;
+    m_pattern_config.hotspot_nodes = p->hotspot_nodes;
+    m_pattern_config.hotspot_fraction = p->hotspot_fraction;
+    m_pattern_config.permutation_file = p->permutation_file;
+    m_pattern_config.rate_matrix_file = p->rate_matrix_file;
+}
+
+GarnetTrafficSource::~GarnetTrafficSource()
+{
+    delete m_pattern;
+    delete m_injection;
+}
+
+void
+GarnetTrafficSource::startup()
+{
+    if (m_ni == NULL)
+        fatal("%s is not the traffic_source of a network interface\n",
+              name());
+
+    m_net_ptr = m_ni->get_net_ptr();
+    // same stream as a tester with this id
+    m_rng = m_net_ptr->get_rng_stream(TRAFFIC_RNG_, m_ni->get_id());
+
+    if ((m_dest_base < 0) ||
+        (m_dest_base + m_num_dest > m_net_ptr->getNumNodes())) {
+        fatal("%s: destinations %d..%d are not network interfaces\n",
+              name(), m_dest_base, m_dest_base + m_num_dest - 1);
+    }
+    if (m_inj_vnet >= (int) m_net_ptr->getNumberOfVirtualNetworks()) {
+        fatal("%s: no vnet %d in the network\n", name(), m_inj_vnet);
+    }
+
+    if (m_max_outstanding > 0) {
+        int num_vnets = m_net_ptr->getNumberOfVirtualNetworks();
+        if (m_response_vnet < 0) {
+            // the first data vnet, as for protocol responses
+            m_response_vnet = num_vnets - 1;
+            for (int vnet = 0; vnet < num_vnets; vnet++) {
+                int vc = vnet * m_net_ptr->getVCsPerVnet();
+                if (m_net_ptr->get_vnet_type(vc) == DATA_VNET_) {
+                    m_response_vnet = vnet;
+                    break;
+                }
+            }
+        }
+        if (m_response_vnet >= num_vnets) {
+            fatal("%s: no response vnet %d in the network\n", name(),
+                  m_response_vnet);
+        }
+    }
+
+    m_pattern = new TrafficPattern(m_pattern_config, m_ni->get_id());
+    if (m_pattern->source_rate() >= 0)
+        m_inj_rate = m_pattern->source_rate();
+    m_injection = new InjectionProcess(m_inj_rate, m_precision, m_skip_ahead,
+                                       m_burst_on_cycles, m_burst_off_cycles,
+                                       m_rng);
+
+    if (m_skip_ahead == NO_SKIP_) {
+        schedule(m_tick_event, clockEdge());
+        return;
+    }
+
+    // the first injection may be in this cycle
+    uint64_t gap = m_injection->gap(m_rng);
+    if (gap != INJECTION_NEVER) {
+        m_next_injection = curCycle() + gap - 1;
+        schedule(m_tick_event, clockEdge(Cycles(gap - 1)));
+    }
+}
+
+void
+GarnetTrafficSource::regStats()
+{
+    ClockedObject::regStats();
+
+    m_packets_throttled
+        .name(name() + ".packets_throttled");
+    m_window_full
+        .name(name() + ".window_full");
+    m_responses_received
+        .name(name() + ".responses_received");
+    m_round_trip_latency
+        .init(16)
+        .name(name() + ".round_trip_latency")
+        .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
+        ;
+    m_throughput
+        .name(name() + ".throughput");
+    m_throughput = m_responses_received * clockPeriod() / simTicks;
+}
+
+NetworkTraceRecord
+GarnetTrafficSource::make_response(int64_t req_id, int responder, Cycles now)
+{
+    NetworkTraceRecord record;
+    record.valid = true;
+    record.time = now + m_service_cycles;
+    record.src_id = responder;
+    record.src_router_id = m_net_ptr->get_router_id(responder);
+    record.dest_id = m_ni->get_id();
+    record.dest_router_id = m_ni->get_router_id();
+    record.vnet = m_response_vnet;
+    record.num_flits = packet_flits(m_response_vnet);
+    record.req_id = req_id;
+    record.is_response = true;
+    return record;
+}
+
+void
+GarnetTrafficSource::response_received(int64_t req_id)
+{
+    std::unordered_map<int64_t, Cycles>::iterator it =
+        m_outstanding.find(req_id);
+    assert(it != m_outstanding.end());
+
+    m_round_trip_latency.sample(curCycle() - it->second);
+    m_responses_received++;
+    m_outstanding.erase(it);
+}
+
+// flits of a control or data packet in 'vnet', as for a protocol
+// message of that size
+int
+GarnetTrafficSource::packet_flits(int vnet)
+{
+    int vc = vnet * m_net_ptr->getVCsPerVnet();
+    MessageSizeType size_type =
+        (m_net_ptr->get_vnet_type(vc) == DATA_VNET_) ?
+        MessageSizeType_Data : MessageSizeType_Control;
+    return (int) ceil((double) m_net_ptr->MessageSizeType_to_int(size_type) /
+                      m_net_ptr->getNiFlitSize());
+}
+
+void
+GarnetTrafficSource::tick()
+{
+    if ((m_num_packets_max >= 0) &&
+        (m_num_packets_sent >= m_num_packets_max)) {
+        return;
+    }
+
+    // same injection process as GarnetSyntheticTraffic::tick()
+    bool inject;
+    if (m_skip_ahead == NO_SKIP_)
+        inject = m_injection->trial(m_rng);
+    else
+        inject = (uint64_t(curCycle()) == m_next_injection);
+
+    if (inject) {
+        int src = m_ni->get_id();
+        int dest = (m_single_dest >= 0) ? m_single_dest :
+            m_pattern->destination(m_rng);
+
+        int vnet = m_inj_vnet;
+        if (vnet < 0) {
+            int num_vnets = m_net_ptr->getNumberOfVirtualNetworks();
+            vnet = m_rng.random(0, num_vnets - 1);
+        }
+
+        if ((m_max_outstanding > 0) &&
+            ((int) m_outstanding.size() >= m_max_outstanding)) {
+            m_window_full++;
+        } else if (m_ni->get_direct_queue_size() < m_max_queued_packets) {
+            NetworkTraceRecord record;
+            record.valid = true;
+            record.time = curCycle();
+            record.src_id = src;
+            record.src_router_id = m_ni->get_router_id();
+            record.dest_id = m_dest_base + dest;
+            record.dest_router_id =
+                m_net_ptr->get_router_id(record.dest_id);
+            record.vnet = vnet;
+            record.num_flits = packet_flits(vnet);
+            if (m_max_outstanding > 0) {
+                record.req_id = m_next_req_id++;
+                m_outstanding[record.req_id] = curCycle();
+            }
+            m_ni->enqueueDirectPacket(record);
+            m_num_packets_sent++;
+        } else {
+            m_packets_throttled++;
+        }
+    }
+
+    if (m_skip_ahead == NO_SKIP_) {
+        schedule(m_tick_event, clockEdge(Cycles(1)));
+        return;
+    }
+
+    uint64_t gap = m_injection->gap(m_rng);
+    if (gap != INJECTION_NEVER) {
+        m_next_injection += gap;
+        schedule(m_tick_event,
+                 clockEdge(Cycles(m_next_injection - curCycle())));
+    }
+}
+
+GarnetTrafficSource *
+GarnetTrafficSourceParams::create()
+{
+    return new GarnetTrafficSource(this);
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_GARNETTRAFFICSOURCE_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_GARNETTRAFFICSOURCE_HH__
+
+#include <unordered_map>
+
+#include "base/statistics.hh"
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "mem/ruby/network/garnet2.0/NetworkTraceReader.hh"
+#include "mem/ruby/network/garnet2.0/TrafficPattern.hh"
+#include "params/GarnetTrafficSource.hh"
+#include "sim/clocked_object.hh"
+
+class GarnetNetwork;
+class NetworkInterface;
+
+// Synthetic traffic generated right at a network interface, as direct
+// packets (no protocol message): no tester, sequencer or controller is
+// involved per packet, for network-only studies. Injection follows
+// the GarnetSyntheticTraffic tester (same patterns and random stream).
+class GarnetTrafficSource : public ClockedObject
+{
+  public:
+    typedef GarnetTrafficSourceParams Params;
+    GarnetTrafficSource(const Params *p);
+    ~GarnetTrafficSource();
+
+    void startup();
+    void regStats();
+
+    void set_ni(NetworkInterface *ni) { m_ni = ni; }
+
+    // one cycle of the source
+    void tick();
+
+    // Closed loop: the response to request 'req_id' of this source,
+    // sent by NI 'responder' once serviced (from cycle 'now')
+    NetworkTraceRecord make_response(int64_t req_id, int responder,
+                                     Cycles now);
+    void response_received(int64_t req_id);
+
+  private:
+    int packet_flits(int vnet);
+
+    EventFunctionWrapper m_tick_event;
+    NetworkInterface *m_ni;
+    GarnetNetwork *m_net_ptr;
+    CounterRNG m_rng;
+
+    TrafficPatternConfig m_pattern_config;
+    TrafficPattern *m_pattern;
+    InjectionProcess *m_injection;
+    double m_inj_rate;
+    double m_burst_on_cycles;
+    double m_burst_off_cycles;
+    int m_inj_vnet;
+    int m_precision;
+    int m_num_dest;
+    int m_dest_base;
+    int m_single_dest;
+    int m_num_packets_max;
+    int m_num_packets_sent;
+    int m_max_queued_packets;
+    SkipAheadMode m_skip_ahead;
+    // cycle of the next injection when skipping ahead
+    uint64_t m_next_injection;
+
+    // Closed loop (m_max_outstanding > 0): every packet is a request
+    // answered on m_response_vnet after m_service_cycles at its
+    // destination, and at most m_max_outstanding requests are in
+    // flight, as with the MSHRs of a cache.
+    int m_max_outstanding;
+    Cycles m_service_cycles;
+    int m_response_vnet;
+    int64_t m_next_req_id;
+    // issue cycle of the outstanding requests
+    std::unordered_map<int64_t, Cycles> m_outstanding;
+
+    // packets not generated as the NI queue was full
+    Stats::Scalar m_packets_throttled;
+    // ... as the window of outstanding requests was full
+    Stats::Scalar m_window_full;
+    Stats::Scalar m_responses_received;
+    Stats::Histogram m_round_trip_latency;
+    // completed requests per cycle
+    Stats::Formula m_throughput;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_GARNETTRAFFICSOURCE_HH__
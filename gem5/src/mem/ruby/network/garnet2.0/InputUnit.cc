@@ -59,10 +59,13 @@ InputUnit::InputUnit(int id, PortDirection direction, Router *router)
 
     creditQueue = new flitBuffer();
     // Instantiating the virtual channels
+    m_vc_store = m_router->get_net_ptr()->get_vc_store();
     m_vcs.resize(m_num_vcs);
     for (int i=0; i < m_num_vcs; i++) {
-        m_vcs[i] = new VirtualChannel(i);
+        m_vcs[i] = new VirtualChannel(i, m_vc_store);
     }
+    m_vc_base = m_vcs[0]->get_index();
+    assert(m_vcs[m_num_vcs - 1]->get_index() == m_vc_base + m_num_vcs - 1);
 }
 
 InputUnit::~InputUnit()
@@ -84,71 +87,126 @@ InputUnit::~InputUnit()
 void
 InputUnit::wakeup()
 {
-    flit *t_flit;
-    if (m_in_link->isReady(m_router->curCycle())) {
-
-        t_flit = m_in_link->consumeLink();
-        int vc = t_flit->get_vc();
-        t_flit->increment_hops(); // for stats
-        #if (DEBUG_PRINT)
-            cout << "InputUnit::wakeup()--- m_id: " << m_id << endl;
-            cout << "InputUnit::wakeup()--- direction: " << m_direction << endl;
-            cout << "InputUnit::wakeup()--- t_flit->get_vc():  " << vc << endl;
-        #endif
-
-        if ((t_flit->get_type() == HEAD_) ||
-            (t_flit->get_type() == HEAD_TAIL_)) {
-
-            assert(m_vcs[vc]->get_state() == IDLE_);
-            set_vc_active(vc, m_router->curCycle());
-
-            // Route computation for this vc
-            int outport = m_router->route_compute(t_flit->get_route(),
-                m_id, m_direction);
-            // you have computed the outport of this flit.. put it
-            // the flit as well
-            t_flit->set_outport(outport);
-            // set the outport_dir as well
-            PortDirection outdir;
-            outdir =
-                m_router->getOutportDirection(outport); // this sounds right!
-            t_flit->set_outport_dir(outdir);
-
-            // Update output port in VC
-            // All flits in this packet will use this output port
-            // The output port field in the flit is updated after it wins SA
-            // grant_outport(vc, outport);
-
-        } else {
-            assert(m_vcs[vc]->get_state() == ACTIVE_);
-        }
-
+    // a wide link delivers several flits per cycle
+    while (m_in_link->isReady(m_router->curCycle())) {
+        flit *t_flit = m_in_link->consumeLink();
+        t_flit->m_smart_hops = 1;
+        accept_flit(t_flit);
+    }
+}
 
-        // Buffer the flit
-        m_vcs[vc]->insertFlit(t_flit);
+// Take in a flit arriving on the input link, or on a SMART path
+// which bypassed the upstream routers this cycle.
+void
+InputUnit::accept_flit(flit *t_flit)
+{
+    int vc = t_flit->get_vc();
+    t_flit->increment_hops(); // for stats
+    #if (DEBUG_PRINT)
+        cout << "InputUnit::wakeup()--- m_id: " << m_id << endl;
+        cout << "InputUnit::wakeup()--- direction: " << m_direction << endl;
+        cout << "InputUnit::wakeup()--- t_flit->get_vc():  " << vc << endl;
+    #endif
+
+    // SMART: go on to the next router if this one grants bypass
+    int smart_outport = -1;
+    if ((m_router->get_net_ptr()->getSmartHpcMax() > 1) &&
+        m_router->smart_bypass(m_id, t_flit, smart_outport)) {
+        return;
+    }
 
-        int vnet = vc/m_vc_per_vnet;
-        // number of writes same as reads
-        // any flit that is written will be read only once
-        m_num_buffer_writes[vnet]++;
-        m_num_buffer_reads[vnet]++;
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    Cycles pipe_stages = m_router->get_pipe_stages();
+    // bypass: a flit reaching an empty router goes for SA on
+    // arrival; if it does not win it takes the normal pipeline
+    // (see SwitchAllocator::wakeup())
+    if (net_ptr->isRouterBypassEnabled() && (pipe_stages > 1) &&
+        m_router->is_empty()) {
+        t_flit->m_bypass = true;
+    }
 
-        Cycles pipe_stages = m_router->get_pipe_stages();
-        if (pipe_stages == 1) {
-            // 1-cycle router
-            // Flit goes for SA directly
-            t_flit->advance_stage(SA_, m_router->curCycle());
+    if (net_ptr->isDeflectionEnabled()) {
+        // bufferless: the outport of every flit is picked when it
+        // leaves (SwitchAllocator::arbitrate_deflection()); only
+        // the vcs of the injection ports are allocated, those of
+        // the network inports merely hold the arriving flits
+        if (m_direction != "Local") {
+            set_vc_active(vc, m_router->curCycle());
+        } else if ((t_flit->get_type() == HEAD_) ||
+                   (t_flit->get_type() == HEAD_TAIL_)) {
+            assert(get_vc_state(vc) == IDLE_);
+            set_vc_active(vc, m_router->curCycle());
+        }
+    } else if ((t_flit->get_type() == HEAD_) ||
+        (t_flit->get_type() == HEAD_TAIL_)) {
+
+        assert(get_vc_state(vc) == IDLE_);
+        set_vc_active(vc, m_router->curCycle());
+
+        // Route computation for this vc, unless the upstream
+        // router did it (lookahead routing), which saves a stage
+        int outport = t_flit->get_lookahead_outport(m_router->get_id(),
+                                                    m_id);
+        if (outport != -1) {
+            net_ptr->m_lookahead_routes++;
+            t_flit->set_lookahead(-1, -1, -1);
+            if (pipe_stages > 1)
+                pipe_stages = pipe_stages - Cycles(1);
+        } else if (smart_outport != -1) {
+            // computed already for a SMART bypass; adaptive routing
+            // may not pick the same outport twice
+            outport = smart_outport;
         } else {
-            assert(pipe_stages > 1);
-            // Router delay is modeled by making flit wait in buffer for
-            // (pipe_stages cycles - 1) cycles before going for SA
+            outport = m_router->route_compute(t_flit->get_route(),
+                m_id, m_direction);
+        }
+        // you have computed the outport of this flit.. put it
+        // the flit as well
+        t_flit->set_outport(outport);
+        // set the outport_dir as well
+        PortDirection outdir;
+        outdir =
+            m_router->getOutportDirection(outport); // this sounds right!
+        t_flit->set_outport_dir(outdir);
+
+        // Update output port in VC
+        // All flits in this packet will use this output port
+        // The output port field in the flit is updated after it wins SA
+        // grant_outport(vc, outport);
+
+    } else {
+        assert(get_vc_state(vc) == ACTIVE_);
+    }
 
-            Cycles wait_time = pipe_stages - Cycles(1);
-            t_flit->advance_stage(SA_, m_router->curCycle() + wait_time);
 
-            // Wakeup the router in that cycle to perform SA
-            m_router->schedule_wakeup(Cycles(wait_time));
-        }
+    // Buffer the flit
+    insert_flit(vc, t_flit);
+
+    int vnet = vc/m_vc_per_vnet;
+    // number of writes same as reads
+    // any flit that is written will be read only once
+    m_num_buffer_writes[vnet]++;
+    m_num_buffer_reads[vnet]++;
+
+    if (t_flit->m_bypass)
+        pipe_stages = Cycles(1);
+    if (pipe_stages == 1) {
+        // 1-cycle router
+        // Flit goes for SA directly
+        t_flit->advance_stage(SA_, m_router->curCycle());
+        // this router may have done its SA already this cycle
+        if (t_flit->m_smart_hops > 1)
+            m_router->schedule_wakeup(Cycles(1));
+    } else {
+        assert(pipe_stages > 1);
+        // Router delay is modeled by making flit wait in buffer for
+        // (pipe_stages cycles - 1) cycles before going for SA
+
+        Cycles wait_time = pipe_stages - Cycles(1);
+        t_flit->advance_stage(SA_, m_router->curCycle() + wait_time);
+
+        // Wakeup the router in that cycle to perform SA
+        m_router->schedule_wakeup(Cycles(wait_time));
     }
 }
 
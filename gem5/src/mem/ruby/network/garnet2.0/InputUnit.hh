@@ -52,6 +52,7 @@ class InputUnit : public Consumer
     ~InputUnit();
 
     void wakeup();
+    void accept_flit(flit *t_flit);
     inline Router *
     get_router(void) {
         return m_router;
@@ -64,43 +65,43 @@ class InputUnit : public Consumer
     inline void
     set_vc_idle(int vc, Cycles curTime)
     {
-        m_vcs[vc]->set_idle(curTime);
+        m_vc_store->set_idle(m_vc_base + vc, curTime);
     }
 
     inline void
     set_vc_active(int vc, Cycles curTime)
     {
-        m_vcs[vc]->set_active(curTime);
+        m_vc_store->set_active(m_vc_base + vc, curTime);
     }
 
     inline void
     grant_outport(int vc, int outport)
     {
-        m_vcs[vc]->set_outport(outport);
+        m_vc_store->set_outport(m_vc_base + vc, outport);
     }
 
     inline void
     grant_outvc(int vc, int outvc)
     {
-        m_vcs[vc]->set_outvc(outvc);
+        m_vc_store->set_outvc(m_vc_base + vc, outvc);
     }
 
     inline int
     get_outport(int invc)
     {
-        return m_vcs[invc]->get_outport();
+        return m_vc_store->get_outport(m_vc_base + invc);
     }
 
     inline int
     get_outvc(int invc)
     {
-        return m_vcs[invc]->get_outvc();
+        return m_vc_store->get_outvc(m_vc_base + invc);
     }
 
     inline Cycles
     get_enqueue_time(int invc)
     {
-        return m_vcs[invc]->get_enqueue_time();
+        return m_vc_store->get_enqueue_time(m_vc_base + invc);
     }
 
     void increment_credit(int in_vc, bool free_signal, Cycles curTime);
@@ -108,25 +109,25 @@ class InputUnit : public Consumer
     inline flit*
     peekTopFlit(int vc)
     {
-        return m_vcs[vc]->peekTopFlit();
+        return m_vc_store->peek_top_flit(m_vc_base + vc);
     }
 
     inline flit*
     getTopFlit(int vc)
     {
-        return m_vcs[vc]->getTopFlit();
+        return m_vc_store->get_top_flit(m_vc_base + vc);
     }
 
     inline bool
     need_stage(int vc, flit_stage stage, Cycles time)
     {
-        return m_vcs[vc]->need_stage(stage, time);
+        return m_vc_store->need_stage(m_vc_base + vc, stage, time);
     }
 
     inline bool
     isReady(int invc, Cycles curTime)
     {
-        return m_vcs[invc]->isReady(curTime);
+        return m_vc_store->is_ready(m_vc_base + invc, curTime);
     }
 
     flitBuffer* getCreditQueue() { return creditQueue; }
@@ -138,6 +139,7 @@ class InputUnit : public Consumer
     }
 
     inline int get_inlink_id() { return m_in_link->get_id(); }
+    NetworkLink* get_in_link() { return m_in_link; }
 
     inline void
     set_credit_link(CreditLink *credit_link)
@@ -145,10 +147,36 @@ class InputUnit : public Consumer
         m_credit_link = credit_link;
     }
 
+    inline VC_state_type
+    get_vc_state(int invc)
+    {
+        return m_vc_store->get_state(m_vc_base + invc);
+    }
+
+    inline void
+    insert_flit(int invc, flit *t_flit)
+    {
+        m_vc_store->insert_flit(m_vc_base + invc, t_flit);
+    }
+
     inline bool
     vc_isEmpty(int invc)
     {
-        return m_vcs[invc]->isEmpty();
+        return m_vc_store->is_empty(m_vc_base + invc);
+    }
+
+    // true if 'invc' buffers every flit of its packet, i.e., the
+    // packet can be moved as a whole by a drain
+    inline bool
+    vc_has_whole_packet(int invc)
+    {
+        int vc = m_vc_base + invc;
+        if (m_vc_store->is_empty(vc))
+            return false;
+        flit *t_flit = m_vc_store->peek_top_flit(vc);
+        return (((t_flit->get_type() == HEAD_) ||
+                 (t_flit->get_type() == HEAD_TAIL_)) &&
+                (m_vc_store->get_size(vc) == t_flit->get_size()));
     }
 
     inline int
@@ -157,7 +185,7 @@ class InputUnit : public Consumer
         assert(dirn_ == m_direction);
         int freeVC = 0;
         for (int vc_=0; vc_ < m_vc_per_vnet; ++vc_) {
-             if(m_vcs[vc_]->isEmpty() == true)
+             if(m_vc_store->is_empty(m_vc_base + vc_) == true)
                 freeVC++;
         }
         return freeVC;
@@ -172,7 +200,9 @@ class InputUnit : public Consumer
     uint32_t functionalWrite(Packet *pkt);
     void resetStats();
 
-    // Input Virtual channels
+    // Input Virtual channels: views of the entries [m_vc_base,
+    // m_vc_base + m_num_vcs) of the vc store of the network, which
+    // the functions above access directly
     std::vector<VirtualChannel *> m_vcs;
 
   private:
@@ -180,6 +210,8 @@ class InputUnit : public Consumer
     PortDirection m_direction;
     int m_num_vcs;
     int m_vc_per_vnet;
+    VcStateStore *m_vc_store;
+    int m_vc_base;
 
     Router *m_router;
     NetworkLink *m_in_link;
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/NetworkEnergyModel.hh"
+
+#include <fstream>
+#include <sstream>
+
+#include "base/callback.hh"
+#include "base/logging.hh"
+#include "base/statistics.hh"
+#include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet2.0/Router.hh"
+#include "sim/core.hh"
+
+NetworkEnergyModel::NetworkEnergyModel(GarnetNetwork *net_ptr,
+                                       const std::string& tech_file,
+                                       const std::string& out_file)
+    : m_net_ptr(net_ptr), m_buffer_read(0), m_buffer_write(0),
+      m_crossbar(0), m_sw_arbiter(0), m_link(0), m_drain_move(0),
+      m_router_leakage(0), m_last_sample(0), m_epoch(0),
+      m_total_dynamic(0), m_total_leakage(0), m_total_drain(0)
+{
+    read_tech_file(tech_file);
+
+    m_last.resize(m_net_ptr->getNumRouters());
+    for (int i = 0; i < m_last.size(); i++)
+        m_last[i] = m_net_ptr->m_routers[i]->get_activity();
+    m_last_sample = m_net_ptr->curCycle();
+    Stats::registerResetCallback(
+        new MakeCallback<NetworkEnergyModel, &NetworkEnergyModel::reset>(
+            this));
+
+    m_out = simout.create(out_file);
+    *m_out->stream() << "# epoch cycle router dynamic(pJ) leakage(pJ) "
+                     << "drain(pJ)" << std::endl;
+}
+
+NetworkEnergyModel::~NetworkEnergyModel()
+{
+    simout.close(m_out);
+}
+
+void
+NetworkEnergyModel::read_tech_file(const std::string& filename)
+{
+    std::ifstream in(filename.c_str());
+    if (!in.good())
+        fatal("Could not open energy technology file %s\n", filename);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string event;
+        double energy;
+        if (!(tokens >> event))
+            continue;
+        if (!(tokens >> energy))
+            fatal("%s: no energy for '%s'\n", filename, event);
+
+        if (event == "buffer_read")
+            m_buffer_read = energy;
+        else if (event == "buffer_write")
+            m_buffer_write = energy;
+        else if (event == "crossbar")
+            m_crossbar = energy;
+        else if (event == "sw_arbiter")
+            m_sw_arbiter = energy;
+        else if (event == "link")
+            m_link = energy;
+        else if (event == "drain_move")
+            m_drain_move = energy;
+        else if (event == "router_leakage")
+            m_router_leakage = energy;
+        else
+            fatal("%s: unknown event '%s'\n", filename, event);
+    }
+}
+
+// Stats reset: the routers have cleared their activity counters
+// already (SimObject resetStats() comes before the reset callbacks).
+// The energy so far, and the activity since the last sample, belong
+// to the stats being reset.
+void
+NetworkEnergyModel::reset()
+{
+    for (int i = 0; i < m_last.size(); i++)
+        m_last[i] = m_net_ptr->m_routers[i]->get_activity();
+    m_last_sample = m_net_ptr->curCycle();
+    m_total_dynamic = 0;
+    m_total_leakage = 0;
+    m_total_drain = 0;
+}
+
+void
+NetworkEnergyModel::sample()
+{
+    Cycles now = m_net_ptr->curCycle();
+    if (now <= m_last_sample)
+        return;
+
+    // mW over the epoch, in pJ
+    double seconds = double(m_net_ptr->cyclesToTicks(now - m_last_sample))
+        / SimClock::Frequency;
+    double leakage = m_router_leakage * seconds * 1e9;
+
+    std::ostream& out = *m_out->stream();
+    for (int i = 0; i < m_last.size(); i++) {
+        RouterActivity activity = m_net_ptr->m_routers[i]->get_activity();
+        RouterActivity& last = m_last[i];
+
+        double drain = m_drain_move *
+            (activity.drain - last.drain);
+        double dynamic = drain +
+            m_buffer_read *
+                (activity.buffer_reads - last.buffer_reads) +
+            m_buffer_write *
+                (activity.buffer_writes - last.buffer_writes) +
+            m_crossbar * (activity.crossbar - last.crossbar) +
+            m_sw_arbiter *
+                (activity.sw_arbiter - last.sw_arbiter) +
+            m_link * (activity.link - last.link);
+
+        out << m_epoch << " " << now << " " << i << " " << dynamic << " "
+            << leakage << " " << drain << std::endl;
+
+        m_total_dynamic += dynamic;
+        m_total_leakage += leakage;
+        m_total_drain += drain;
+        last = activity;
+    }
+
+    m_last_sample = now;
+    m_epoch++;
+}
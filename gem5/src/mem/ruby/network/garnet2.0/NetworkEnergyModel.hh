@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_NETWORKENERGYMODEL_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_NETWORKENERGYMODEL_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/types.hh"
+
+class GarnetNetwork;
+
+// Activity of a router since the start of the simulation (or the
+// last stats reset): flits written to and read from its input
+// buffers, crossing its crossbar, arbitrations of its switch
+// allocator, flits sent on its links (its outlinks, and the inlinks
+// from its NIs) and flits a DRAIN spin moved into its buffers.
+struct RouterActivity
+{
+    double buffer_reads;
+    double buffer_writes;
+    double crossbar;
+    double sw_arbiter;
+    double link;
+    double drain;
+};
+
+// Runtime energy of the network: the activity of each router is
+// sampled every epoch and weighted by per-event energies (pJ) read
+// from a technology file, with lines of the form
+//     <event> <energy>
+// where <event> is one of buffer_read, buffer_write, crossbar,
+// sw_arbiter, link, drain_move (pJ per event) or router_leakage
+// (mW per router); '#' starts a comment.
+// The dynamic and leakage energy of each router in every epoch is
+// written to an output file of the simulation.
+class NetworkEnergyModel
+{
+  public:
+    NetworkEnergyModel(GarnetNetwork *net_ptr,
+                       const std::string& tech_file,
+                       const std::string& out_file);
+    ~NetworkEnergyModel();
+
+    // account the activity since the last sample as one epoch
+    void sample();
+    // stats reset callback
+    void reset();
+
+    // totals over all the epochs so far (pJ)
+    double get_dynamic_energy() const { return m_total_dynamic; }
+    double get_leakage_energy() const { return m_total_leakage; }
+    double get_drain_energy() const { return m_total_drain; }
+
+  private:
+    void read_tech_file(const std::string& filename);
+
+    GarnetNetwork *m_net_ptr;
+
+    // per-event energies (pJ), and leakage power of a router (mW)
+    double m_buffer_read, m_buffer_write, m_crossbar, m_sw_arbiter;
+    double m_link, m_drain_move;
+    double m_router_leakage;
+
+    // activity of each router at the last sample
+    std::vector<RouterActivity> m_last;
+    Cycles m_last_sample;
+    int m_epoch;
+
+    double m_total_dynamic, m_total_leakage, m_total_drain;
+
+    OutputStream *m_out;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_NETWORKENERGYMODEL_HH__
@@ -41,6 +41,7 @@
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/GarnetTrafficSource.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -52,7 +53,8 @@ NetworkInterface::NetworkInterface(const Params *p)
       m_virtual_networks(p->virt_nets), m_vc_per_vnet(p->vcs_per_vnet),
       m_num_vcs(m_vc_per_vnet * m_virtual_networks),
       m_deadlock_threshold(p->garnet_deadlock_threshold),
-      vc_busy_counter(m_virtual_networks, 0)
+      vc_busy_counter(m_virtual_networks, 0),
+      m_flit_stats(m_virtual_networks)
 {
     m_router_id = -1;
     m_vc_round_robin = 0;
@@ -71,7 +73,20 @@ NetworkInterface::NetworkInterface(const Params *p)
         m_vc_allocator[i] = 0;
     }
 
-    m_stall_count.resize(m_virtual_networks);
+    m_stall_queue.resize(m_virtual_networks);
+    m_stall_seq = 0;
+    m_credit_pool = nullptr;
+    m_packet_seq = 0;
+    m_unstall_pending.resize(m_virtual_networks, false);
+    m_direct_queues.resize(m_virtual_networks);
+    m_num_direct_packets = 0;
+    m_response_queues.resize(m_virtual_networks);
+    m_num_responses = 0;
+    m_service_queue_depth = p->service_queue_depth;
+
+    m_traffic_source = p->traffic_source;
+    if (m_traffic_source != NULL)
+        m_traffic_source->set_ni(this);
 }
 
 void
@@ -80,11 +95,22 @@ NetworkInterface::init()
     for (int i = 0; i < m_num_vcs; i++) {
         m_out_vc_state.push_back(new OutVcState(i, m_net_ptr));
     }
+    if (m_net_ptr->isSharedInputBuffers()) {
+        m_credit_pool = new SharedCreditPool(m_num_vcs,
+            m_net_ptr->getDamqBuffersPerPort(),
+            m_net_ptr->getDamqReservedPerVC());
+    }
+
+    // both end the run by counting the flits without a message
+    if ((m_traffic_source != NULL) && m_net_ptr->isTraceEnabled())
+        fatal("NI %d: a traffic source can't be used with trace replay\n",
+              m_id);
 }
 
 NetworkInterface::~NetworkInterface()
 {
     deletePointers(m_out_vc_state);
+    delete m_credit_pool;
     deletePointers(m_ni_out_vcs);
     delete outCreditQueue;
     delete outFlitQueue;
@@ -130,83 +156,100 @@ NetworkInterface::addNode(vector<MessageBuffer *>& in,
 }
 
 void
-NetworkInterface::dequeueCallback()
+NetworkInterface::dequeueCallback(int vnet)
 {
     // An output MessageBuffer has dequeued something this cycle and there
     // is now space to enqueue a stalled message. However, we cannot wake
     // on the same cycle as the dequeue. Schedule a wake at the soonest
     // possible time (next cycle).
+    markUnstallPending(vnet);
     scheduleEventAbsolute(clockEdge(Cycles(1)));
 }
 
+void
+NetworkInterface::markUnstallPending(int vnet)
+{
+    if (!m_unstall_pending[vnet]) {
+        m_unstall_pending[vnet] = true;
+        m_unstall_pending_vnets.push_back(vnet);
+    }
+}
+
+// Unmarked flits are counted in m_flit_stats, added to the stats of
+// the network when they are collated or reset (see flushStats()).
+// Marked flits end the simulation once they are all received (see
+// GarnetNetwork::increment_received_flits()): they are counted right
+// away.
 void
 NetworkInterface::incrementStats(flit *t_flit)
 {
+    assert((m_net_ptr->sim_type == 1) || (m_net_ptr->sim_type == 2));
     int vnet = t_flit->get_vnet();
-    if(m_net_ptr->sim_type == 2) {
-
-        // Latency
-        m_net_ptr->increment_received_flits(vnet, t_flit->m_marked);
-        Cycles network_delay =
-            t_flit->get_dequeue_time() - t_flit->get_enqueue_time() - Cycles(1);
-        Cycles src_queueing_delay = t_flit->get_src_delay();
-        Cycles dest_queueing_delay = (curCycle() - t_flit->get_dequeue_time());
-        Cycles queueing_delay = src_queueing_delay + dest_queueing_delay;
-        Cycles total_delay = queueing_delay + network_delay;
-
-        m_net_ptr->increment_flit_network_latency(network_delay, vnet, t_flit->m_marked);
-        m_net_ptr->increment_flit_queueing_latency(queueing_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_flit_latency_histogram(total_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_flit_network_latency_histogram(network_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_flit_queueing_latency_histogram(queueing_delay, vnet, t_flit->m_marked);
+    bool marked = t_flit->m_marked;
+    bool is_tail = (t_flit->get_type() == TAIL_ ||
+                    t_flit->get_type() == HEAD_TAIL_);
+
+    // Latency
+    Cycles network_delay =
+        t_flit->get_dequeue_time() - t_flit->get_enqueue_time() - Cycles(1);
+    Cycles src_queueing_delay = t_flit->get_src_delay();
+    Cycles dest_queueing_delay = (curCycle() - t_flit->get_dequeue_time());
+    Cycles queueing_delay = src_queueing_delay + dest_queueing_delay;
+    Cycles total_delay = queueing_delay + network_delay;
+    Cycles age = curCycle() - t_flit->get_enqueue_time();
+
+    if (!marked) {
+        m_flit_stats.sample(vnet, network_delay, queueing_delay, age,
+                            t_flit->get_route().hops_traversed,
+                            t_flit->get_drain_count(), is_tail);
+    } else {
+        m_net_ptr->update_max_flit_age(age);
+        m_net_ptr->update_flit_drain_count(t_flit->get_drain_count(),
+                                           is_tail);
+        m_net_ptr->increment_received_flits(vnet, marked);
+        m_net_ptr->increment_flit_network_latency(network_delay, vnet, marked);
+        m_net_ptr->increment_flit_queueing_latency(queueing_delay, vnet,
+                                                   marked);
+        m_net_ptr->update_flit_latency_histogram(total_delay, vnet, marked);
+        m_net_ptr->update_flit_network_latency_histogram(network_delay, vnet,
+                                                         marked);
+        m_net_ptr->update_flit_queueing_latency_histogram(queueing_delay,
+                                                          vnet, marked);
         m_net_ptr->update_network_latency_histogram(network_delay);
 
-        if(curCycle() > (Cycles)m_net_ptr->warmup_cycles) {
-            m_net_ptr->check_network_saturation();
-        }
-
-        if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
-            m_net_ptr->increment_received_packets(vnet, t_flit->m_marked);
+        if (is_tail) {
+            m_net_ptr->increment_received_packets(vnet, marked);
             m_net_ptr->increment_packet_network_latency(network_delay, vnet,
-                                                        t_flit->m_marked);
-            m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet,
-                                                        t_flit->m_marked);
+                                                        marked);
+            m_net_ptr->increment_packet_queueing_latency(queueing_delay,
+                                                         vnet, marked);
         }
 
         // Hops
-        m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed, t_flit->m_marked);
-
-    }else {
-        assert(m_net_ptr->sim_type == 1);
-        // Latency
-        m_net_ptr->increment_received_flits(vnet, t_flit->m_marked);
-        Cycles network_delay =
-            t_flit->get_dequeue_time() - t_flit->get_enqueue_time() - Cycles(1);
-        Cycles src_queueing_delay = t_flit->get_src_delay();
-        Cycles dest_queueing_delay = (curCycle() - t_flit->get_dequeue_time());
-        Cycles queueing_delay = src_queueing_delay + dest_queueing_delay;
-        Cycles total_delay = queueing_delay + network_delay;
-
-        m_net_ptr->increment_flit_network_latency(network_delay, vnet, t_flit->m_marked);
-        m_net_ptr->increment_flit_queueing_latency(queueing_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_flit_latency_histogram(total_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_flit_network_latency_histogram(network_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_flit_queueing_latency_histogram(queueing_delay, vnet, t_flit->m_marked);
-        m_net_ptr->update_network_latency_histogram(network_delay);
-
-        if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
-            m_net_ptr->increment_received_packets(vnet, t_flit->m_marked);
-            m_net_ptr->increment_packet_network_latency(network_delay, vnet,
-                                                        t_flit->m_marked);
-            m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet,
-                                                        t_flit->m_marked);
-        }
+        m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed,
+                                        marked);
+    }
 
-        // Hops
-        m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed, t_flit->m_marked);
+    if ((m_net_ptr->sim_type == 2) &&
+        (curCycle() > (Cycles)m_net_ptr->warmup_cycles)) {
+        m_net_ptr->check_network_saturation();
     }
 }
 
+void
+NetworkInterface::flushStats()
+{
+    m_net_ptr->merge_flit_stats(m_flit_stats);
+}
+
+// the flits counted so far belong to the stats being reset
+void
+NetworkInterface::resetStats()
+{
+    ClockedObject::resetStats();
+    flushStats();
+}
+
 /*
  * The NI wakeup checks whether there are any ready messages in the protocol
  * buffer. If yes, it picks that up, flitisizes it into a number of flits and
@@ -243,7 +286,46 @@ NetworkInterface::wakeup()
         }
     }
 
-    scheduleOutputLink();
+    // serviced closed-loop requests are answered in order
+    while (!m_pending_responses.empty() &&
+           (m_pending_responses.front().time <= curCycle())) {
+        const NetworkTraceRecord& response = m_pending_responses.front();
+        m_response_queues[response.vnet].push_back(response);
+        m_num_responses++;
+        m_pending_responses.pop_front();
+    }
+
+    // as for protocol messages, inject the oldest direct packet (trace
+    // replay or GarnetTrafficSource) of each vnet, and the oldest
+    // closed-loop response of each vnet
+    if (((m_num_direct_packets > 0) || (m_num_responses > 0)) &&
+        (m_net_ptr->lock == -1)) {
+        for (int vnet = 0; vnet < m_virtual_networks; vnet++) {
+            std::deque<NetworkTraceRecord>& responses =
+                m_response_queues[vnet];
+            if (!responses.empty() && injectDirectPacket(responses.front())) {
+                responses.pop_front();
+                m_num_responses--;
+            }
+            std::deque<NetworkTraceRecord>& queue = m_direct_queues[vnet];
+            if (!queue.empty() && injectDirectPacket(queue.front())) {
+                queue.pop_front();
+                m_num_direct_packets--;
+            }
+        }
+    }
+
+    // responses injected: serve the requests waiting for it
+    while (!m_stalled_requests.empty() && !serviceQueueFull()) {
+        ejectDirectFlit(m_stalled_requests.front());
+        m_stalled_requests.pop_front();
+    }
+
+    // a wide link takes several flits per cycle
+    for (int i = 0; i < outNetLink->getFlitsPerCycle(); i++) {
+        if (!scheduleOutputLink())
+            break;
+    }
     checkReschedule();
 
     // Check if there are flits stalling a virtual channel. Track if a
@@ -251,19 +333,48 @@ NetworkInterface::wakeup()
     bool messageEnqueuedThisCycle = checkStallQueue();
 
     /*********** Check the incoming flit link **********/
-    if (inNetLink->isReady(curCycle())) {
+    // (a wide link delivers several flits per cycle)
+    while (inNetLink->isReady(curCycle())) {
         flit *t_flit = inNetLink->consumeLink();
         int vnet = t_flit->get_vnet();
         t_flit->set_dequeue_time(curCycle());
+        // each flit of a packet takes its own vc (and path) under
+        // deflection routing, so every credit frees its vc
+        bool deflection = m_net_ptr->isDeflectionEnabled();
+        if (deflection)
+            reassembleFlit(t_flit);
 
         // If a tail flit is received, enqueue into the protocol buffers if
         // space is available. Otherwise, exchange non-tail flits for credits.
-        if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
+        if (t_flit->get_msg_ptr() == nullptr) {
+            // direct packet: there is no protocol message to deliver
+            bool is_tail = (t_flit->get_type() == TAIL_ ||
+                            t_flit->get_type() == HEAD_TAIL_);
+            if (is_tail && (t_flit->get_req_id() >= 0) &&
+                !t_flit->is_response() &&
+                (!m_stalled_requests.empty() || serviceQueueFull())) {
+                m_stalled_requests.push_back(t_flit);
+            } else {
+                ejectDirectFlit(t_flit);
+            }
+        } else if (t_flit->get_type() == TAIL_ ||
+                   t_flit->get_type() == HEAD_TAIL_) {
+            // the message of a multicast is shared by its branches;
+            // deliver a copy addressed to this NI only
+            if (t_flit->get_route().multicast) {
+                MsgPtr msg_ptr = t_flit->get_msg_ptr()->clone();
+                msg_ptr->getDestination() = t_flit->get_route().net_dest;
+                t_flit->get_msg_ptr() = msg_ptr;
+            }
+
+            // a new tail overtakes the stalled tails of its vnet if
+            // there is space by now
             if (!messageEnqueuedThisCycle &&
                 outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
                 // Space is available. Enqueue to protocol buffer.
                 outNode_ptr[vnet]->enqueue(t_flit->get_msg_ptr(), curTime,
                                            cyclesToTicks(Cycles(1)));
+                messageEnqueuedThisCycle = true;
 
                 // Simply send a credit back since we are not buffering
                 // this flit in the NI
@@ -277,28 +388,27 @@ NetworkInterface::wakeup()
                 // No space available- Place tail flit in stall queue and set
                 // up a callback for when protocol buffer is dequeued. Stat
                 // update and flit pointer deletion will occur upon unstall.
-                m_stall_queue.push_back(t_flit);
-                m_stall_count[vnet]++;
-
-                auto cb = std::bind(&NetworkInterface::dequeueCallback, this);
-                outNode_ptr[vnet]->registerDequeueCallback(cb);
+                stallFlit(t_flit);
             }
         } else {
             // Non-tail flit. Send back a credit but not VC free signal.
-            sendCredit(t_flit, false);
+            sendCredit(t_flit, deflection);
 
             // Update stats and delete flit pointer.
+            // The message itself is delivered with the tail flit.
             incrementStats(t_flit);
-            assert(0);
             delete t_flit;
         }
     }
 
     /****************** Check the incoming credit link *******/
 
-    if (inCreditLink->isReady(curCycle())) {
+    while (inCreditLink->isReady(curCycle())) {
         Credit *t_credit = (Credit*) inCreditLink->consumeLink();
-        m_out_vc_state[t_credit->get_vc()]->increment_credit();
+        if (m_credit_pool != nullptr)
+            m_credit_pool->increment_credit(t_credit->get_vc());
+        else
+            m_out_vc_state[t_credit->get_vc()]->increment_credit();
         if (t_credit->is_free_signal()) {
             m_out_vc_state[t_credit->get_vc()]->setState(IDLE_, curCycle());
         }
@@ -322,49 +432,83 @@ NetworkInterface::sendCredit(flit *t_flit, bool is_free)
     outCreditQueue->insert(credit_flit);
 }
 
+void
+NetworkInterface::stallFlit(flit *t_flit)
+{
+    int vnet = t_flit->get_vnet();
+    if (m_stall_queue[vnet].empty()) {
+        auto cb = std::bind(&NetworkInterface::dequeueCallback, this, vnet);
+        outNode_ptr[vnet]->registerDequeueCallback(cb);
+    }
+    m_stall_queue[vnet].push_back(std::make_pair(m_stall_seq++, t_flit));
+
+    // stalled behind another ejection this cycle while there is
+    // space: no dequeue will signal it
+    if (outNode_ptr[vnet]->areNSlotsAvailable(1, clockEdge())) {
+        markUnstallPending(vnet);
+        scheduleEvent(Cycles(1));
+    }
+}
+
+// Eject the oldest stalled flit whose vnet has space, checking only
+// the vnets with a dequeue since their last check
 bool
 NetworkInterface::checkStallQueue()
 {
-    bool messageEnqueuedThisCycle = false;
+    if (m_unstall_pending_vnets.empty())
+        return false;
+
     Tick curTime = clockEdge();
+    int unstall_vnet = -1;
+    for (int i = 0; i < m_unstall_pending_vnets.size(); ) {
+        int vnet = m_unstall_pending_vnets[i];
+        if (m_stall_queue[vnet].empty() ||
+            !outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
+            // wait for the next dequeue from this buffer
+            m_unstall_pending[vnet] = false;
+            m_unstall_pending_vnets[i] = m_unstall_pending_vnets.back();
+            m_unstall_pending_vnets.pop_back();
+            continue;
+        }
+        if ((unstall_vnet == -1) ||
+            (m_stall_queue[vnet].front().first <
+             m_stall_queue[unstall_vnet].front().first)) {
+            unstall_vnet = vnet;
+        }
+        i++;
+    }
 
-    if (!m_stall_queue.empty()) {
-        for (auto stallIter = m_stall_queue.begin();
-             stallIter != m_stall_queue.end(); ) {
-            flit *stallFlit = *stallIter;
-            int vnet = stallFlit->get_vnet();
+    if (unstall_vnet == -1)
+        return false;
 
-            // If we can now eject to the protocol buffer, send back credits
-            if (outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
-                outNode_ptr[vnet]->enqueue(stallFlit->get_msg_ptr(), curTime,
-                                           cyclesToTicks(Cycles(1)));
+    int vnet = unstall_vnet;
+    flit *stallFlit = m_stall_queue[vnet].front().second;
+    m_stall_queue[vnet].pop_front();
 
-                // Send back a credit with free signal now that the VC is no
-                // longer stalled.
-                sendCredit(stallFlit, true);
+    outNode_ptr[vnet]->enqueue(stallFlit->get_msg_ptr(), curTime,
+                               cyclesToTicks(Cycles(1)));
 
-                // Update Stats
-                incrementStats(stallFlit);
+    // Send back a credit with free signal now that the VC is no
+    // longer stalled.
+    sendCredit(stallFlit, true);
 
-                // Flit can now safely be deleted and removed from stall queue
-                delete stallFlit;
-                m_stall_queue.erase(stallIter);
-                m_stall_count[vnet]--;
+    // Update Stats
+    incrementStats(stallFlit);
 
-                // If there are no more stalled messages for this vnet, the
-                // callback on it's MessageBuffer is not needed.
-                if (m_stall_count[vnet] == 0)
-                    outNode_ptr[vnet]->unregisterDequeueCallback();
+    // Flit can now safely be deleted
+    delete stallFlit;
 
-                messageEnqueuedThisCycle = true;
-                break;
-            } else {
-                ++stallIter;
-            }
-        }
-    }
+    // If there are no more stalled messages for this vnet, the
+    // callback on it's MessageBuffer is not needed.
+    if (m_stall_queue[vnet].empty())
+        outNode_ptr[vnet]->unregisterDequeueCallback();
+
+    // one message per cycle: the other vnets (and this one, if
+    // there is more space) are checked next cycle
+    if (!m_unstall_pending_vnets.empty())
+        scheduleEvent(Cycles(1));
 
-    return messageEnqueuedThisCycle;
+    return true;
 }
 
 // Embed the protocol message into flits
@@ -381,9 +525,17 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
     // This is expressed in terms of bytes/cycle or the flit size
     int num_flits = (int) ceil((double) m_net_ptr->MessageSizeType_to_int(
         net_msg_ptr->getMessageSize())/m_net_ptr->getNiFlitSize());
-    num_flits = 1;
-    // loop to convert all multicast messages into unicast messages
-    for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
+    // a single-flit multicast goes out as one packet, replicated in the
+    // routers where the routes to its destinations diverge
+    bool multicast = (m_net_ptr->isMulticastEnabled() &&
+                      (dest_nodes.size() > 1) && (num_flits == 1));
+    int num_packets = multicast ? 1 : dest_nodes.size();
+    // a multicast is received once per destination: count it as
+    // injected once per destination too, so that the totals match
+    int copies = multicast ? dest_nodes.size() : 1;
+
+    // loop to convert all other multicast messages into unicast messages
+    for (int ctr = 0; ctr < num_packets; ctr++) {
 
         // this will return a free output virtual channel
         int vc;
@@ -405,7 +557,7 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         NodeID destID = dest_nodes[ctr];
 
         Message *new_net_msg_ptr = new_msg_ptr.get();
-        if (dest_nodes.size() > 1) {
+        if (!multicast && (dest_nodes.size() > 1)) {
             NetDest personal_dest;
             for (int m = 0; m < (int) MachineType_NUM; m++) {
                 if ((destID >= MachineType_base_number((MachineType) m)) &&
@@ -435,6 +587,12 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         route.src_router = m_router_id;
         route.dest_ni = destID;
         route.dest_router = m_net_ptr->get_router_id(destID);
+        if (multicast) {
+            route.multicast = true;
+            route.dest_ni = -1;
+            route.dest_router = -1;
+            m_net_ptr->m_multicast_pkts++;
+        }
 
         // initialize hops_traversed to -1
         // so that the first router increments it to 0
@@ -444,40 +602,188 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         // should not be changed afterwordsz
 
 
+        // all flits of a packet are either marked or not
+        bool marked = false;
+        if (m_net_ptr->sim_type == 2) {
+            // put condition here for each node to inject same number of
+            // marked packet using ceil() function
+             if((curCycle() > (Cycles)m_net_ptr->warmup_cycles) &&
+                // (m_net_ptr->marked_flt_injected < m_net_ptr->marked_flits) &&
+                (m_net_ptr->m_routers.at(m_router_id)->mrkd_flt_ > 0)) {
+                    marked = true;
+                    // mrkd_flt_ counts marked packets
+                    m_net_ptr->m_routers.at(m_router_id)->mrkd_flt_--;
+             }
+        }
+
         for (int i = 0; i < num_flits; i++) {
-            flit *fl;
-            if (m_net_ptr->sim_type == 2) {
-                // put condition here for each node to inject same number of
-                // marked packet using ceil() function
-                 if((curCycle() > (Cycles)m_net_ptr->warmup_cycles) &&
-                    // (m_net_ptr->marked_flt_injected < m_net_ptr->marked_flits) &&
-                    (m_net_ptr->m_routers.at(m_router_id)->mrkd_flt_ > 0)) {
-                        fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
-                                curCycle(), true);
-                        m_net_ptr->m_routers.at(m_router_id)->mrkd_flt_--;
-                 } else {
-                        fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
-                                      curCycle());
-                 }
-            } else {
-                fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
-                             curCycle());
+            flit *fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
+                                curCycle(), marked);
+            for (int copy = 0; copy < copies; copy++) {
+                m_net_ptr->increment_injected_flits(vnet, fl->m_marked,
+                                                    m_router_id);
             }
-            m_net_ptr->increment_injected_flits(vnet, fl->m_marked, m_router_id);
             fl->set_src_delay(curCycle() - ticksToCycles(msg_ptr->getTime()));
+            fl->m_packet_id = m_packet_seq;
             m_ni_out_vcs[vc]->insert(fl);
             if(fl->get_type() == HEAD_TAIL_ ||
                 fl->get_type() == TAIL_) {
-                m_net_ptr->increment_injected_packets(vnet, fl->m_marked);
+                for (int copy = 0; copy < copies; copy++) {
+                    m_net_ptr->increment_injected_packets(vnet,
+                                                          fl->m_marked);
+                }
             }
         }
 
+        m_packet_seq++;
         m_ni_out_vcs_enqueue_time[vc] = curCycle();
         m_out_vc_state[vc]->setState(ACTIVE_, curCycle());
     }
     return true ;
 }
 
+void
+NetworkInterface::enqueueDirectPacket(const NetworkTraceRecord& record)
+{
+    assert(record.src_id == m_id);
+    m_direct_queues[record.vnet].push_back(record);
+    m_num_direct_packets++;
+    scheduleEvent(Cycles(1));
+}
+
+// Deflection routing delivers the flits of a packet in any order:
+// retype them by arrival, so that the last flit to arrive is the
+// tail which completes the packet.
+void
+NetworkInterface::reassembleFlit(flit *t_flit)
+{
+    int size = t_flit->get_size();
+    if (size == 1)
+        return;
+
+    std::pair<int, uint64_t> key(t_flit->get_route().src_ni,
+                                 t_flit->get_packet_id());
+    int received = ++m_reassembly[key];
+    if (received == size) {
+        m_reassembly.erase(key);
+        t_flit->set_type(TAIL_);
+    } else {
+        t_flit->set_type((received == 1) ? HEAD_ : BODY_);
+    }
+}
+
+// Return the credit of a direct packet flit, which leaves the network
+void
+NetworkInterface::ejectDirectFlit(flit *t_flit)
+{
+    bool is_tail = (t_flit->get_type() == TAIL_ ||
+                    t_flit->get_type() == HEAD_TAIL_);
+    sendCredit(t_flit, is_tail || m_net_ptr->isDeflectionEnabled());
+    incrementStats(t_flit);
+    if (is_tail && (t_flit->get_req_id() >= 0))
+        receiveDirectPacket(t_flit);
+    delete t_flit;
+    m_net_ptr->increment_trace_flits_received();
+}
+
+bool
+NetworkInterface::serviceQueueFull()
+{
+    return (m_service_queue_depth > 0) &&
+        (m_pending_responses.size() + m_num_responses >=
+         m_service_queue_depth);
+}
+
+// Tail of a closed-loop packet: a request is answered after the
+// service time of its source, a response completes the request.
+void
+NetworkInterface::receiveDirectPacket(flit *t_flit)
+{
+    if (t_flit->is_response()) {
+        assert(m_traffic_source != NULL);
+        m_traffic_source->response_received(t_flit->get_req_id());
+        return;
+    }
+
+    RouteInfo route = t_flit->get_route();
+    GarnetTrafficSource *source =
+        m_net_ptr->get_ni(route.src_ni)->get_traffic_source();
+    assert(source != NULL);
+
+    NetworkTraceRecord response =
+        source->make_response(t_flit->get_req_id(), m_id, curCycle());
+    // the service time is the same for all requests of a source, but
+    // not across sources
+    std::deque<NetworkTraceRecord>::iterator it = m_pending_responses.end();
+    while ((it != m_pending_responses.begin()) &&
+           ((it - 1)->time > response.time)) {
+        it--;
+    }
+    m_pending_responses.insert(it, response);
+    scheduleEvent(Cycles(response.time - curCycle()));
+}
+
+// Make the flits of a direct packet (they carry no protocol message);
+// false if no vc of its vnet is free
+bool
+NetworkInterface::injectDirectPacket(const NetworkTraceRecord& record)
+{
+    int vnet = record.vnet;
+
+    int vc = calculateVC(vnet);
+    if (vc == -1)
+        return false;
+
+    NodeID destID = record.dest_id;
+    NetDest net_dest;
+    for (int m = 0; m < (int) MachineType_NUM; m++) {
+        if ((destID >= MachineType_base_number((MachineType) m)) &&
+            destID < MachineType_base_number((MachineType) (m+1))) {
+            net_dest.add((MachineID) {(MachineType) m, (destID -
+                MachineType_base_number((MachineType) m))});
+            break;
+        }
+    }
+
+    RouteInfo route;
+    route.vnet = vnet;
+    route.net_dest = net_dest;
+    route.src_ni = m_id;
+    route.src_router = m_router_id;
+    route.dest_ni = destID;
+    route.dest_router = record.dest_router_id;
+    route.hops_traversed = -1;
+
+    // same marking as for protocol messages
+    bool marked = false;
+    if ((m_net_ptr->sim_type == 2) &&
+        (curCycle() > (Cycles)m_net_ptr->warmup_cycles) &&
+        (m_net_ptr->m_routers.at(m_router_id)->mrkd_flt_ > 0)) {
+        marked = true;
+        m_net_ptr->m_routers.at(m_router_id)->mrkd_flt_--;
+    }
+
+    int num_flits = record.num_flits;
+    for (int i = 0; i < num_flits; i++) {
+        flit *fl = new flit(i, vc, vnet, route, num_flits, nullptr,
+                            curCycle(), marked);
+        m_net_ptr->increment_injected_flits(vnet, fl->m_marked, m_router_id);
+        // time spent in the direct queue counts as source queueing
+        fl->set_src_delay(curCycle() - record.time);
+        fl->m_req_id = record.req_id;
+        fl->m_is_resp = record.is_response;
+        fl->m_packet_id = m_packet_seq;
+        m_ni_out_vcs[vc]->insert(fl);
+        if (fl->get_type() == HEAD_TAIL_ || fl->get_type() == TAIL_)
+            m_net_ptr->increment_injected_packets(vnet, fl->m_marked);
+    }
+
+    m_packet_seq++;
+    m_ni_out_vcs_enqueue_time[vc] = curCycle();
+    m_out_vc_state[vc]->setState(ACTIVE_, curCycle());
+    return true;
+}
+
 // Looking for a free output vc
 int
 NetworkInterface::calculateVC(int vnet)
@@ -522,10 +828,11 @@ NetworkInterface::calculateVC(int vnet)
 /** This function looks at the NI buffers
  *  if some buffer has flits which are ready to traverse the link in the next
  *  cycle, and the downstream output vc associated with this flit has buffers
- *  left, the link is scheduled for the next cycle
+ *  left, the link is scheduled for the next cycle.
+ *  Returns false if no flit could be sent.
  */
 
-void
+bool
 NetworkInterface::scheduleOutputLink()
 {
     int vc = m_vc_round_robin;
@@ -539,8 +846,9 @@ NetworkInterface::scheduleOutputLink()
             vc = 0;
 
         // model buffer backpressure
-        if (m_ni_out_vcs[vc]->isReady(curCycle()) &&
-            m_out_vc_state[vc]->has_credit()) {
+        bool has_credit = (m_credit_pool != nullptr) ?
+            m_credit_pool->has_credit(vc) : m_out_vc_state[vc]->has_credit();
+        if (m_ni_out_vcs[vc]->isReady(curCycle()) && has_credit) {
 
             bool is_candidate_vc = true;
             int t_vnet = get_vnet(vc);
@@ -562,7 +870,10 @@ NetworkInterface::scheduleOutputLink()
             if (!is_candidate_vc)
                 continue;
 
-            m_out_vc_state[vc]->decrement_credit();
+            if (m_credit_pool != nullptr)
+                m_credit_pool->decrement_credit(vc);
+            else
+                m_out_vc_state[vc]->decrement_credit();
             // Just removing the flit
             flit *t_flit = m_ni_out_vcs[vc]->getTopFlit();
             t_flit->set_time(curCycle() + Cycles(1));
@@ -574,9 +885,10 @@ NetworkInterface::scheduleOutputLink()
                t_flit->get_type() == HEAD_TAIL_) {
                 m_ni_out_vcs_enqueue_time[vc] = Cycles(INFINITE_);
             }
-            return;
+            return true;
         }
     }
+    return false;
 }
 
 int
@@ -614,6 +926,11 @@ NetworkInterface::checkReschedule()
             return;
         }
     }
+
+    if ((m_num_direct_packets > 0) || (m_num_responses > 0)) {
+        scheduleEvent(Cycles(1));
+        return;
+    }
 }
 
 void
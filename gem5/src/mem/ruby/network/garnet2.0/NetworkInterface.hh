@@ -35,21 +35,26 @@
 #define __MEM_RUBY_NETWORK_GARNET2_0_NETWORKINTERFACE_HH__
 
 #include <iostream>
+#include <map>
 #include <vector>
 #include <queue>
 
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
+#include "mem/ruby/network/garnet2.0/FlitStatsAccumulator.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/NetworkTraceReader.hh"
 #include "mem/ruby/network/garnet2.0/OutVcState.hh"
+#include "mem/ruby/network/garnet2.0/SharedCreditPool.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/GarnetNetworkInterface.hh"
 
 class MessageBuffer;
 class flitBuffer;
 class GarnetNetwork;
+class GarnetTrafficSource;
 
 class NetworkInterface : public ClockedObject, public Consumer
 {
@@ -64,7 +69,7 @@ class NetworkInterface : public ClockedObject, public Consumer
     void addOutPort(NetworkLink *out_link, CreditLink *credit_link,
         SwitchID router_id);
 
-    void dequeueCallback();
+    void dequeueCallback(int vnet);
     void wakeup();
     void addNode(std::vector<MessageBuffer *> &inNode,
                  std::vector<MessageBuffer *> &outNode);
@@ -72,21 +77,31 @@ class NetworkInterface : public ClockedObject, public Consumer
     void print(std::ostream& out) const;
     int get_vnet(int vc);
     int get_router_id() { return m_router_id; }
+    int get_id() { return m_id; }
     void init_net_ptr(GarnetNetwork *net_ptr) { m_net_ptr = net_ptr; }
+    GarnetNetwork* get_net_ptr() { return m_net_ptr; }
 
     uint32_t functionalWrite(Packet *);
+    // add the stats of the flits ejected here to those of the network
+    void flushStats();
+    void resetStats() override;
 
     void schedule_wakeup() { scheduleEvent(Cycles(1)); }
-    void enqueueTracePacket(int src_ni, int src_router,
-        int dest_ni, int dest_router, int trace_vnet, int num_flits);
-    void injectTraceFlit(int vnet, int vc);
+    // packets injected without a protocol message (trace replay,
+    // GarnetTrafficSource), due for injection at this NI
+    void enqueueDirectPacket(const NetworkTraceRecord& record);
+    int get_direct_queue_size() { return m_num_direct_packets; }
+    GarnetTrafficSource* get_traffic_source() { return m_traffic_source; }
 
   private:
     GarnetNetwork *m_net_ptr;
+    GarnetTrafficSource *m_traffic_source;
     const NodeID m_id;
     const int m_virtual_networks, m_vc_per_vnet, m_num_vcs;
     int m_router_id; // id of my router
     std::vector<OutVcState *> m_out_vc_state;
+    // credits of the router inport when it shares its buffers
+    SharedCreditPool *m_credit_pool;
     std::vector<int> m_vc_allocator;
     int m_vc_round_robin; // For round robin scheduling
     flitBuffer *outFlitQueue; // For modeling link contention
@@ -98,16 +113,46 @@ class NetworkInterface : public ClockedObject, public Consumer
     CreditLink *inCreditLink;
     CreditLink *outCreditLink;
 
-    // Queue for stalled flits
-    std::deque<flit *> m_stall_queue;
-    std::vector<int> m_stall_count;
+    // Tail flits stalled as the protocol buffer of their vnet was
+    // full, per vnet in arrival order, with a sequence number to
+    // unstall the oldest first across vnets
+    std::vector<std::deque<std::pair<uint64_t, flit *> > > m_stall_queue;
+    uint64_t m_stall_seq;
+    // vnets whose protocol buffer may have space for a stalled flit
+    // (a dequeue since the last check); only these are checked
+    std::vector<int> m_unstall_pending_vnets;
+    std::vector<bool> m_unstall_pending;
+
+    // id of the next packet injected here
+    uint64_t m_packet_seq;
+    // deflection routing: flits received so far of the packets
+    // under reassembly, by (source NI, packet id)
+    std::map<std::pair<int, uint64_t>, int> m_reassembly;
 
     // Input Flit Buffers
     // The flit buffers which will serve the Consumer
     std::vector<flitBuffer *>  m_ni_out_vcs;
     std::vector<Cycles> m_ni_out_vcs_enqueue_time;
 
-    std::queue<flit *> m_trace_injection_queue;
+    // direct packets in cycle order, waiting for a free vc of their
+    // vnet; one queue per vnet, so that a vnet out of vcs does not hold
+    // back the others
+    std::vector<std::deque<NetworkTraceRecord>> m_direct_queues;
+    int m_num_direct_packets;
+    // responses to closed-loop requests, in service order; each is
+    // moved to the response queue of its vnet once its service time
+    // has elapsed. Responses never wait behind requests: a request
+    // waiting for a vc could otherwise block the response that frees
+    // one.
+    std::deque<NetworkTraceRecord> m_pending_responses;
+    std::vector<std::deque<NetworkTraceRecord>> m_response_queues;
+    int m_num_responses;
+    // closed-loop requests being served are those with a response
+    // pending or queued; while 'm_service_queue_depth' are, arriving
+    // requests wait here (in arrival order) and hold their vc, so that
+    // responses backpressure requests as a protocol would
+    uint32_t m_service_queue_depth;
+    std::deque<flit *> m_stalled_requests;
 
     // The Message buffers that takes messages from the protocol
     std::vector<MessageBuffer *> inNode_ptr;
@@ -115,12 +160,21 @@ class NetworkInterface : public ClockedObject, public Consumer
     std::vector<MessageBuffer *> outNode_ptr;
     // When a vc stays busy for a long time, it indicates a deadlock
     std::vector<int> vc_busy_counter;
+    // stats of the flits ejected here, not yet in those of the network
+    FlitStatsAccumulator m_flit_stats;
 
     bool checkStallQueue();
+    void stallFlit(flit *t_flit);
+    void markUnstallPending(int vnet);
     bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
+    bool injectDirectPacket(const NetworkTraceRecord& record);
+    void ejectDirectFlit(flit *t_flit);
+    bool serviceQueueFull();
+    void receiveDirectPacket(flit *t_flit);
+    void reassembleFlit(flit *t_flit);
     int calculateVC(int vnet);
 
-    void scheduleOutputLink();
+    bool scheduleOutputLink();
     void checkReschedule();
     void sendCredit(flit *t_flit, bool is_free);
 
@@ -33,6 +33,10 @@
 
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 
+#include <algorithm>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
 
 NetworkLink::NetworkLink(const Params *p)
@@ -42,9 +46,18 @@ NetworkLink::NetworkLink(const Params *p)
       m_type(NUM_LINK_TYPES_),
       m_latency(p->link_latency),
       link_consumer(nullptr),
-      link_srcQueue(nullptr), m_link_utilized(0),
+      link_srcQueue(nullptr), m_next_free_cycle(0), m_link_utilized(0),
       m_vc_load(p->vcs_per_vnet * p->virt_nets)
 {
+    int flit_bits = p->flit_size * 8;
+    int width_bits = (p->width_bits == 0) ? flit_bits : p->width_bits;
+    if ((width_bits > flit_bits) && (width_bits % flit_bits != 0))
+        fatal("Link %d: width (%d bits) is not a multiple of the "
+              "flit size (%d bits)\n", m_id, width_bits, flit_bits);
+
+    m_flits_per_cycle = std::max(width_bits / flit_bits, 1);
+    m_serialization_cycles = divCeil(flit_bits, width_bits);
+    m_serdes_latency = p->serdes_latency;
 }
 
 NetworkLink::~NetworkLink()
@@ -64,17 +77,42 @@ NetworkLink::setSourceQueue(flitBuffer *srcQueue)
     link_srcQueue = srcQueue;
 }
 
+// Up to m_flits_per_cycle flits enter the link each cycle; a link
+// narrower than a flit takes a new one every m_serialization_cycles.
+// Flits left in the source queue wait for the link to be free.
 void
 NetworkLink::wakeup()
 {
-    if (link_srcQueue->isReady(curCycle())) {
+    if (curCycle() < m_next_free_cycle) {
+        if (link_srcQueue->isReady(curCycle()))
+            scheduleEvent(m_next_free_cycle - curCycle());
+        return;
+    }
+
+    Cycles latency = getLatency();
+    for (int i = 0; i < m_flits_per_cycle; i++) {
+        if (!link_srcQueue->isReady(curCycle()))
+            break;
         flit *t_flit = link_srcQueue->getTopFlit();
-        t_flit->set_time(curCycle() + m_latency);
+        t_flit->set_time(curCycle() + latency);
         linkBuffer->insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        link_consumer->scheduleEventAbsolute(clockEdge(latency));
+        m_next_free_cycle = curCycle() + Cycles(m_serialization_cycles);
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
     }
+
+    if (link_srcQueue->isReady(curCycle()))
+        scheduleEvent(Cycles(m_serialization_cycles));
+}
+
+void
+NetworkLink::bypassFlit(flit *t_flit)
+{
+    assert(!isBusy());
+    m_next_free_cycle = curCycle() + Cycles(1);
+    m_link_utilized++;
+    m_vc_load[t_flit->get_vc()]++;
 }
 
 void
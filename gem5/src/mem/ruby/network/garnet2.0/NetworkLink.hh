@@ -61,6 +61,27 @@ class NetworkLink : public ClockedObject, public Consumer
     void wakeup();
 
     unsigned int getLinkUtilization() const { return m_link_utilized; }
+    // cycles from a flit entering the link to its arrival
+    Cycles
+    getLatency() const
+    {
+        return m_latency + m_serdes_latency +
+            Cycles(m_serialization_cycles - 1);
+    }
+    // flits entering the link per cycle (wide links)
+    int getFlitsPerCycle() const { return m_flits_per_cycle; }
+    // cycles a flit occupies the link (narrow links)
+    int getSerializationCycles() const { return m_serialization_cycles; }
+
+    // SMART: the link carries a flit this cycle, or will from its
+    // source queue; a bypassing flit crosses it without queueing
+    bool
+    isBusy()
+    {
+        return ((curCycle() < m_next_free_cycle) ||
+                link_srcQueue->isReady(curCycle()));
+    }
+    void bypassFlit(flit *t_flit);
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
 
     inline bool isReady(Cycles curTime)
@@ -79,9 +100,14 @@ class NetworkLink : public ClockedObject, public Consumer
     const int m_id;
     link_type m_type;
     const Cycles m_latency;
+    int m_flits_per_cycle;
+    int m_serialization_cycles;
+    Cycles m_serdes_latency;
 
     Consumer *link_consumer;
     flitBuffer *link_srcQueue;
+    // first cycle the link takes new flits again
+    Cycles m_next_free_cycle;
 
     // Statistical variables
     unsigned int m_link_utilized;
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/NetworkTraceReader.hh"
+
+#include <cstring>
+
+#include "base/logging.hh"
+
+// binary records are read this many at a time
+#define NETWORK_TRACE_CHUNK 4096
+
+static_assert(sizeof(NetworkTraceBinRecord) == 24,
+              "binary network trace record must be 24 bytes");
+
+static bool
+ends_with(const std::string& str, const std::string& suffix)
+{
+    return (str.size() >= suffix.size()) &&
+        (str.compare(str.size() - suffix.size(), suffix.size(),
+                     suffix) == 0);
+}
+
+NetworkTraceReader::NetworkTraceReader(const std::string& filename,
+                                       int max_packets, int buffer_packets)
+    : m_filename(filename), m_file(NULL), m_is_pipe(false),
+      m_binary(false), m_max_packets(max_packets),
+      m_buffer_packets(buffer_packets), m_num_read(0), m_line_num(0),
+      m_first_time(0), m_last_time(0), m_bin_pos(0), m_eof(false),
+      m_stop(false), m_bad_line(0), m_unordered(false), m_num_popped(0)
+{
+    assert(m_buffer_packets > 0);
+
+    m_is_pipe = ends_with(m_filename, ".gz");
+    m_binary = ends_with(m_filename, ".gntr") ||
+        ends_with(m_filename, ".gntr.gz");
+
+    if (m_is_pipe) {
+        std::string command = "gunzip -c '" + m_filename + "'";
+        m_file = popen(command.c_str(), "r");
+    } else {
+        m_file = fopen(m_filename.c_str(), "r");
+    }
+    if (m_file == NULL)
+        fatal("Could not open network trace %s\n", m_filename);
+
+    if (m_binary) {
+        char magic[4];
+        uint32_t version;
+        uint64_t num_records;
+        if ((fread(magic, sizeof(magic), 1, m_file) != 1) ||
+            (fread(&version, sizeof(version), 1, m_file) != 1) ||
+            (fread(&num_records, sizeof(num_records), 1, m_file) != 1) ||
+            (memcmp(magic, NETWORK_TRACE_MAGIC, sizeof(magic)) != 0)) {
+            fatal("%s is not a binary network trace\n", m_filename);
+        }
+        if (version != NETWORK_TRACE_VERSION) {
+            fatal("%s: binary network trace version %d, expected %d\n",
+                  m_filename, version, NETWORK_TRACE_VERSION);
+        }
+        m_bin_chunk.reserve(NETWORK_TRACE_CHUNK);
+    }
+
+    m_thread = std::thread(&NetworkTraceReader::run, this);
+}
+
+NetworkTraceReader::~NetworkTraceReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_not_full.notify_all();
+    m_thread.join();
+
+    if (m_is_pipe)
+        pclose(m_file);
+    else
+        fclose(m_file);
+}
+
+bool
+NetworkTraceReader::next(NetworkTraceRecord& record)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [this]{ return !m_queue.empty() || m_eof; });
+
+    if (m_unordered) {
+        warn_once("network trace %s is not in cycle order\n",
+                  m_filename);
+    }
+
+    if (m_queue.empty()) {
+        if (m_bad_line > 0) {
+            fatal("%s:%d: bad network trace record\n", m_filename,
+                  m_bad_line);
+        }
+        return false;
+    }
+
+    record = m_queue.front();
+    m_queue.pop_front();
+    m_num_popped++;
+    lock.unlock();
+    m_not_full.notify_one();
+    return true;
+}
+
+void
+NetworkTraceReader::push(const NetworkTraceRecord& record)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_full.wait(lock, [this]{
+        return (m_queue.size() < m_buffer_packets) || m_stop; });
+    if (m_stop)
+        return;
+
+    m_queue.push_back(record);
+    lock.unlock();
+    m_not_empty.notify_one();
+}
+
+// reader thread: parse the trace into the bounded queue
+void
+NetworkTraceReader::run()
+{
+    NetworkTraceRecord record;
+    while ((m_max_packets < 0) || (m_num_read < m_max_packets)) {
+        bool got = m_binary ? read_binary(record) : read_text(record);
+        if (!got)
+            break;
+
+        // cycles relative to the first packet
+        uint64_t time = uint64_t(record.time);
+        if (m_num_read == 0)
+            m_first_time = time;
+        if (time < m_last_time) {
+            if (!m_unordered) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_unordered = true;
+            }
+            time = m_last_time;
+        }
+        m_last_time = time;
+        record.time = Cycles(time - m_first_time);
+
+        m_num_read++;
+        push(record);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop)
+            return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_eof = true;
+    }
+    m_not_empty.notify_all();
+}
+
+bool
+NetworkTraceReader::read_text(NetworkTraceRecord& record)
+{
+    char line[1000];
+    while (fgets(line, sizeof(line), m_file) != NULL) {
+        m_line_num++;
+
+        unsigned long long time;
+        int src_ni, dest_ni, vnet, num_flits;
+        char *start = line + strspn(line, " \t");
+        if ((*start == '#') || (*start == '\n') || (*start == '\0') ||
+            (strncmp(start, "info", 4) == 0)) {
+            continue;
+        }
+
+        if (sscanf(start, "%llu %d %d %d %d", &time, &src_ni, &dest_ni,
+                   &vnet, &num_flits) != 5) {
+            // ends the trace, see next()
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bad_line = m_line_num;
+            return false;
+        }
+
+        record.valid = true;
+        record.time = Cycles(time);
+        record.src_id = src_ni;
+        record.src_router_id = -1;
+        record.dest_id = dest_ni;
+        record.dest_router_id = -1;
+        record.vnet = vnet;
+        record.num_flits = num_flits;
+        return true;
+    }
+    return false;
+}
+
+bool
+NetworkTraceReader::read_binary(NetworkTraceRecord& record)
+{
+    if (m_bin_pos == m_bin_chunk.size()) {
+        m_bin_chunk.resize(NETWORK_TRACE_CHUNK);
+        size_t num = fread(m_bin_chunk.data(),
+                           sizeof(NetworkTraceBinRecord),
+                           NETWORK_TRACE_CHUNK, m_file);
+        m_bin_chunk.resize(num);
+        m_bin_pos = 0;
+        if (num == 0)
+            return false;
+    }
+
+    const NetworkTraceBinRecord& bin = m_bin_chunk[m_bin_pos++];
+    record.valid = true;
+    record.time = Cycles(bin.time);
+    record.src_id = bin.src_ni;
+    record.src_router_id = -1;
+    record.dest_id = bin.dest_ni;
+    record.dest_router_id = -1;
+    record.vnet = bin.vnet;
+    record.num_flits = bin.num_flits;
+    return true;
+}
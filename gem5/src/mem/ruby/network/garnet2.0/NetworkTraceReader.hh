@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_NETWORKTRACEREADER_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_NETWORKTRACEREADER_HH__
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/types.hh"
+
+struct NetworkTraceRecord {
+    bool valid;
+    Cycles time;
+    int src_id;
+    int src_router_id;
+    int dest_id;
+    int dest_router_id;
+    int vnet;
+    int num_flits;
+    // closed-loop traffic (GarnetTrafficSource); not in traces
+    int64_t req_id = -1;
+    bool is_response = false;
+};
+
+// On-disk record of the binary trace format: a header of magic
+// "GNTR", uint32 version and uint64 number of records, followed by
+// the records (all little endian). See util/encode_network_trace.py.
+struct NetworkTraceBinRecord {
+    uint64_t time;
+    uint32_t src_ni;
+    uint32_t dest_ni;
+    uint16_t vnet;
+    uint16_t num_flits;
+    uint32_t reserved;
+};
+
+#define NETWORK_TRACE_MAGIC "GNTR"
+#define NETWORK_TRACE_VERSION 1
+
+// Reads a network trace in a background thread, a bounded number of
+// packets ahead of the simulation.
+//
+// Text traces have one packet per line:
+//     <cycle> <src-ni> <dest-ni> <vnet> <num-flits>
+// Lines starting with '#' or "info" are header lines. Traces with a
+// ".gntr" (or ".gntr.gz") name are in the binary format; either kind
+// is decompressed through gunzip when the name ends in ".gz".
+//
+// Packets must be in cycle order; the cycle of the first packet is
+// taken as cycle 0 of the replay.
+//
+// The reader thread does not report errors itself (gem5 logging is
+// not thread safe): they are reported by next(), in the simulation
+// thread, once the packets read before them are consumed.
+class NetworkTraceReader
+{
+  public:
+    // max_packets < 0: the whole trace
+    NetworkTraceReader(const std::string& filename, int max_packets,
+                       int buffer_packets);
+    ~NetworkTraceReader();
+
+    // next packet of the trace (src/dest router ids are not filled in);
+    // blocks until the reader thread got it. false at the end of trace,
+    // fatal at a bad record
+    bool next(NetworkTraceRecord& record);
+
+    uint64_t get_num_read() { return m_num_popped; }
+
+  private:
+    void run();
+    bool read_text(NetworkTraceRecord& record);
+    bool read_binary(NetworkTraceRecord& record);
+    void push(const NetworkTraceRecord& record);
+
+    std::string m_filename;
+    FILE *m_file;
+    bool m_is_pipe;
+    bool m_binary;
+    int64_t m_max_packets;
+    int m_buffer_packets;
+
+    // reader thread state
+    uint64_t m_num_read;
+    uint64_t m_line_num;
+    uint64_t m_first_time;
+    uint64_t m_last_time;
+    std::vector<NetworkTraceBinRecord> m_bin_chunk;
+    int m_bin_pos;
+
+    // shared with the simulation thread
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::deque<NetworkTraceRecord> m_queue;
+    bool m_eof;
+    bool m_stop;
+    uint64_t m_bad_line; // text line of a bad record, 0 if none
+    bool m_unordered; // a packet was earlier than the one before
+
+    uint64_t m_num_popped;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_NETWORKTRACEREADER_HH__
@@ -36,30 +36,13 @@
 #include "mem/ruby/system/RubySystem.hh"
 
 OutVcState::OutVcState(int id, GarnetNetwork *network_ptr)
-    : m_time(0)
+    : m_id(id), m_store(network_ptr->get_vc_store())
 {
-    m_id = id;
-    m_vc_state = IDLE_;
-
+    int max_credit_count;
     if (network_ptr->get_vnet_type(id) == DATA_VNET_)
-        m_max_credit_count = network_ptr->getBuffersPerDataVC();
+        max_credit_count = network_ptr->getBuffersPerDataVC();
     else
-        m_max_credit_count = network_ptr->getBuffersPerCtrlVC();
-
-    m_credit_count = m_max_credit_count;
-    assert(m_credit_count >= 1);
-}
+        max_credit_count = network_ptr->getBuffersPerCtrlVC();
 
-void
-OutVcState::increment_credit()
-{
-    m_credit_count++;
-    assert(m_credit_count <= m_max_credit_count);
-}
-
-void
-OutVcState::decrement_credit()
-{
-    m_credit_count--;
-    assert(m_credit_count >= 0);
+    m_index = m_store->add_output_vc(id, max_credit_count);
 }
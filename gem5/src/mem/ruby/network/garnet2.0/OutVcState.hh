@@ -37,34 +37,37 @@
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 
+// State and credits, as seen upstream, of the input vc 'id' of the
+// next router (or NI): a view of its output vc entry in the
+// VcStateStore of the network
 class OutVcState
 {
   public:
     OutVcState(int id, GarnetNetwork *network_ptr);
 
-    int get_credit_count()          { return m_credit_count; }
-    inline bool has_credit()       { return (m_credit_count > 0); }
-    void increment_credit();
-    void decrement_credit();
+    int get_credit_count()    { return m_store->get_credit_count(m_index); }
+    inline bool has_credit()  { return m_store->has_credit(m_index); }
+    void increment_credit()   { m_store->increment_credit(m_index); }
+    void decrement_credit()   { m_store->decrement_credit(m_index); }
 
     inline bool
     isInState(VC_state_type state, Cycles request_time)
     {
-        return ((m_vc_state == state) && (request_time >= m_time) );
+        return m_store->is_out_vc_in_state(m_index, state, request_time);
     }
     inline void
     setState(VC_state_type state, Cycles time)
     {
-        m_vc_state = state;
-        m_time = time;
+        m_store->set_out_state(m_index, state, time);
     }
 
+    // index of this vc in the store
+    int get_index() const { return m_index; }
+
   private:
-    int m_id ;
-    Cycles m_time;
-    VC_state_type m_vc_state;
-    int m_credit_count;
-    int m_max_credit_count;
+    int m_id;
+    VcStateStore *m_store;
+    int m_index;
 };
 
 #endif //__MEM_RUBY_NETWORK_GARNET2_0_OUTVCSTATE_HH__
@@ -54,11 +54,25 @@ OutputUnit::OutputUnit(int id, PortDirection direction, Router *router)
     for (int i = 0; i < m_num_vcs; i++) {
         m_outvc_state.push_back(new OutVcState(i, m_router->get_net_ptr()));
     }
+    m_vc_store = m_router->get_net_ptr()->get_vc_store();
+    m_outvc_base = m_outvc_state[0]->get_index();
+    assert(m_outvc_state[m_num_vcs - 1]->get_index() ==
+           m_outvc_base + m_num_vcs - 1);
+
+    // input ports of routers share their buffers; NIs do not buffer
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    m_credit_pool = nullptr;
+    if (net_ptr->isSharedInputBuffers() && (m_direction != "Local")) {
+        m_credit_pool = new SharedCreditPool(m_num_vcs,
+            net_ptr->getDamqBuffersPerPort(),
+            net_ptr->getDamqReservedPerVC());
+    }
 }
 
 OutputUnit::~OutputUnit()
 {
     delete m_out_buffer;
+    delete m_credit_pool;
     deletePointers(m_outvc_state);
 }
 
@@ -69,7 +83,10 @@ OutputUnit::decrement_credit(int out_vc)
             "outvc %d at time: %lld\n",
             m_router->get_id(), m_id, out_vc, m_router->curCycle());
 
-    m_outvc_state[out_vc]->decrement_credit();
+    if (m_credit_pool != nullptr)
+        m_credit_pool->decrement_credit(out_vc);
+    else
+        m_vc_store->decrement_credit(m_outvc_base + out_vc);
 }
 
 void
@@ -79,7 +96,10 @@ OutputUnit::increment_credit(int out_vc)
             "outvc %d at time: %lld\n",
             m_router->get_id(), m_id, out_vc, m_router->curCycle());
 
-    m_outvc_state[out_vc]->increment_credit();
+    if (m_credit_pool != nullptr)
+        m_credit_pool->increment_credit(out_vc);
+    else
+        m_vc_store->increment_credit(m_outvc_base + out_vc);
 }
 
 // Check if the output VC (i.e., input VC at next router)
@@ -88,50 +108,70 @@ OutputUnit::increment_credit(int out_vc)
 bool
 OutputUnit::has_credit(int out_vc)
 {
-    assert(m_outvc_state[out_vc]->isInState(ACTIVE_, m_router->curCycle()));
-    return m_outvc_state[out_vc]->has_credit();
+    assert(m_vc_store->is_out_vc_in_state(m_outvc_base + out_vc, ACTIVE_,
+                                          m_router->curCycle()));
+    if (m_credit_pool != nullptr)
+        return m_credit_pool->has_credit(out_vc);
+    return m_vc_store->has_credit(m_outvc_base + out_vc);
 }
 
 
+// The free vc queries read the idle masks of the vc store, which
+// follow the state changes of set_vc_state()
 int
 OutputUnit::getNumFreeVCs(int vnet)
 {
-    int freeVC = 0;
+    return m_vc_store->get_num_idle_out_vcs(
+        m_outvc_base + vnet*m_vc_per_vnet, m_vc_per_vnet);
+}
+
+// Total credits (free buffers at the next router) over the vcs of 'vnet'
+int
+OutputUnit::getNumCredits(int vnet)
+{
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
-        if (is_vc_idle(vc, m_router->curCycle()))
-            freeVC++;
-    }
-    return freeVC;
+    if (m_credit_pool == nullptr)
+        return m_vc_store->get_vnet_credit_count(m_outvc_base + vc_base);
 
+    int credits = 0;
+    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++)
+        credits += get_credit_count(vc);
+    return credits;
 }
 
 // Check if the output port (i.e., input port at next router) has free VCs.
 bool
 OutputUnit::has_free_vc(int vnet)
 {
-    int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
-        if (is_vc_idle(vc, m_router->curCycle()))
-            return true;
-    }
+    return has_free_vc(vnet, 0, m_vc_per_vnet);
+}
 
-    return false;
+bool
+OutputUnit::has_free_vc(int vnet, int first, int num)
+{
+    return (m_vc_store->find_idle_out_vc(
+        m_outvc_base + vnet*m_vc_per_vnet + first, num) != -1);
 }
 
 // Assign a free output VC to the winner of Switch Allocation
 int
 OutputUnit::select_free_vc(int vnet)
 {
-    int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
-        if (is_vc_idle(vc, m_router->curCycle())) {
-            m_outvc_state[vc]->setState(ACTIVE_, m_router->curCycle());
-            return vc;
-        }
-    }
+    return select_free_vc(vnet, 0, m_vc_per_vnet);
+}
 
-    return -1;
+int
+OutputUnit::select_free_vc(int vnet, int first, int num)
+{
+    int vc = m_vc_store->find_idle_out_vc(
+        m_outvc_base + vnet*m_vc_per_vnet + first, num);
+    if (vc == -1)
+        return -1;
+
+    vc -= m_outvc_base;
+    assert(is_vc_idle(vc, m_router->curCycle()));
+    set_vc_state(ACTIVE_, vc, m_router->curCycle());
+    return vc;
 }
 
 /*
@@ -145,7 +185,7 @@ OutputUnit::select_free_vc(int vnet)
 void
 OutputUnit::wakeup()
 {
-    if (m_credit_link->isReady(m_router->curCycle())) {
+    while (m_credit_link->isReady(m_router->curCycle())) {
         Credit *t_credit = (Credit*) m_credit_link->consumeLink();
         increment_credit(t_credit->get_vc());
 
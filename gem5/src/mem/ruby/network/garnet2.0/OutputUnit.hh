@@ -43,6 +43,7 @@
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 #include "mem/ruby/network/garnet2.0/OutVcState.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
+#include "mem/ruby/network/garnet2.0/SharedCreditPool.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 
 class OutputUnit : public Consumer
@@ -59,8 +60,12 @@ class OutputUnit : public Consumer
     void increment_credit(int out_vc);
     bool has_credit(int out_vc);
     int getNumFreeVCs(int vnet);
+    int getNumCredits(int vnet);
     bool has_free_vc(int vnet);
     int select_free_vc(int vnet);
+    // restricted to vcs [first, first + num) of 'vnet'
+    bool has_free_vc(int vnet, int first, int num);
+    int select_free_vc(int vnet, int first, int num);
 
     inline PortDirection get_direction() { return m_direction; }
     inline int get_id() { return m_id; }
@@ -68,7 +73,9 @@ class OutputUnit : public Consumer
     int
     get_credit_count(int vc)
     {
-        return m_outvc_state[vc]->get_credit_count();
+        if (m_credit_pool != nullptr)
+            return m_credit_pool->get_credit_count(vc);
+        return m_vc_store->get_credit_count(m_outvc_base + vc);
     }
 
     inline int
@@ -80,13 +87,14 @@ class OutputUnit : public Consumer
     inline void
     set_vc_state(VC_state_type state, int vc, Cycles curTime)
     {
-      m_outvc_state[vc]->setState(state, curTime);
+        m_vc_store->set_out_state(m_outvc_base + vc, state, curTime);
     }
 
     inline bool
     is_vc_idle(int vc, Cycles curTime)
     {
-        return (m_outvc_state[vc]->isInState(IDLE_, curTime));
+        return m_vc_store->is_out_vc_in_state(m_outvc_base + vc, IDLE_,
+                                              curTime);
     }
 
     inline void
@@ -100,15 +108,22 @@ class OutputUnit : public Consumer
 
     // Making it public
     NetworkLink *m_out_link;
-    std::vector<OutVcState *> m_outvc_state; // vc state of downstream router
+    // vc state of downstream router: views of the entries
+    // [m_outvc_base, m_outvc_base + m_num_vcs) of the vc store of the
+    // network, which the functions here access directly
+    std::vector<OutVcState *> m_outvc_state;
 
   private:
     int m_id;
     PortDirection m_direction;
     int m_num_vcs;
     int m_vc_per_vnet;
+    VcStateStore *m_vc_store;
+    int m_outvc_base;
     Router *m_router;
     CreditLink *m_credit_link;
+    // credits of a shared input port downstream, else per vc
+    SharedCreditPool *m_credit_pool;
 
     flitBuffer *m_out_buffer; // This is for the network link to consume
 
@@ -39,6 +39,7 @@
 #include "mem/ruby/network/garnet2.0/CrossbarSwitch.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/NetworkEnergyModel.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
 #include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
@@ -64,6 +65,7 @@ Router::Router(const Params *p)
     m_output_unit.clear();
 
     halt_ = false;
+    m_drain_flits = 0;
 
 }
 
@@ -81,6 +83,7 @@ Router::init()
 {
     BasicRouter::init();
 
+    m_routing_unit->init();
     m_sw_alloc->init();
     m_switch->init();
 }
@@ -140,8 +143,10 @@ Router::wakeup()
         bool spin_safe_ = false;
         int pre_drain_delay=2;
         // cout << "m_net_ptr->lock: " << m_network_ptr->lock << endl;
+        // epochs in which no vnet is scheduled to drain are skipped
         if ((curCycle() > 0) &&
-            (curCycle() % get_net_ptr()->m_spin_thrshld == 0)) {
+            (curCycle() % get_net_ptr()->m_spin_thrshld == 0) &&
+            get_net_ptr()->any_drain_due(curCycle())) {
             #if(DEBUG_PRINT)
                 cout << "thershold has reached.. put halt mode on.." << endl;
                 cout << "curcycle(): " << curCycle() << endl;
@@ -183,48 +188,36 @@ Router::wakeup()
                 spin_safe_ = get_net_ptr()->chck_link_state();
                 assert(spin_safe_);
 
+                // Only the vnets whose own drain period divides the
+                // start of this epoch are drained; all of their selected
+                // vcs move together in one walk of the spinRing.
+                Cycles epoch_start = Cycles(curCycle() -
+                    curCycle() % get_net_ptr()->m_spin_thrshld);
+                std::vector<int> drain_vcs;
+                int itrn;
                 if (get_net_ptr()->m_spin_mult == 0) {
-                    int itrn = rand() % 10;
+                    // only drain the base VC of each 'vnet'
+                    get_net_ptr()->get_drain_vcs(epoch_start, true, drain_vcs);
+                    itrn = get_net_ptr()->drain_rng().random(0, 9);
+                } else {
+                    get_net_ptr()->get_drain_vcs(epoch_start,
+                        (get_net_ptr()->drain_all_vc != 1), drain_vcs);
+                    itrn = get_net_ptr()->m_spin_mult;
+                }
+
+                if (!drain_vcs.empty()) {
                     for (int i = 0; i < itrn; i++) {
-                        // only drain the base VC
-                        // of each 'vnet'
-                        for(int vnet_=0; vnet_<m_virtual_networks; vnet_++) {
-                            // update stats
+                        // update stats
+                        for (int k = 0; k < drain_vcs.size(); k++)
                             get_net_ptr()->increment_num_drain();
-                            // Doing spin here...
-                            get_net_ptr()->doSpin(vnet_*m_vc_per_vnet);
-                        }
-                    }
-                } else if (get_net_ptr()->m_spin_mult > 0) {
-                    for (int i = 0; i < get_net_ptr()->m_spin_mult; i++) {
                         // Doing spin here...
-                        if(get_net_ptr()->drain_all_vc == 1) {
-                            for(int vc_ = 0; vc_ < m_num_vcs; vc_++) {
-                                get_net_ptr()->increment_num_drain();
-                                get_net_ptr()->doSpin(vc_);
-                            }
-                        } else {
-                            // only drain the base VC
-                            // of each 'vnet'
-                            for(int vnet_=0; vnet_<m_virtual_networks; vnet_++) {
-                                get_net_ptr()->increment_num_drain();
-                                get_net_ptr()->doSpin(vnet_*m_vc_per_vnet);
-                            }
-                        }
-                    }
-                }
-                // we come here after successfully spin-ing
-                // pre-requisite number of times; set the time
-                // in the flits present in the network ( except
-                // injection/ejection ports ) accordingly.
-                if(get_net_ptr()->drain_all_vc == 1) {
-                    for(int vc_ = 0; vc_ < m_num_vcs; vc_++) {
-                        get_net_ptr()->set_flit_time(vc_);
-                    }
-                } else {
-                    for(int vnet_=0; vnet_<m_virtual_networks; vnet_++) {
-                        get_net_ptr()->set_flit_time(vnet_*m_vc_per_vnet);
+                        get_net_ptr()->doSpin(drain_vcs);
                     }
+                    // we come here after successfully spin-ing
+                    // pre-requisite number of times; set the time
+                    // in the flits present in the network ( except
+                    // injection/ejection ports ) accordingly.
+                    get_net_ptr()->set_flit_time(drain_vcs);
                 }
             }
 
@@ -264,6 +257,8 @@ Router::compute_hops_remaining(flit * flit_t)
     int my_y = m_id / num_cols;
 
     int dest_id = flit_t->get_route().dest_router;
+    if (dest_id == -1) // multicast to several routers
+        return 0;
     int dest_x = dest_id % num_cols;
     int dest_y = dest_id / num_cols;
 
@@ -329,6 +324,131 @@ Router::route_compute(RouteInfo route, int inport, PortDirection inport_dirn)
     return m_routing_unit->outportCompute(route, inport, inport_dirn);
 }
 
+// Lookahead routing: compute the outport of 't_flit' at the router
+// behind 'outport', which then skips route computation.
+void
+Router::lookahead_route(flit *t_flit, int outport)
+{
+    int next_id = m_network_ptr->get_link_dest(m_id, outport);
+    if (next_id == -1) {
+        t_flit->set_lookahead(-1, -1, -1);
+        return;
+    }
+
+    Router *next = m_network_ptr->m_routers[next_id];
+    int next_inport = m_network_ptr->get_link_dest_inport(m_id, outport);
+    int next_outport = next->route_compute(t_flit->get_route(), next_inport,
+        next->getInportDirection(next_inport));
+    t_flit->set_lookahead(next_id, next_inport, next_outport);
+}
+
+/*
+ * SMART: the flit that just reached 'inport' goes on to the next
+ * router in the same cycle (a bypassed hop) if this router grants it:
+ *  - it is a single-flit packet of an unordered vnet, which has not
+ *    crossed HPCmax links yet this cycle, and is not for this router,
+ *  - its route goes straight on, over a single-cycle link which
+ *    carries no other flit this cycle,
+ *  - a vc of its vnet is free at the next router,
+ *  - no flit buffered here requests that outport this cycle (local
+ *    flits win the SSR arbitration over bypassing ones),
+ *  - neither this router nor the next one is halted by DRAIN.
+ * The input vc is released upstream at once and the flit takes an
+ * output vc here, as if it had been switched.
+ * 'outport' returns the route computed here (-1 if none), for the
+ * flit to use if it stops.
+ */
+bool
+Router::smart_bypass(int inport, flit *t_flit, int& outport)
+{
+    GarnetNetwork *net_ptr = m_network_ptr;
+    RouteInfo route = t_flit->get_route();
+    int vnet = t_flit->get_vnet();
+
+    outport = -1;
+    if ((t_flit->get_type() != HEAD_TAIL_) ||
+        (t_flit->m_smart_hops >= net_ptr->getSmartHpcMax()) ||
+        net_ptr->isVNetOrdered(vnet) || route.multicast ||
+        (route.dest_router == m_id)) {
+        return false;
+    }
+    if (halt_) {
+        net_ptr->m_smart_halted++;
+        return false;
+    }
+
+    if (t_flit->get_lookahead_outport(m_id, inport) == -1)
+        outport = route_compute(route, inport, getInportDirection(inport));
+    int bypass_outport = (outport == -1) ?
+        t_flit->get_lookahead_outport(m_id, inport) : outport;
+    if (getOutportDirection(bypass_outport) != t_flit->get_outport_dir())
+        return false;
+    int next_id = net_ptr->get_link_dest(m_id, bypass_outport);
+    OutputUnit *output_unit = m_output_unit[bypass_outport];
+    NetworkLink *link = output_unit->m_out_link;
+    if ((next_id == -1) || (link->getLatency() != Cycles(1)) ||
+        link->isBusy() || !output_unit->has_free_vc(vnet) ||
+        has_local_request(bypass_outport)) {
+        return false;
+    }
+    Router *next = net_ptr->m_routers[next_id];
+    if (next->halt_) {
+        net_ptr->m_smart_halted++;
+        return false;
+    }
+    outport = bypass_outport;
+
+    m_input_unit[inport]->increment_credit(t_flit->get_vc(), true,
+                                           curCycle());
+    int outvc = output_unit->select_free_vc(vnet);
+    output_unit->decrement_credit(outvc);
+
+    t_flit->set_vc(outvc);
+    t_flit->set_outport(outport);
+    t_flit->set_outport_dir(getOutportDirection(outport));
+    t_flit->set_lookahead(-1, -1, -1);
+    t_flit->set_time(curCycle());
+    t_flit->m_smart_hops++;
+    link->bypassFlit(t_flit);
+    net_ptr->m_smart_bypassed_hops++;
+
+    int next_inport = net_ptr->get_link_dest_inport(m_id, outport);
+    next->get_inputUnit_ref()[next_inport]->accept_flit(t_flit);
+    return true;
+}
+
+// a flit buffered at this router goes for SA on 'outport' this cycle
+bool
+Router::has_local_request(int outport)
+{
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        InputUnit *input_unit = m_input_unit[inport];
+        for (int vc = 0; vc < m_num_vcs; vc++) {
+            if (!input_unit->need_stage(vc, SA_, curCycle()))
+                continue;
+            int vc_outport = (input_unit->get_outvc(vc) != -1) ?
+                input_unit->get_outport(vc) :
+                input_unit->peekTopFlit(vc)->get_outport();
+            if (vc_outport == outport)
+                return true;
+        }
+    }
+    return false;
+}
+
+// no flit is buffered at any input vc
+bool
+Router::is_empty()
+{
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        for (int vc = 0; vc < m_num_vcs; vc++) {
+            if (!m_input_unit[inport]->vc_isEmpty(vc))
+                return false;
+        }
+    }
+    return true;
+}
+
 void
 Router::grant_switch(int inport, flit *t_flit)
 {
@@ -381,6 +501,35 @@ Router::regStats()
         .name(name() + ".sw_output_arbiter_activity")
         .flags(Stats::nozero)
     ;
+
+    m_sw_alloc_cycles
+        .name(name() + ".sw_alloc_cycles")
+        .flags(Stats::nozero)
+    ;
+
+    m_sw_alloc_grants
+        .name(name() + ".sw_alloc_grants")
+        .flags(Stats::nozero)
+    ;
+
+    m_sw_alloc_max_grants
+        .name(name() + ".sw_alloc_max_grants")
+        .flags(Stats::nozero)
+    ;
+
+    // average matching size of the rounds with requests, and its
+    // ratio to the largest matching the requests allowed
+    m_sw_alloc_match_size
+        .name(name() + ".sw_alloc_match_size")
+        .flags(Stats::nozero)
+    ;
+    m_sw_alloc_match_size = m_sw_alloc_grants / m_sw_alloc_cycles;
+
+    m_sw_alloc_efficiency
+        .name(name() + ".sw_alloc_efficiency")
+        .flags(Stats::nozero)
+    ;
+    m_sw_alloc_efficiency = m_sw_alloc_grants / m_sw_alloc_max_grants;
 }
 
 void
@@ -395,6 +544,9 @@ Router::collateStats()
 
     m_sw_input_arbiter_activity = m_sw_alloc->get_input_arbiter_activity();
     m_sw_output_arbiter_activity = m_sw_alloc->get_output_arbiter_activity();
+    m_sw_alloc_cycles = m_sw_alloc->get_alloc_cycles();
+    m_sw_alloc_grants = m_sw_alloc->get_alloc_grants();
+    m_sw_alloc_max_grants = m_sw_alloc->get_alloc_max_grants();
     m_crossbar_activity = m_switch->get_crossbar_activity();
 }
 
@@ -409,6 +561,36 @@ Router::resetStats()
 
     m_switch->resetStats();
     m_sw_alloc->resetStats();
+    m_drain_flits = 0;
+}
+
+RouterActivity
+Router::get_activity()
+{
+    RouterActivity activity;
+    activity.buffer_reads = 0;
+    activity.buffer_writes = 0;
+    activity.link = 0;
+    for (int i = 0; i < m_input_unit.size(); i++) {
+        for (int j = 0; j < m_virtual_networks; j++) {
+            activity.buffer_reads +=
+                m_input_unit[i]->get_buf_read_activity(j);
+            activity.buffer_writes +=
+                m_input_unit[i]->get_buf_write_activity(j);
+        }
+        // injection links have no router upstream
+        if (m_input_unit[i]->get_direction() == "Local")
+            activity.link +=
+                m_input_unit[i]->get_in_link()->getLinkUtilization();
+    }
+    for (int i = 0; i < m_output_unit.size(); i++)
+        activity.link += m_output_unit[i]->m_out_link->getLinkUtilization();
+
+    activity.crossbar = m_switch->get_crossbar_activity();
+    activity.sw_arbiter = m_sw_alloc->get_input_arbiter_activity() +
+        m_sw_alloc->get_output_arbiter_activity();
+    activity.drain = m_drain_flits;
+    return activity;
 }
 
 void
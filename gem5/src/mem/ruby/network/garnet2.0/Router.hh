@@ -53,6 +53,7 @@ class RoutingUnit;
 class SwitchAllocator;
 class CrossbarSwitch;
 class FaultModel;
+struct RouterActivity;
 
 class Router : public BasicRouter, public Consumer
 {
@@ -92,6 +93,10 @@ class Router : public BasicRouter, public Consumer
     PortDirection getInportDirection(int inport);
 
     int route_compute(RouteInfo route, int inport, PortDirection direction);
+    void lookahead_route(flit *t_flit, int outport);
+    bool smart_bypass(int inport, flit *t_flit, int& outport);
+    bool has_local_request(int outport);
+    bool is_empty();
     void grant_switch(int inport, flit *t_flit);
     void schedule_wakeup(Cycles time);
 
@@ -102,6 +107,8 @@ class Router : public BasicRouter, public Consumer
     void regStats();
     void collateStats();
     void resetStats();
+    // activity counters so far, for NetworkEnergyModel
+    RouterActivity get_activity();
 
     // For Fault Model:
     bool get_fault_vector(int temperature, float fault_vector[]) {
@@ -119,6 +126,8 @@ class Router : public BasicRouter, public Consumer
     int get_numFreeVC(PortDirection dirn_);
     void vcStateDump();
     bool halt_;
+    // flits moved into this router by DRAIN spins
+    double m_drain_flits;
 
     int compute_hops_remaining(flit* flit_t);
 
@@ -143,6 +152,11 @@ class Router : public BasicRouter, public Consumer
 
     Stats::Scalar m_sw_input_arbiter_activity;
     Stats::Scalar m_sw_output_arbiter_activity;
+    Stats::Scalar m_sw_alloc_cycles;
+    Stats::Scalar m_sw_alloc_grants;
+    Stats::Scalar m_sw_alloc_max_grants;
+    Stats::Formula m_sw_alloc_match_size;
+    Stats::Formula m_sw_alloc_efficiency;
 
     Stats::Scalar m_crossbar_activity;
 };
@@ -46,6 +46,13 @@ RoutingUnit::RoutingUnit(Router *router)
     m_weight_table.clear();
 }
 
+void
+RoutingUnit::init()
+{
+    m_rng = m_router->get_net_ptr()->get_rng_stream(ROUTING_RNG_,
+                                                    m_router->get_id());
+}
+
 void
 RoutingUnit::addRoute(const NetDest& routing_table_entry)
 {
@@ -208,6 +215,11 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
 {
     int outport = -1;
 
+    // a multicast to several destinations follows the routing table,
+    // whatever the routing algorithm of the unicast packets
+    if (route.multicast && (route.dest_ni == -1))
+        return lookupRoutingTable(route.vnet, route.net_dest);
+
     if (route.dest_router == m_router->get_id()) {
 
         // Multiple NIs may be connected to this router,
@@ -235,6 +247,12 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
             outportComputeWestFirst(route, inport, inport_dirn); break;
         case ADAPT_WestFirst_: outport =
             outportComputeAdaptWestFirst(route, inport, inport_dirn); break;
+        case UP_DN_: outport =
+            outportComputeUpDown(route, inport, inport_dirn); break;
+        case ESCAPE_VC_UP_DN_: outport =
+            outportComputeEscapeVC(route, inport, inport_dirn); break;
+        case MIN_ADAPT_: outport =
+            outportComputeMinAdaptive(route, inport, inport_dirn); break;
         // any custom algorithm
         case CUSTOM_: outport =
             outportComputeCustom(route, inport, inport_dirn); break;
@@ -242,6 +260,11 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
             lookupRoutingTable(route.vnet, route.net_dest); break;
     }
 
+    // the mesh algorithms find no outport in the chosen direction
+    // when a link is missing in an irregular mesh
+    if (outport == -1)
+        outport = lookupRoutingTable(route.vnet, route.net_dest);
+
     assert(outport != -1);
     return outport;
 }
@@ -297,7 +320,7 @@ RoutingUnit::outportComputeXY(RouteInfo route,
         assert(0);
     }
 
-    return m_outports_dirn2idx[outport_dirn];
+    return get_outport(outport_dirn);
 }
 
 // Random Routing
@@ -345,20 +368,20 @@ RoutingUnit::outportComputeRandom(RouteInfo route,
     }
     else
     {
-        int rand = random() % 2;
+        int rand = m_rng.random(0, 1);
 
         if (x_dirn && y_dirn) // Quadrant I
-            outport_dirn = rand ? "East" : "North";
+            outport_dirn = pick_dirn("East", "North", rand);
         else if (!x_dirn && y_dirn) // Quadrant II
-            outport_dirn = rand ? "West" : "North";
+            outport_dirn = pick_dirn("West", "North", rand);
         else if (!x_dirn && !y_dirn) // Quadrant III
-            outport_dirn = rand ? "West" : "South";
+            outport_dirn = pick_dirn("West", "South", rand);
         else // Quadrant IV
-            outport_dirn = rand ? "East" : "South";
+            outport_dirn = pick_dirn("East", "South", rand);
 
     }
 
-    return m_outports_dirn2idx[outport_dirn];
+    return get_outport(outport_dirn);
 }
 
 // Adaptive random routing algorithm...
@@ -407,81 +430,62 @@ RoutingUnit::outportComputeAdaptRand(RouteInfo route,
     else
     {
         // whichever router has more free VCs route there
-        int rand = random() % 2;
-        Router *router_Est, *router_Wst, *router_South, *router_Nrth;
+        // (a direction without a link has -1 free VCs)
+        int rand = m_rng.random(0, 1);
         if (x_dirn && y_dirn) {// Quadrant I
             // check for routers in both 'East' and 'North'
             // direction
-            router_Est = m_router->get_net_ptr()->\
-                get_upstreamrouter( "East", m_router->get_id());
-            router_Nrth = m_router->get_net_ptr()->\
-                get_upstreamrouter( "North", m_router->get_id());
-            int freeVC_East = router_Est->get_numFreeVC("West");
-            int freeVC_North = router_Nrth->get_numFreeVC("South");
+            int freeVC_East = numFreeVC("East");
+            int freeVC_North = numFreeVC("North");
 
             if (freeVC_East > freeVC_North)
                 outport_dirn = "East";
             else if (freeVC_North > freeVC_East)
                 outport_dirn = "North";
             else
-                outport_dirn = rand ? "East" : "North";
+                outport_dirn = pick_dirn("East", "North", rand);
 
         }
         else if (!x_dirn && y_dirn) {// Quadrant II
 
-            router_Wst = m_router->get_net_ptr()->\
-                get_upstreamrouter( "West", m_router->get_id());
-            router_Nrth = m_router->get_net_ptr()->\
-                get_upstreamrouter( "North", m_router->get_id());
-
-            int freeVC_West = router_Wst->get_numFreeVC("East");
-            int freeVC_North = router_Nrth->get_numFreeVC("South");
+            int freeVC_West = numFreeVC("West");
+            int freeVC_North = numFreeVC("North");
 
             if (freeVC_North > freeVC_West)
                 outport_dirn = "North";
             else if (freeVC_West > freeVC_North)
                 outport_dirn = "West";
             else
-                outport_dirn = rand ? "West" : "North";
+                outport_dirn = pick_dirn("West", "North", rand);
 
         }
         else if (!x_dirn && !y_dirn) {// Quadrant III
 
-            router_Wst = m_router->get_net_ptr()->\
-                get_upstreamrouter( "West", m_router->get_id());
-            router_South = m_router->get_net_ptr()->\
-                get_upstreamrouter( "South", m_router->get_id());
-
-            int freeVC_West = router_Wst->get_numFreeVC("East");
-            int freeVC_South = router_South->get_numFreeVC("North");
+            int freeVC_West = numFreeVC("West");
+            int freeVC_South = numFreeVC("South");
 
             if (freeVC_South > freeVC_West)
                 outport_dirn = "South";
             else if (freeVC_West > freeVC_South)
                 outport_dirn = "West";
             else
-                outport_dirn = rand ? "West" : "South";
+                outport_dirn = pick_dirn("West", "South", rand);
         }
         else {// Quadrant IV
 
-            router_Est = m_router->get_net_ptr()->\
-                get_upstreamrouter( "East", m_router->get_id());
-            router_South = m_router->get_net_ptr()->\
-                get_upstreamrouter( "South", m_router->get_id());
-
-            int freeVC_East = router_Est->get_numFreeVC("West");
-            int freeVC_South = router_South->get_numFreeVC("North");
+            int freeVC_East = numFreeVC("East");
+            int freeVC_South = numFreeVC("South");
 
             if (freeVC_South > freeVC_East)
                 outport_dirn = "South";
             else if (freeVC_East > freeVC_South)
                 outport_dirn = "East";
             else
-                outport_dirn = rand ? "East" : "South";
+                outport_dirn = pick_dirn("East", "South", rand);
         }
     }
 
-    return m_outports_dirn2idx[outport_dirn];
+    return get_outport(outport_dirn);
 }
 
 // West-First routing algorithm...
@@ -513,7 +517,7 @@ RoutingUnit::outportComputeWestFirst(RouteInfo route,
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
 
-    int rand = random() % 2;
+    int rand = m_rng.random(0, 1);
 
     if (x_hops == 0)
     {
@@ -535,14 +539,14 @@ RoutingUnit::outportComputeWestFirst(RouteInfo route,
     }
     else if (y_dirn)
     {
-        outport_dirn = rand ? "East" : "North";
+        outport_dirn = pick_dirn("East", "North", rand);
     }
     else if (!(y_dirn))
     {
-        outport_dirn = rand ? "East" : "South";
+        outport_dirn = pick_dirn("East", "South", rand);
     }
 
-    return m_outports_dirn2idx[outport_dirn];
+    return get_outport(outport_dirn);
 
 }
 
@@ -575,8 +579,7 @@ RoutingUnit::outportComputeAdaptWestFirst(RouteInfo route,
 
     // already checked that in outportCompute() function
     assert(!(x_hops == 0 && y_hops == 0));
-    int rand = random() % 2;
-    Router *router_Est, *router_South, *router_Nrth;
+    int rand = m_rng.random(0, 1);
 
     if (x_hops == 0)
     {
@@ -598,52 +601,45 @@ RoutingUnit::outportComputeAdaptWestFirst(RouteInfo route,
     }
     else if (y_dirn)
     {
-        router_Est = m_router->get_net_ptr()->\
-            get_upstreamrouter( "East", m_router->get_id());
-        router_Nrth = m_router->get_net_ptr()->\
-            get_upstreamrouter( "North", m_router->get_id());
-        int freeVC_East = router_Est->get_numFreeVC("West");
-        int freeVC_North = router_Nrth->get_numFreeVC("South");
+        int freeVC_East = numFreeVC("East");
+        int freeVC_North = numFreeVC("North");
 
         if (freeVC_East > freeVC_North)
             outport_dirn = "East";
         else if (freeVC_North > freeVC_East)
             outport_dirn = "North";
         else
-            outport_dirn = rand ? "East" : "North";
+            outport_dirn = pick_dirn("East", "North", rand);
     }
     else if (!(y_dirn))
     {
-        router_Est = m_router->get_net_ptr()->\
-            get_upstreamrouter( "East", m_router->get_id());
-        router_South = m_router->get_net_ptr()->\
-            get_upstreamrouter( "South", m_router->get_id());
-
-        int freeVC_East = router_Est->get_numFreeVC("West");
-        int freeVC_South = router_South->get_numFreeVC("North");
+        int freeVC_East = numFreeVC("East");
+        int freeVC_South = numFreeVC("South");
 
         if (freeVC_South > freeVC_East)
             outport_dirn = "South";
         else if (freeVC_East > freeVC_South)
             outport_dirn = "East";
         else
-            outport_dirn = rand ? "East" : "South";
+            outport_dirn = pick_dirn("East", "South", rand);
 
     }
 
-    return m_outports_dirn2idx[outport_dirn];
+    return get_outport(outport_dirn);
 
 }
 
+// Free VCs at the input port of the downstream router in 'dirn_';
+// -1 if this router has no link in that direction (irregular mesh).
 int
 RoutingUnit::numFreeVC(PortDirection dirn_/*outport_dirn of this router*/)
 {
     Router* downstreamRouter;
     downstreamRouter = m_router->get_net_ptr()->\
-            get_upstreamrouter( dirn_, m_router->get_id());
+            get_neighbor_router(m_router->get_id(), dirn_);
 
     if (downstreamRouter == NULL)
-        return 0; // effectively there's no output-port in that dirn
+        return -1; // effectively there's no output-port in that dirn
 
     if( dirn_ == "North")
             return (downstreamRouter->get_numFreeVC("South"));
@@ -655,8 +651,222 @@ RoutingUnit::numFreeVC(PortDirection dirn_/*outport_dirn of this router*/)
         return (downstreamRouter->get_numFreeVC("North"));
     else
         assert(0); // shouldn't come here..
+    return -1;
+}
+
+// Outport in direction 'dirn'; -1 if there is none.
+int
+RoutingUnit::get_outport(PortDirection dirn)
+{
+    std::map<PortDirection, int>::iterator it =
+        m_outports_dirn2idx.find(dirn);
+    if (it == m_outports_dirn2idx.end())
+        return -1;
+    return it->second;
+}
+
+// 'a' if 'pick_a' else 'b', unless there is no link in that direction
+PortDirection
+RoutingUnit::pick_dirn(PortDirection a, PortDirection b, bool pick_a)
+{
+    if (pick_a)
+        return (get_outport(a) != -1) ? a : b;
+    return (get_outport(b) != -1) ? b : a;
+}
+
+// Up*/Down* routing on any topology.
+// Each link is oriented by the BFS spanning tree computed at init; a
+// packet may take any number of up links followed by down links, but
+// never an up link after a down link. Whether the packet is already
+// in its down phase only depends on the link it arrived over.
+// Among the outports on a shortest legal path, the one with the most
+// free vcs is taken.
+int
+RoutingUnit::outportComputeUpDown(RouteInfo route,
+                                  int inport,
+                                  PortDirection inport_dirn)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int my_id = m_router->get_id();
+    int upstream_id = net_ptr->get_link_src(my_id, inport);
+
+    bool down_phase = (upstream_id != -1) &&
+                      !net_ptr->is_up_link(upstream_id, my_id);
+
+    // a packet moved onto a down link by a DRAIN spin may not reach
+    // its destination over down links anymore; it then starts over
+    if (down_phase && (net_ptr->get_updn_dist(my_id, route.dest_router,
+                                              true) == INFINITE_)) {
+        down_phase = false;
+    }
+
+    return updown_outport(route, down_phase);
+}
+
+int
+RoutingUnit::outportComputeUpDownRestart(RouteInfo route)
+{
+    return updown_outport(route, false);
+}
+
+int
+RoutingUnit::updown_outport(RouteInfo route, bool down_phase)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int my_id = m_router->get_id();
+    int dest_id = route.dest_router;
+
+    int min_dist = INFINITE_;
+    std::vector<int> candidates;
+    for (int outport = 0; outport < m_router->get_num_outports();
+         outport++) {
+        int next_id = net_ptr->get_link_dest(my_id, outport);
+        if (next_id == -1)
+            continue;
+
+        bool up = net_ptr->is_up_link(my_id, next_id);
+        if (down_phase && up)
+            continue;
+
+        // after an up link anything is allowed; after a
+        // down link only down links are
+        int dist = net_ptr->get_updn_dist(next_id, dest_id, !up);
+        if (dist == INFINITE_)
+            continue;
+
+        if (dist < min_dist) {
+            min_dist = dist;
+            candidates.clear();
+        }
+        if (dist == min_dist)
+            candidates.push_back(outport);
+    }
+
+    assert(!candidates.empty());
+    return select_outport(candidates, route.vnet);
+}
+
+// Escape-VC routing: minimal adaptive routing on the normal vcs, and
+// up*/down* routing on the escape vc (vc-0 of each vnet) which a
+// packet falls back to when no normal vc is free at its outport (see
+// SwitchAllocator::get_request_outport()).
+int
+RoutingUnit::outportComputeEscapeVC(RouteInfo route,
+                                    int inport,
+                                    PortDirection inport_dirn)
+{
+    if (route.escape_vc)
+        return outportComputeUpDown(route, inport, inport_dirn);
+
+    return outportComputeMinAdaptive(route, inport, inport_dirn);
+}
+
+// Minimal adaptive routing on the hop-distance table: any outport
+// whose downstream router is one hop closer to the destination.
+int
+RoutingUnit::outportComputeMinAdaptive(RouteInfo route,
+                                       int inport,
+                                       PortDirection inport_dirn)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int my_id = m_router->get_id();
+    int dest_id = route.dest_router;
+    int my_dist = net_ptr->get_hop_dist(my_id, dest_id);
+
+    std::vector<int> candidates;
+    for (int outport = 0; outport < m_router->get_num_outports();
+         outport++) {
+        int next_id = net_ptr->get_link_dest(my_id, outport);
+        if ((next_id != -1) &&
+            (net_ptr->get_hop_dist(next_id, dest_id) == my_dist - 1)) {
+            candidates.push_back(outport);
+        }
+    }
+
+    assert(!candidates.empty());
+    return select_outport(candidates, route.vnet);
+}
+
+// Deflection routing on the hop-distance table (any topology): a
+// free outport one hop closer to the destination, or the outport to
+// the destination NI if it has a free vc; otherwise any free link to
+// another router (a deflection). Ties are broken randomly.
+int
+RoutingUnit::outportComputeDeflection(RouteInfo route,
+                                      const std::vector<bool>& taken,
+                                      bool& deflected)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    int my_id = m_router->get_id();
+    int dest_id = route.dest_router;
+    std::vector<int> candidates;
+    deflected = false;
+
+    if (dest_id == my_id) {
+        int outport = lookupRoutingTable(route.vnet, route.net_dest);
+        if (!taken[outport] &&
+            m_router->get_outputUnit_ref()[outport]->has_free_vc(
+                route.vnet)) {
+            return outport;
+        }
+    } else {
+        int my_dist = net_ptr->get_hop_dist(my_id, dest_id);
+        for (int outport = 0; outport < m_router->get_num_outports();
+             outport++) {
+            int next_id = net_ptr->get_link_dest(my_id, outport);
+            if ((next_id != -1) && !taken[outport] &&
+                (net_ptr->get_hop_dist(next_id, dest_id) < my_dist)) {
+                candidates.push_back(outport);
+            }
+        }
+    }
+
+    if (candidates.empty()) {
+        deflected = true;
+        for (int outport = 0; outport < m_router->get_num_outports();
+             outport++) {
+            if ((net_ptr->get_link_dest(my_id, outport) != -1) &&
+                !taken[outport]) {
+                candidates.push_back(outport);
+            }
+        }
+        if (candidates.empty())
+            return -1;
+    }
+
+    if (candidates.size() == 1)
+        return candidates[0];
+    return candidates[m_rng.random(0, candidates.size() - 1)];
 }
 
+// Pick the candidate outport with the most free vcs in 'vnet' at
+// the downstream router (as tracked by our output unit), then the
+// most credits in 'vnet'; remaining ties are broken randomly.
+int
+RoutingUnit::select_outport(const std::vector<int>& candidates, int vnet)
+{
+    int max_free = -1;
+    int max_credits = -1;
+    std::vector<int> best;
+    for (int i = 0; i < candidates.size(); i++) {
+        OutputUnit *output_unit =
+            m_router->get_outputUnit_ref()[candidates[i]];
+        int free_vcs = output_unit->getNumFreeVCs(vnet);
+        int credits = output_unit->getNumCredits(vnet);
+        if ((free_vcs > max_free) ||
+            ((free_vcs == max_free) && (credits > max_credits))) {
+            max_free = free_vcs;
+            max_credits = credits;
+            best.clear();
+        }
+        if ((free_vcs == max_free) && (credits == max_credits))
+            best.push_back(candidates[i]);
+    }
+
+    if (best.size() == 1)
+        return best[0];
+    return best[m_rng.random(0, best.size() - 1)];
+}
 
 // Template for implementing custom routing algorithm
 // using port directions. (Example adaptive)
@@ -47,6 +47,7 @@ class RoutingUnit
 {
   public:
     RoutingUnit(Router *router);
+    void init();
     int outportCompute(RouteInfo route,
                       int inport,
                       PortDirection inport_dirn);
@@ -59,6 +60,9 @@ class RoutingUnit
     int  lookupRoutingTable(int vnet, NetDest net_dest);
     std::vector<int> lookupRoutingTable_pref_outport(
                                 int vnet, NetDest msg_destination);
+    // destinations of 'net_dest' reached through 'outport'
+    NetDest branchDestinations(int outport, const NetDest& net_dest)
+    { return net_dest.AND(m_routing_table[outport]); }
 
     // Topology-specific direction based routing
     void addInDirection(PortDirection inport_dirn, int inport);
@@ -88,17 +92,35 @@ class RoutingUnit
                          int inport,
                          PortDirection inport_dirn);
 
-    int
-    outportComputeXY_Deflection(RouteInfo route,
-                         int inport,
-                         PortDirection inport_dirn);
+    // Bufferless deflection routing: outport for 'route' among the
+    // outports not 'taken' yet this cycle; sets 'deflected' when
+    // no productive one is left. -1 if every link is taken.
+    int outportComputeDeflection(RouteInfo route,
+                                 const std::vector<bool>& taken,
+                                 bool& deflected);
 
+    // Topology-agnostic routing on the distance tables
+    // built by GarnetNetwork::init_routing_tables()
+    int outportComputeUpDown(RouteInfo route,
+                             int inport,
+                             PortDirection inport_dirn);
+    int outportComputeEscapeVC(RouteInfo route,
+                               int inport,
+                               PortDirection inport_dirn);
+    int outportComputeMinAdaptive(RouteInfo route,
+                                  int inport,
+                                  PortDirection inport_dirn);
+    // up*/down* outport for a packet starting a new legal path
+    // here (e.g., when it moves to the escape vc)
+    int outportComputeUpDownRestart(RouteInfo route);
 
     // Custom Routing Algorithm using Port Directions
     int outportComputeCustom(RouteInfo route,
                              int inport,
                              PortDirection inport_dirn);
     int numFreeVC(PortDirection dirn);
+    // outport in direction 'dirn'; -1 if there is no link
+    int get_outport(PortDirection dirn);
 
   public:
     // Inport and Outport direction to idx maps
@@ -108,7 +130,13 @@ class RoutingUnit
     std::map<PortDirection, int> m_outports_dirn2idx;
 
   private:
+    int updown_outport(RouteInfo route, bool down_phase);
+    int select_outport(const std::vector<int>& candidates, int vnet);
+    PortDirection pick_dirn(PortDirection a, PortDirection b, bool pick_a);
+
     Router *m_router;
+    // per-router random stream for adaptive tie-breaks
+    CounterRNG m_rng;
 
     // Routing Table
     std::vector<NetDest> m_routing_table;
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/SharedCreditPool.hh"
+
+#include <algorithm>
+#include <cassert>
+
+SharedCreditPool::SharedCreditPool(int num_vcs, int num_slots, int reserved)
+    : m_reserved(reserved), m_shared_slots(num_slots - num_vcs * reserved),
+      m_shared_used(0), m_occupancy(num_vcs, 0)
+{
+    assert(reserved >= 1);
+    assert(m_shared_slots >= 0);
+}
+
+int
+SharedCreditPool::get_credit_count(int vc) const
+{
+    return (std::max(m_reserved - m_occupancy[vc], 0) +
+            std::max(m_shared_slots - m_shared_used, 0));
+}
+
+void
+SharedCreditPool::decrement_credit(int vc)
+{
+    if (m_occupancy[vc] >= m_reserved)
+        m_shared_used++;
+    m_occupancy[vc]++;
+}
+
+void
+SharedCreditPool::increment_credit(int vc)
+{
+    m_occupancy[vc]--;
+    assert(m_occupancy[vc] >= 0);
+    if (m_occupancy[vc] >= m_reserved)
+        m_shared_used--;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_SHAREDCREDITPOOL_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_SHAREDCREDITPOOL_HH__
+
+#include <vector>
+
+// Credits of a shared (DAMQ) input port, as tracked upstream: the
+// port has one pool of 'num_slots' flit buffers, of which 'reserved'
+// are kept for each vc (so that every vc can always make progress)
+// and the rest are taken by any vc on demand. A flit sent to a vc
+// which already holds 'reserved' flits takes a shared slot, which is
+// returned with the credit of a flit leaving such a vc.
+class SharedCreditPool
+{
+  public:
+    SharedCreditPool(int num_vcs, int num_slots, int reserved);
+
+    bool
+    has_credit(int vc) const
+    {
+        return ((m_occupancy[vc] < m_reserved) ||
+                (m_shared_used < m_shared_slots));
+    }
+    // free slots 'vc' may take
+    int get_credit_count(int vc) const;
+    // a flit is sent to, or has left, 'vc'
+    void decrement_credit(int vc);
+    void increment_credit(int vc);
+
+  private:
+    int m_reserved;
+    int m_shared_slots;
+    // shared slots in use; a DRAIN spin moves packets whatever the
+    // credits and may overcommit the pool for a while
+    int m_shared_used;
+    std::vector<int> m_occupancy; // flits held by each vc
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_SHAREDCREDITPOOL_HH__
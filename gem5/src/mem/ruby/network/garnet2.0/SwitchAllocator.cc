@@ -33,6 +33,8 @@
 
 #include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
 
+#include <algorithm>
+
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
@@ -49,7 +51,16 @@ SwitchAllocator::SwitchAllocator(Router *router)
 
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
+    m_alloc_cycles = 0;
+    m_alloc_grants = 0;
+    m_alloc_max_grants = 0;
     m_requested_uturn = false;
+    m_arbiter = nullptr;
+}
+
+SwitchAllocator::~SwitchAllocator()
+{
+    delete m_arbiter;
 }
 
 void
@@ -60,32 +71,59 @@ SwitchAllocator::init()
 
     m_num_inports = m_router->get_num_inports();
     m_num_outports = m_router->get_num_outports();
-    m_round_robin_inport.resize(m_num_outports);
     m_round_robin_invc.resize(m_num_inports);
-    m_port_requests.resize(m_num_outports);
-    m_vc_winners.resize(m_num_outports);
+    m_requested_outports.resize(m_num_inports);
+    m_inport_matched.resize(m_num_inports);
+    m_outport_requested.resize(m_num_outports);
+    m_matched_inport.resize(m_num_outports);
+    m_outport_visited.resize(m_num_outports);
 
     for (int i = 0; i < m_num_inports; i++) {
         m_round_robin_invc[i] = 0;
     }
 
+    m_speedup = 1;
+    m_inport_width.resize(m_num_inports);
+    m_inport_grants.resize(m_num_inports);
+    for (int i = 0; i < m_num_inports; i++) {
+        m_inport_width[i] = m_input_unit[i]->get_in_link()
+            ->getFlitsPerCycle();
+        m_speedup = std::max(m_speedup, m_inport_width[i]);
+    }
+    m_outport_width.resize(m_num_outports);
+    m_outport_grants.resize(m_num_outports);
     for (int i = 0; i < m_num_outports; i++) {
-        m_port_requests[i].resize(m_num_inports);
-        m_vc_winners[i].resize(m_num_inports);
-
-        m_round_robin_inport[i] = 0;
+        m_outport_width[i] = m_output_unit[i]->m_out_link
+            ->getFlitsPerCycle();
+        m_speedup = std::max(m_speedup, m_outport_width[i]);
+    }
 
-        for (int j = 0; j < m_num_inports; j++) {
-            m_port_requests[i][j] = false; // [outport][inport]
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    if (net_ptr->isDeflectionEnabled()) {
+        // every flit arriving must leave the next cycle
+        bool one_flit_wide = (m_speedup == 1);
+        for (int i = 0; i < m_num_outports; i++) {
+            one_flit_wide &= (m_output_unit[i]->m_out_link
+                              ->getSerializationCycles() == 1);
         }
+        if (!one_flit_wide)
+            fatal("Deflection routing needs links one flit wide "
+                  "(router %d)\n", m_router->get_id());
     }
+
+    m_arbiter = SwitchArbiter::create(net_ptr->getSwAllocator(),
+        m_num_inports, m_num_outports, net_ptr->getIslipIterations());
 }
 
 /*
  * The wakeup function of the SwitchAllocator performs a 2-stage
- * seperable switch allocation. At the end of the 2nd stage, a free
- * output VC is assigned to the winning flits of each output port.
+ * switch allocation (separable by default, see SwitchArbiter). At the
+ * end of the 2nd stage, a free output VC is assigned to the winning
+ * flits of each output port.
  * There is no separate VCAllocator stage like the one in garnet1.0.
+ * Ports on links wider than a flit may send several flits per cycle:
+ * the allocation is then repeated (up to the widest link, in flits)
+ * for the ports with bandwidth left.
  * At the end of this function, the router is rescheduled to wakeup
  * next cycle for peforming SA for any flits ready next cycle.
  */
@@ -93,8 +131,22 @@ SwitchAllocator::init()
 void
 SwitchAllocator::wakeup()
 {
-    arbitrate_inports(); // First stage of allocation
-    arbitrate_outports(); // Second stage of allocation
+    if (m_router->get_net_ptr()->isDeflectionEnabled()) {
+        arbitrate_deflection();
+        check_for_wakeup();
+        return;
+    }
+
+    std::fill(m_inport_grants.begin(), m_inport_grants.end(), 0);
+    std::fill(m_outport_grants.begin(), m_outport_grants.end(), 0);
+    for (int round = 0; round < m_speedup; round++) {
+        if (round > 0)
+            clear_request_vector();
+        arbitrate_inports(); // First stage of allocation
+        arbitrate_outports(); // Second stage of allocation
+    }
+    if (m_router->get_net_ptr()->isRouterBypassEnabled())
+        end_bypass();
 
     clear_request_vector();
     check_for_wakeup();
@@ -102,12 +154,14 @@ SwitchAllocator::wakeup()
 
 /*
  * SA-I (or SA-i) loops through all input VCs at every input port,
- * and selects one in a round robin manner.
+ * in a round robin manner.
  *    - For HEAD/HEAD_TAIL flits only selects an input VC whose output port
  *     has at least one free output VC.
  *    - For BODY/TAIL flits, only selects an input VC that has credits
  *      in its output VC.
- * Places a request for the output port from this input VC.
+ * Places a request for the output port from this input VC. The
+ * separable allocator takes the first one of each input port; the
+ * others (see SwitchArbiter) take every request.
  */
 
 void
@@ -118,10 +172,20 @@ SwitchAllocator::arbitrate_inports()
     if( m_router->halt_ == true ) {
         return;
     }
-    // Select a VC from each input in a round robin manner
-    // Independent arbiter at each input port
+    bool one_request = m_arbiter->one_request_per_inport();
     for (int inport = 0; inport < m_num_inports; inport++) {
+        if (m_inport_grants[inport] >= m_inport_width[inport])
+            continue;
+
+        // starving flits (see GarnetNetwork::is_escalated()) are
+        // picked ahead of the round robin order
+        if (m_router->get_net_ptr()->isEscalationEnabled() &&
+            arbitrate_escalated_invc(inport)) {
+            continue;
+        }
+
         int invc = m_round_robin_invc[inport];
+        bool requested = false;
 
         for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
                 // condition below automatically takes care if there's
@@ -130,32 +194,16 @@ SwitchAllocator::arbitrate_inports()
             if (m_input_unit[inport]->need_stage(invc, SA_,
                 m_router->curCycle())) {
 
-                m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn = false;
-                if ((m_input_unit[inport]->peekTopFlit(invc)->get_outport_dir()
-                        == m_input_unit[inport]->get_direction()) &&
-                    (m_input_unit[inport]->get_direction() != "Local")) {
-
-                        // update the stats:
-                        m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn = true;
-                        m_router->get_net_ptr()->m_total_uturn_request++;
-
-                        // deflect this flit here:
-                        if (m_router->get_net_ptr()->m_uTurn_crossbar == 0) {
-                            PortDirection dirn_ = m_input_unit[inport]->get_direction();
-                            disallow_uturn(inport, invc, dirn_);
-                        }
-                }
                 // This flit is in SA stage
-
-                int outport =
-                        m_input_unit[inport]->peekTopFlit(invc)->get_outport();
+                int outport = get_request_outport(inport, invc);
 
                 if(outport >= m_output_unit.size()) {
                     fatal("outport: %d >= m_output_unit.size(): %d\n",
                             outport, m_output_unit.size());
                 }
 
-                int outvc = -1;
+                // body/tail flits reuse the outvc of their head flit
+                int outvc = m_input_unit[inport]->get_outvc(invc);
 
                 // check if the flit in this InputVC is allowed to be sent
                 // send_allowed conditions described in that function.
@@ -163,11 +211,15 @@ SwitchAllocator::arbitrate_inports()
                     send_allowed(inport, invc, outport, outvc);
 
                 if (make_request) {
-                    m_input_arbiter_activity++;
-                    m_port_requests[outport][inport] = true;
-                    m_vc_winners[outport][inport]= invc;
-
-                    break; // got one vc winner for this port
+                    if (!requested)
+                        m_input_arbiter_activity++;
+                    requested = true;
+                    m_requests.push_back(SwitchRequest(inport, invc, outport,
+                        m_input_unit[inport]->peekTopFlit(invc)
+                            ->get_enqueue_time(), false));
+
+                    if (one_request)
+                        break; // got one vc winner for this port
                 }
             }
 
@@ -178,10 +230,187 @@ SwitchAllocator::arbitrate_inports()
     }
 }
 
+// Update the u-turn stats for the flit at the head of 'invc' and,
+// if u-turns are not allowed, deflect it to another outport.
+void
+SwitchAllocator::check_uturn(int inport, int invc)
+{
+    m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn = false;
+    if ((m_input_unit[inport]->peekTopFlit(invc)->get_outport_dir()
+            == m_input_unit[inport]->get_direction()) &&
+        (m_input_unit[inport]->get_direction() != "Local")) {
+
+            // update the stats:
+            m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn = true;
+            m_router->get_net_ptr()->m_total_uturn_request++;
+
+            // deflect this flit here:
+            if (m_router->get_net_ptr()->m_uTurn_crossbar == 0) {
+                PortDirection dirn_ = m_input_unit[inport]->get_direction();
+                disallow_uturn(inport, invc, dirn_);
+            }
+    }
+}
+
+// Outport requested by the flit at the head of 'invc'. A head flit
+// carries its own (possibly u-turn deflected) outport; body and tail
+// flits follow the outport granted to their head flit.
+// With escape-VC routing, a head flit that finds no free normal vc
+// at its outport moves to the escape vc of its up*/down* outport,
+// if that one is free, and stays on escape vcs from then on.
+int
+SwitchAllocator::get_request_outport(int inport, int invc)
+{
+    if (m_input_unit[inport]->get_outvc(invc) != -1)
+        return m_input_unit[inport]->get_outport(invc);
+
+    check_uturn(inport, invc);
+    flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+    int outport = t_flit->get_outport();
+
+    if ((m_router->get_net_ptr()->getRoutingAlgorithm() ==
+            ESCAPE_VC_UP_DN_) &&
+        !t_flit->get_route().escape_vc &&
+        (m_output_unit[outport]->get_direction() != "Local")) {
+        int vnet = get_vnet(invc);
+        if (!m_output_unit[outport]->has_free_vc(vnet, 1,
+                                                 m_vc_per_vnet - 1)) {
+            int escape_outport = m_router->m_routing_unit
+                ->outportComputeUpDownRestart(t_flit->get_route());
+            if (m_output_unit[escape_outport]->has_free_vc(vnet, 0, 1)) {
+                t_flit->m_route.escape_vc = true;
+                t_flit->set_outport(escape_outport);
+                t_flit->set_outport_dir(
+                    m_output_unit[escape_outport]->get_direction());
+                m_router->get_net_ptr()->m_escape_vc_pkts++;
+                outport = escape_outport;
+            }
+        }
+    }
+
+    return outport;
+}
+
+// Output vcs [first, first + num) of its vnet a head flit may be
+// allocated. With escape-VC routing, vc-0 of each vnet is the escape
+// vc and only packets that moved to it get it; packets leaving to a
+// network interface may use any vc.
+void
+SwitchAllocator::get_vc_range(int inport, int invc, int outport,
+                              int& first, int& num)
+{
+    first = 0;
+    num = m_vc_per_vnet;
+
+    if ((m_router->get_net_ptr()->getRoutingAlgorithm() !=
+            ESCAPE_VC_UP_DN_) ||
+        (m_output_unit[outport]->get_direction() == "Local"))
+        return;
+
+    if (m_input_unit[inport]->peekTopFlit(invc)->get_route().escape_vc) {
+        num = 1;
+    } else {
+        first = 1;
+        num = m_vc_per_vnet - 1;
+    }
+}
+
+// Place a request on behalf of an escalated flit at this inport,
+// if there is one that can be sent. Returns true if a request
+// was placed.
+bool
+SwitchAllocator::arbitrate_escalated_invc(int inport)
+{
+    for (int invc = 0; invc < m_num_vcs; invc++) {
+        if (!m_input_unit[inport]->need_stage(invc, SA_,
+                                              m_router->curCycle()))
+            continue;
+        if (!m_router->get_net_ptr()->is_escalated(
+                m_input_unit[inport]->peekTopFlit(invc)))
+            continue;
+
+        int outport = get_request_outport(inport, invc);
+        int outvc = m_input_unit[inport]->get_outvc(invc);
+
+        if (send_allowed(inport, invc, outport, outvc)) {
+            m_input_arbiter_activity++;
+            m_requests.push_back(SwitchRequest(inport, invc, outport,
+                m_input_unit[inport]->peekTopFlit(invc)->get_enqueue_time(),
+                true));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Size of a maximum matching of the requesting inports to their
+// requested outports. The grants are a matching already: it is grown
+// by augmenting paths from the requesting inports left unmatched.
+int
+SwitchAllocator::max_matching_size()
+{
+    for (int inport = 0; inport < m_num_inports; inport++)
+        m_requested_outports[inport].clear();
+    std::fill(m_outport_requested.begin(), m_outport_requested.end(),
+              false);
+    int num_inports = 0, num_outports = 0;
+    for (int i = 0; i < m_requests.size(); i++) {
+        std::vector<int>& outports =
+            m_requested_outports[m_requests[i].inport];
+        if (outports.empty())
+            num_inports++;
+        outports.push_back(m_requests[i].outport);
+        if (!m_outport_requested[m_requests[i].outport]) {
+            m_outport_requested[m_requests[i].outport] = true;
+            num_outports++;
+        }
+    }
+
+    int size = m_grants.size();
+    if (size == std::min(num_inports, num_outports))
+        return size;
+
+    std::fill(m_matched_inport.begin(), m_matched_inport.end(), -1);
+    std::fill(m_inport_matched.begin(), m_inport_matched.end(), false);
+    for (int i = 0; i < m_grants.size(); i++) {
+        m_matched_inport[m_grants[i].outport] = m_grants[i].inport;
+        m_inport_matched[m_grants[i].inport] = true;
+    }
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        if (m_inport_matched[inport] || m_requested_outports[inport].empty())
+            continue;
+        std::fill(m_outport_visited.begin(), m_outport_visited.end(),
+                  false);
+        if (augment_matching(inport))
+            size++;
+    }
+    return size;
+}
+
+// Look for a path from 'inport' to an unmatched outport that
+// alternates between unmatched and matched requests, and flip it.
+bool
+SwitchAllocator::augment_matching(int inport)
+{
+    const std::vector<int>& outports = m_requested_outports[inport];
+    for (int i = 0; i < outports.size(); i++) {
+        int outport = outports[i];
+        if (m_outport_visited[outport])
+            continue;
+        m_outport_visited[outport] = true;
+        if ((m_matched_inport[outport] == -1) ||
+            augment_matching(m_matched_inport[outport])) {
+            m_matched_inport[outport] = inport;
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
- * SA-II (or SA-o) loops through all output ports,
- * and selects one input VC (that placed a request during SA-I)
- * as the winner for this output port in a round robin manner.
+ * SA-II (or SA-o) matches the requests placed during SA-I to the
+ * output ports (see SwitchArbiter): at most one input VC wins each
+ * output port and each input port.
  *      - For HEAD/HEAD_TAIL flits, performs simplified outvc allocation.
  *        (i.e., select a free VC from the output port).
  *      - For BODY/TAIL flits, decrement a credit in the output vc.
@@ -198,122 +427,333 @@ SwitchAllocator::arbitrate_outports()
     if( m_router->halt_ == true ) {
         return;
     }
-    // Now there are a set of input vc requests for output vcs.
-    // Again do round robin arbitration on these requests
-    // Independent arbiter at each output port
-    for (int outport = 0; outport < m_num_outports; outport++) {
-        int inport = m_round_robin_inport[outport];
-
-        for (int inport_iter = 0; inport_iter < m_num_inports;
-                 inport_iter++) {
+    if (m_requests.empty())
+        return;
 
-            // inport has a request this cycle for outport
-            if (m_port_requests[outport][inport]) {
+    m_arbiter->allocate(m_requests, m_grants);
+
+    // matching quality: the grants against the largest matching the
+    // requests allowed
+    m_alloc_cycles++;
+    m_alloc_grants += m_grants.size();
+    m_alloc_max_grants += max_matching_size();
+
+    std::sort(m_grants.begin(), m_grants.end(),
+              [](const SwitchRequest& a, const SwitchRequest& b) {
+                  return (a.outport < b.outport);
+              });
+    for (int i = 0; i < m_grants.size(); i++) {
+        grant_request(m_grants[i].inport, m_grants[i].invc,
+                      m_grants[i].outport);
+    }
+}
 
-                // grant this outport to this inport
-                int invc = m_vc_winners[outport][inport];
+// Send the flit at the head of 'invc' of 'inport', which won
+// 'outport', through the switch.
+void
+SwitchAllocator::grant_request(int inport, int invc, int outport)
+{
+    m_inport_grants[inport]++;
+    m_outport_grants[outport]++;
+
+    // Update Round Robin pointer
+    m_round_robin_invc[inport]++;
+    if (m_round_robin_invc[inport] >= m_num_vcs)
+        m_round_robin_invc[inport] = 0;
+
+    int outvc = m_input_unit[inport]->get_outvc(invc);
+    if (outvc == -1) {
+        // VC Allocation - select any free VC from outport
+        outvc = vc_allocate(outport, inport, invc);
+        // the rest of the packet follows the head flit
+        m_input_unit[inport]->grant_outport(invc, outport);
+    }
 
-                // Update Round Robin pointer
-                m_round_robin_invc[inport]++;
-                if (m_round_robin_invc[inport] >= m_num_vcs)
-                    m_round_robin_invc[inport] = 0;
+    // this flit has won the SA; update the stats if it is doing
+    // making a u-turn
+    if ((m_input_unit[inport]->peekTopFlit(invc)->get_outport_dir()
+            == m_input_unit[inport]->get_direction()) &&
+        (m_input_unit[inport]->get_direction() != "Local")) {
+            assert(m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn == true);
+            m_router->get_net_ptr()->m_success_uturn++;
+            m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn = false; // uset it for next time.
+    }
+    // remove flit from Input VC; a multicast whose routes
+    // diverge here sends a copy and stays for its other
+    // branches
+    flit *t_flit = nullptr;
+    bool last_branch = true;
+    if (m_input_unit[inport]->peekTopFlit(invc)
+            ->get_route().multicast) {
+        t_flit = fork_multicast(inport, invc, outport);
+        last_branch = (t_flit == nullptr);
+    }
+    if (last_branch)
+        t_flit = m_input_unit[inport]->getTopFlit(invc);
+    assert(t_flit != nullptr);
+    DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
+                         "granted outvc %d at outport %d "
+                         "to invc %d at inport %d to flit %s at "
+                         "time: %lld\n",
+            m_router->get_id(), outvc,
+            m_router->getPortDirectionName(
+                m_output_unit[outport]->get_direction()),
+            invc,
+            m_router->getPortDirectionName(
+                m_input_unit[inport]->get_direction()),
+                *t_flit,
+            m_router->curCycle());
+
+
+    // Update outport field in the flit since this is
+    // used by CrossbarSwitch code to send it out of
+    // correct outport.
+    // Note: post route compute in InputUnit,
+    // outport is updated in VC, but not in flit
+    t_flit->set_outport(outport);
+    PortDirection dirn = m_output_unit[outport]->get_direction();
+    t_flit->set_outport_dir(dirn);
+
+    // lookahead routing: route the head flit at the next
+    // router now
+    if (m_router->get_net_ptr()->isLookaheadEnabled() &&
+        ((t_flit->get_type() == HEAD_) ||
+         (t_flit->get_type() == HEAD_TAIL_))) {
+        m_router->lookahead_route(t_flit, outport);
+    }
+    if (t_flit->m_bypass) {
+        m_router->get_net_ptr()->m_bypassed_flits++;
+        t_flit->m_bypass = false;
+    }
 
-                int outvc = m_input_unit[inport]->get_outvc(invc);
-                if (outvc == -1) {
-                    // VC Allocation - select any free VC from outport
-                    outvc = vc_allocate(outport, inport, invc);
-                }
+    // set outvc (i.e., invc for next hop) in flit
+    // (This was updated in VC by vc_allocate, but not in flit)
+    t_flit->set_vc(outvc);
+
+    // decrement credit in outvc
+    m_output_unit[outport]->decrement_credit(outvc);
+
+    // flit ready for Switch Traversal
+    t_flit->advance_stage(ST_, m_router->curCycle());
+    // This initializes the 'm_switch_buffer' vector of
+    // class CrossbarSwitch.
+    m_router->grant_switch(inport, t_flit);
+    // this is for stats
+    m_output_arbiter_activity++;
+
+    if (!last_branch) {
+        // the flit keeps its input vc (and buffer) for the
+        // remaining branches: no credit yet
+    } else if ((t_flit->get_type() == TAIL_) ||
+        t_flit->get_type() == HEAD_TAIL_) {
+
+        // This Input VC should now be empty
+        assert(!(m_input_unit[inport]->isReady(invc,
+            m_router->curCycle())));
+
+        // Free this VC
+        m_input_unit[inport]->set_vc_idle(invc,
+            m_router->curCycle());
+
+        // Send a credit back
+        // along with the information that this VC is now idle
+        m_input_unit[inport]->increment_credit(invc, true,
+            m_router->curCycle());
+    } else {
+        // Send a credit back
+        // but do not indicate that the VC is idle
+        m_input_unit[inport]->increment_credit(invc, false,
+            m_router->curCycle());
+    }
+}
 
-                // this flit has won the SA; update the stats if it is doing
-                // making a u-turn
-                if ((m_input_unit[inport]->peekTopFlit(invc)->get_outport_dir()
-                        == m_input_unit[inport]->get_direction()) &&
-                    (m_input_unit[inport]->get_direction() != "Local")) {
-                        assert(m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn == true);
-                        m_router->get_net_ptr()->m_success_uturn++;
-                        m_input_unit[inport]->peekTopFlit(invc)->m_request_uturn = false; // uset it for next time.
-                }
-                // remove flit from Input VC
-                flit *t_flit = m_input_unit[inport]->getTopFlit(invc);
-                assert(t_flit != nullptr);
-                DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
-                                     "granted outvc %d at outport %d "
-                                     "to invc %d at inport %d to flit %s at "
-                                     "time: %lld\n",
-                        m_router->get_id(), outvc,
-                        m_router->getPortDirectionName(
-                            m_output_unit[outport]->get_direction()),
-                        invc,
-                        m_router->getPortDirectionName(
-                            m_input_unit[inport]->get_direction()),
-                            *t_flit,
-                        m_router->curCycle());
-
-
-                // Update outport field in the flit since this is
-                // used by CrossbarSwitch code to send it out of
-                // correct outport.
-                // Note: post route compute in InputUnit,
-                // outport is updated in VC, but not in flit
-                t_flit->set_outport(outport);
-                PortDirection dirn = m_output_unit[outport]->get_direction();
-                t_flit->set_outport_dir(dirn);
-
-                // set outvc (i.e., invc for next hop) in flit
-                // (This was updated in VC by vc_allocate, but not in flit)
-                t_flit->set_vc(outvc);
-
-                // decrement credit in outvc
-                m_output_unit[outport]->decrement_credit(outvc);
-
-                // flit ready for Switch Traversal
-                t_flit->advance_stage(ST_, m_router->curCycle());
-                // This initializes the 'm_switch_buffer' vector of
-                // class CrossbarSwitch.
-                m_router->grant_switch(inport, t_flit);
-                // this is for stats
-                m_output_arbiter_activity++;
-
-                if ((t_flit->get_type() == TAIL_) ||
-                    t_flit->get_type() == HEAD_TAIL_) {
-
-                    // This Input VC should now be empty
-                    assert(!(m_input_unit[inport]->isReady(invc,
-                        m_router->curCycle())));
-
-                    // Free this VC
-                    m_input_unit[inport]->set_vc_idle(invc,
-                        m_router->curCycle());
-
-                    // Send a credit back
-                    // along with the information that this VC is now idle
-                    m_input_unit[inport]->increment_credit(invc, true,
-                        m_router->curCycle());
-                } else {
-                    // Send a credit back
-                    // but do not indicate that the VC is idle
-                    m_input_unit[inport]->increment_credit(invc, false,
-                        m_router->curCycle());
-                }
+// A flit on the bypass path which did not win the switch on arrival
+// goes through the normal router pipeline.
+void
+SwitchAllocator::end_bypass()
+{
+    Cycles curTime = m_router->curCycle();
+    Cycles wait_time = m_router->get_pipe_stages() - Cycles(1);
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        for (int invc = 0; invc < m_num_vcs; invc++) {
+            if (!m_input_unit[inport]->need_stage(invc, SA_, curTime))
+                continue;
+            flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+            if (t_flit->m_bypass) {
+                t_flit->m_bypass = false;
+                t_flit->advance_stage(SA_, curTime + wait_time);
+                m_router->schedule_wakeup(wait_time);
+            }
+        }
+    }
+}
 
-                // remove this request
-                m_port_requests[outport][inport] = false;
+// Priority of bufferless deflection routing: the oldest flit first,
+// in a total order (injection time, source NI, packet, flit) so that
+// the oldest flit in the network always moves towards its
+// destination and cannot livelock.
+static bool
+deflection_older(flit *a, flit *b)
+{
+    if (a->get_enqueue_time() != b->get_enqueue_time())
+        return (a->get_enqueue_time() < b->get_enqueue_time());
+    if (a->get_route().src_ni != b->get_route().src_ni)
+        return (a->get_route().src_ni < b->get_route().src_ni);
+    if (a->get_packet_id() != b->get_packet_id())
+        return (a->get_packet_id() < b->get_packet_id());
+    return (a->get_id() < b->get_id());
+}
 
-                // Update Round Robin pointer
-                m_round_robin_inport[outport]++;
-                if (m_round_robin_inport[outport] >= m_num_inports)
-                    m_round_robin_inport[outport] = 0;
+/*
+ * Bufferless deflection routing (BLESS-style), replacing SA-I/SA-II.
+ * Every flit that arrived on a network inport leaves this cycle: in
+ * age order, each takes a productive outport if one is still free,
+ * else any free link (see RoutingUnit::outportComputeDeflection()).
+ * The router has at least as many network outports as network
+ * inports (checked in GarnetNetwork::init()), so one is always left.
+ * A flit of each Local inport is then injected if an outport is
+ * still free. Network links use no vcs or credits; only the vcs
+ * between the router and its NIs keep their flow control.
+ */
+void
+SwitchAllocator::arbitrate_deflection()
+{
+    Cycles curTime = m_router->curCycle();
+    std::vector<std::pair<int, int> > arrived, injected;
 
-                break; // got a input winner for this outport
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        bool local = (m_input_unit[inport]->get_direction() == "Local");
+        for (int iter = 0; iter < m_num_vcs; iter++) {
+            int invc = m_round_robin_invc[inport] + iter;
+            if (invc >= m_num_vcs)
+                invc -= m_num_vcs;
+            if (!m_input_unit[inport]->need_stage(invc, SA_, curTime))
+                continue;
+            if (local) {
+                injected.push_back(std::make_pair(inport, invc));
+                break;
             }
+            arrived.push_back(std::make_pair(inport, invc));
+        }
+    }
 
-            inport++;
-            if (inport >= m_num_inports)
-                inport = 0;
+    std::sort(arrived.begin(), arrived.end(),
+              [this](const std::pair<int, int>& a,
+                     const std::pair<int, int>& b) {
+                  return deflection_older(
+                      m_input_unit[a.first]->peekTopFlit(a.second),
+                      m_input_unit[b.first]->peekTopFlit(b.second));
+              });
+
+    std::vector<bool> taken(m_num_outports, false);
+    for (int i = 0; i < arrived.size(); i++) {
+        bool M5_VAR_USED sent = send_deflection(arrived[i].first,
+            arrived[i].second, taken, false);
+        assert(sent);
+    }
+    for (int i = 0; i < injected.size(); i++) {
+        int inport = injected[i].first;
+        if (send_deflection(inport, injected[i].second, taken, true)) {
+            m_round_robin_invc[inport] = injected[i].second + 1;
+            if (m_round_robin_invc[inport] >= m_num_vcs)
+                m_round_robin_invc[inport] = 0;
         }
     }
 }
 
+// Send the flit at the head of 'invc' to an outport not 'taken' yet.
+// false if there is none (an injected flit then waits at its inport).
+bool
+SwitchAllocator::send_deflection(int inport, int invc,
+                                 std::vector<bool>& taken, bool injection)
+{
+    flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+    bool deflected;
+    int outport = m_router->m_routing_unit->outportComputeDeflection(
+        t_flit->get_route(), taken, deflected);
+    if (outport == -1)
+        return false;
+    taken[outport] = true;
+
+    // vcs are only allocated at the NIs; the vnet is kept on the
+    // links for the stats
+    int vnet = t_flit->get_vnet();
+    int outvc = vnet * m_vc_per_vnet;
+    if (m_output_unit[outport]->get_direction() == "Local") {
+        outvc = m_output_unit[outport]->select_free_vc(vnet);
+        assert(outvc != -1);
+        m_output_unit[outport]->decrement_credit(outvc);
+    }
+    if (deflected)
+        m_router->get_net_ptr()->m_deflections++;
+
+    t_flit = m_input_unit[inport]->getTopFlit(invc);
+    t_flit->set_outport(outport);
+    t_flit->set_outport_dir(m_output_unit[outport]->get_direction());
+    t_flit->set_vc(outvc);
+    t_flit->advance_stage(ST_, m_router->curCycle());
+    m_router->grant_switch(inport, t_flit);
+    m_input_arbiter_activity++;
+    m_output_arbiter_activity++;
+
+    if (injection) {
+        bool is_tail = ((t_flit->get_type() == TAIL_) ||
+                        (t_flit->get_type() == HEAD_TAIL_));
+        if (is_tail)
+            m_input_unit[inport]->set_vc_idle(invc, m_router->curCycle());
+        m_input_unit[inport]->increment_credit(invc, is_tail,
+                                               m_router->curCycle());
+    }
+    return true;
+}
+
+// Multicast flit at the head of 'invc' granted 'outport': if only some
+// of its destinations are reached through 'outport', return a copy
+// for them and keep the flit, with the other destinations and a new
+// route, in the input vc. nullptr if all of them go through 'outport'.
+// Each branch is switched (and allocated an outvc) on its own, so
+// replication follows the usual vc and credit flow control, and the
+// waiting flit is moved by DRAIN like any other.
+flit*
+SwitchAllocator::fork_multicast(int inport, int invc, int outport)
+{
+    flit *t_flit = m_input_unit[inport]->peekTopFlit(invc);
+    assert(t_flit->get_type() == HEAD_TAIL_);
+    RouteInfo& route = t_flit->m_route;
+
+    NetDest branch = m_router->m_routing_unit->branchDestinations(outport,
+        route.net_dest);
+    // a flit deflected (u-turn) away from its routes takes all of
+    // its destinations along
+    if (branch.isEmpty() || branch.isEqual(route.net_dest))
+        return nullptr;
+
+    flit *copy = new flit(*t_flit);
+    copy->m_route.net_dest = branch;
+    std::vector<NodeID> dests = branch.getAllDest();
+    if (dests.size() == 1) {
+        copy->m_route.dest_ni = dests[0];
+        copy->m_route.dest_router =
+            m_router->get_net_ptr()->get_router_id(dests[0]);
+    }
+    m_router->get_net_ptr()->m_multicast_forks++;
+
+    route.net_dest.removeNetDest(branch);
+    dests = route.net_dest.getAllDest();
+    if (dests.size() == 1) {
+        route.dest_ni = dests[0];
+        route.dest_router = m_router->get_net_ptr()->get_router_id(dests[0]);
+    }
+    int next_outport = m_router->route_compute(route, inport,
+        m_input_unit[inport]->get_direction());
+    t_flit->set_outport(next_outport);
+    t_flit->set_outport_dir(m_output_unit[next_outport]->get_direction());
+    // the next branch needs its own outvc
+    m_input_unit[inport]->grant_outvc(invc, -1);
+
+    return copy;
+}
+
 void
 SwitchAllocator::disallow_uturn(int inputUnit_id, int invc, PortDirection inputUnit_dirn)
 {
@@ -401,6 +841,10 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     // Check if outvc needed
     // Check if credit needed (for multi-flit packet)
     // Check if ordering violated (in ordered vnet)
+    // Check if the outport has bandwidth left this cycle (speedup)
+
+    if (m_outport_grants[outport] >= m_outport_width[outport])
+        return false;
 
     int vnet = get_vnet(invc);
     bool has_outvc = (outvc != -1);
@@ -412,7 +856,9 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
         // this is only true for HEAD and HEAD_TAIL flits.
         /*cout << "m_router->get_id(): " << m_router->get_id()\
         << " outport: " << outport << endl;*/
-        if (m_output_unit[outport]->has_free_vc(vnet)) {
+        int first, num;
+        get_vc_range(inport, invc, outport, first, num);
+        if (m_output_unit[outport]->has_free_vc(vnet, first, num)) {
 
             has_outvc = true;
 
@@ -458,7 +904,10 @@ int
 SwitchAllocator::vc_allocate(int outport, int inport, int invc)
 {
     // Select a free VC from the output port
-    int outvc = m_output_unit[outport]->select_free_vc(get_vnet(invc));
+    int first, num;
+    get_vc_range(inport, invc, outport, first, num);
+    int outvc = m_output_unit[outport]->select_free_vc(get_vnet(invc),
+                                                       first, num);
 
     // has to get a valid VC since it checked before performing SA
     assert(outvc != -1);
@@ -497,11 +946,7 @@ SwitchAllocator::get_vnet(int invc)
 void
 SwitchAllocator::clear_request_vector()
 {
-    for (int i = 0; i < m_num_outports; i++) {
-        for (int j = 0; j < m_num_inports; j++) {
-            m_port_requests[i][j] = false;
-        }
-    }
+    m_requests.clear();
 }
 
 void
@@ -509,4 +954,7 @@ SwitchAllocator::resetStats()
 {
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
+    m_alloc_cycles = 0;
+    m_alloc_grants = 0;
+    m_alloc_max_grants = 0;
 }
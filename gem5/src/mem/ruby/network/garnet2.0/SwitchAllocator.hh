@@ -39,6 +39,7 @@
 
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+#include "mem/ruby/network/garnet2.0/SwitchArbiter.hh"
 #include "mem/ruby/network/garnet2.0/flit.hh"
 
 
@@ -50,6 +51,7 @@ class SwitchAllocator : public Consumer
 {
   public:
     SwitchAllocator(Router *router);
+    ~SwitchAllocator();
     void wakeup();
     void init();
     void clear_request_vector();
@@ -59,8 +61,21 @@ class SwitchAllocator : public Consumer
     void arbitrate_inports();
     void arbitrate_outports();
     void disallow_uturn(int inputUnit_id, int invc, PortDirection inputUnit_dirn);
+    int get_request_outport(int inport, int invc);
+    void get_vc_range(int inport, int invc, int outport,
+                      int& first, int& num);
+    void check_uturn(int inport, int invc);
+    bool arbitrate_escalated_invc(int inport);
+    int max_matching_size();
+    bool augment_matching(int inport);
+    void grant_request(int inport, int invc, int outport);
     bool send_allowed(int inport, int invc, int outport, int outvc);
     int vc_allocate(int outport, int inport, int invc);
+    flit* fork_multicast(int inport, int invc, int outport);
+    void end_bypass();
+    void arbitrate_deflection();
+    bool send_deflection(int inport, int invc, std::vector<bool>& taken,
+                         bool injection);
 
     inline double
     get_input_arbiter_activity()
@@ -72,6 +87,12 @@ class SwitchAllocator : public Consumer
     {
         return m_output_arbiter_activity;
     }
+    // allocation rounds with requests (one per cycle, unless links
+    // wider than a flit give the router speedup), grants, and the
+    // largest number of grants the requests allowed
+    double get_alloc_cycles() { return m_alloc_cycles; }
+    double get_alloc_grants() { return m_alloc_grants; }
+    double get_alloc_max_grants() { return m_alloc_max_grants; }
 
     void resetStats();
   private:
@@ -80,12 +101,24 @@ class SwitchAllocator : public Consumer
     int m_num_vcs, m_vc_per_vnet;
 
     double m_input_arbiter_activity, m_output_arbiter_activity;
+    double m_alloc_cycles, m_alloc_grants, m_alloc_max_grants;
 
     Router *m_router;
     std::vector<int> m_round_robin_invc;
-    std::vector<int> m_round_robin_inport;
-    std::vector<std::vector<bool>> m_port_requests;
-    std::vector<std::vector<int>> m_vc_winners; // a list for each outport
+    SwitchArbiter *m_arbiter;
+    // requests placed in SA-I, and the ones granted in SA-II
+    std::vector<SwitchRequest> m_requests, m_grants;
+    // speedup: flits each port may send this cycle (the width of its
+    // link, in flits), those granted so far, and the allocation
+    // rounds needed to fill the widest port
+    std::vector<int> m_inport_width, m_outport_width;
+    std::vector<int> m_inport_grants, m_outport_grants;
+    int m_speedup;
+    // maximum matching of the requests (see max_matching_size())
+    std::vector<std::vector<int> > m_requested_outports;
+    std::vector<bool> m_inport_matched;
+    std::vector<bool> m_outport_requested, m_outport_visited;
+    std::vector<int> m_matched_inport;
     std::vector<InputUnit *> m_input_unit;
     std::vector<OutputUnit *> m_output_unit;
 };
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/SwitchArbiter.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+
+SwitchArbiter::SwitchArbiter(int num_inports, int num_outports)
+    : m_num_inports(num_inports), m_num_outports(num_outports),
+      m_inport_busy(num_inports, false), m_outport_busy(num_outports, false),
+      m_request_idx(num_inports, std::vector<int>(num_outports, -1))
+{
+}
+
+SwitchArbiter*
+SwitchArbiter::create(const std::string& name, int num_inports,
+                      int num_outports, int iterations)
+{
+    if (name == "separable")
+        return new SeparableArbiter(num_inports, num_outports);
+    if (name == "islip")
+        return new ISlipArbiter(num_inports, num_outports, iterations);
+    if (name == "wavefront")
+        return new WavefrontArbiter(num_inports, num_outports);
+    if (name == "oldest_first")
+        return new OldestFirstArbiter(num_inports, num_outports);
+
+    fatal("Unknown switch allocator '%s' (separable, islip, wavefront "
+          "or oldest_first)\n", name);
+    return nullptr;
+}
+
+void
+SwitchArbiter::allocate(const std::vector<SwitchRequest>& requests,
+                        std::vector<SwitchRequest>& grants)
+{
+    grants.clear();
+    std::fill(m_inport_busy.begin(), m_inport_busy.end(), false);
+    std::fill(m_outport_busy.begin(), m_outport_busy.end(), false);
+
+    // escalated requests first, in inport order
+    for (int i = 0; i < requests.size(); i++) {
+        if (requests[i].escalated && !m_inport_busy[requests[i].inport] &&
+            !m_outport_busy[requests[i].outport]) {
+            grant(requests[i], grants);
+        }
+    }
+
+    match(requests, grants);
+}
+
+void
+SwitchArbiter::grant(const SwitchRequest& request,
+                     std::vector<SwitchRequest>& grants)
+{
+    assert(!m_inport_busy[request.inport]);
+    assert(!m_outport_busy[request.outport]);
+    m_inport_busy[request.inport] = true;
+    m_outport_busy[request.outport] = true;
+    grants.push_back(request);
+}
+
+// [inport][outport] -> first request (in round robin vc order) of a
+// free inport for a free outport, -1 if none
+void
+SwitchArbiter::index_requests(const std::vector<SwitchRequest>& requests)
+{
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        std::fill(m_request_idx[inport].begin(), m_request_idx[inport].end(),
+                  -1);
+    }
+    for (int i = 0; i < requests.size(); i++) {
+        const SwitchRequest& request = requests[i];
+        if (m_inport_busy[request.inport] || m_outport_busy[request.outport])
+            continue;
+        int& idx = m_request_idx[request.inport][request.outport];
+        if (idx == -1)
+            idx = i;
+    }
+}
+
+SeparableArbiter::SeparableArbiter(int num_inports, int num_outports)
+    : SwitchArbiter(num_inports, num_outports),
+      m_round_robin_inport(num_outports, 0)
+{
+}
+
+void
+SeparableArbiter::match(const std::vector<SwitchRequest>& requests,
+                        std::vector<SwitchRequest>& grants)
+{
+    index_requests(requests);
+
+    for (int outport = 0; outport < m_num_outports; outport++) {
+        int inport = m_round_robin_inport[outport];
+        // granted to an escalated flit
+        bool granted = m_outport_busy[outport];
+
+        for (int inport_iter = 0; !granted && (inport_iter < m_num_inports);
+             inport_iter++) {
+            int idx = m_request_idx[inport][outport];
+            if (idx != -1) {
+                grant(requests[idx], grants);
+                granted = true;
+            }
+
+            inport++;
+            if (inport >= m_num_inports)
+                inport = 0;
+        }
+
+        // Update Round Robin pointer
+        if (granted) {
+            m_round_robin_inport[outport]++;
+            if (m_round_robin_inport[outport] >= m_num_inports)
+                m_round_robin_inport[outport] = 0;
+        }
+    }
+}
+
+ISlipArbiter::ISlipArbiter(int num_inports, int num_outports,
+                           int iterations)
+    : SwitchArbiter(num_inports, num_outports),
+      m_iterations(iterations), m_grant_ptr(num_outports, 0),
+      m_accept_ptr(num_inports, 0), m_granted_inport(num_outports, -1)
+{
+    if (iterations < 1)
+        fatal("iSLIP needs at least one iteration\n");
+}
+
+void
+ISlipArbiter::match(const std::vector<SwitchRequest>& requests,
+                    std::vector<SwitchRequest>& grants)
+{
+    index_requests(requests);
+
+    for (int iter = 0; iter < m_iterations; iter++) {
+        // grant: each free outport picks a requesting free inport
+        bool any_grant = false;
+        for (int outport = 0; outport < m_num_outports; outport++) {
+            m_granted_inport[outport] = -1;
+            if (m_outport_busy[outport])
+                continue;
+            for (int k = 0; k < m_num_inports; k++) {
+                int inport = (m_grant_ptr[outport] + k) % m_num_inports;
+                if (!m_inport_busy[inport] &&
+                    (m_request_idx[inport][outport] != -1)) {
+                    m_granted_inport[outport] = inport;
+                    any_grant = true;
+                    break;
+                }
+            }
+        }
+        if (!any_grant)
+            break;
+
+        // accept: each free inport picks one of its grants
+        for (int inport = 0; inport < m_num_inports; inport++) {
+            if (m_inport_busy[inport])
+                continue;
+            for (int k = 0; k < m_num_outports; k++) {
+                int outport = (m_accept_ptr[inport] + k) % m_num_outports;
+                if (m_granted_inport[outport] != inport)
+                    continue;
+                grant(requests[m_request_idx[inport][outport]], grants);
+                if (iter == 0) {
+                    m_grant_ptr[outport] = (inport + 1) % m_num_inports;
+                    m_accept_ptr[inport] = (outport + 1) % m_num_outports;
+                }
+                break;
+            }
+        }
+    }
+}
+
+WavefrontArbiter::WavefrontArbiter(int num_inports, int num_outports)
+    : SwitchArbiter(num_inports, num_outports), m_priority_diagonal(0)
+{
+}
+
+void
+WavefrontArbiter::match(const std::vector<SwitchRequest>& requests,
+                        std::vector<SwitchRequest>& grants)
+{
+    index_requests(requests);
+
+    // square matrix: diagonal d holds the cells (i, (i + d) % n)
+    int n = std::max(m_num_inports, m_num_outports);
+    for (int k = 0; k < n; k++) {
+        int diagonal = (m_priority_diagonal + k) % n;
+        for (int inport = 0; inport < m_num_inports; inport++) {
+            int outport = (inport + diagonal) % n;
+            if ((outport >= m_num_outports) || m_inport_busy[inport] ||
+                m_outport_busy[outport])
+                continue;
+            int idx = m_request_idx[inport][outport];
+            if (idx != -1)
+                grant(requests[idx], grants);
+        }
+    }
+
+    m_priority_diagonal = (m_priority_diagonal + 1) % n;
+}
+
+OldestFirstArbiter::OldestFirstArbiter(int num_inports, int num_outports)
+    : SwitchArbiter(num_inports, num_outports)
+{
+}
+
+void
+OldestFirstArbiter::match(const std::vector<SwitchRequest>& requests,
+                          std::vector<SwitchRequest>& grants)
+{
+    m_order.resize(requests.size());
+    for (int i = 0; i < requests.size(); i++)
+        m_order[i] = i;
+    std::stable_sort(m_order.begin(), m_order.end(),
+                     [&requests](int a, int b) {
+                         return (requests[a].age < requests[b].age);
+                     });
+
+    for (int i = 0; i < m_order.size(); i++) {
+        const SwitchRequest& request = requests[m_order[i]];
+        if (!m_inport_busy[request.inport] &&
+            !m_outport_busy[request.outport]) {
+            grant(request, grants);
+        }
+    }
+}
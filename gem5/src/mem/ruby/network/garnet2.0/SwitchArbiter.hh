@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_SWITCHARBITER_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_SWITCHARBITER_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+// Request of the flit at the head of input vc 'invc' of 'inport' for
+// 'outport', placed during SA-I once the flit may be sent.
+struct SwitchRequest
+{
+    SwitchRequest(int inport, int invc, int outport, Cycles age,
+                  bool escalated)
+        : inport(inport), invc(invc), outport(outport), age(age),
+          escalated(escalated)
+    {}
+
+    int inport;
+    int invc;
+    int outport;
+    Cycles age; // injection time of the flit (lower is older)
+    bool escalated; // see GarnetNetwork::is_escalated()
+};
+
+// Matching of input vcs to outports for the SwitchAllocator: grants
+// at most one request per inport and per outport every cycle.
+// Escalated requests are granted ahead of the others.
+class SwitchArbiter
+{
+  public:
+    SwitchArbiter(int num_inports, int num_outports);
+    virtual ~SwitchArbiter() {}
+
+    // true if the allocator only needs the first request of each
+    // inport (in its round robin vc order)
+    virtual bool one_request_per_inport() { return false; }
+    // 'requests' are in inport order, and in round robin vc order
+    // at each inport
+    void allocate(const std::vector<SwitchRequest>& requests,
+                  std::vector<SwitchRequest>& grants);
+
+    // "separable", "islip", "wavefront" or "oldest_first"
+    static SwitchArbiter* create(const std::string& name,
+                                 int num_inports, int num_outports,
+                                 int iterations);
+
+  protected:
+    // match the requests of the inports and outports left once the
+    // escalated requests are granted
+    virtual void match(const std::vector<SwitchRequest>& requests,
+                       std::vector<SwitchRequest>& grants) = 0;
+    void grant(const SwitchRequest& request,
+               std::vector<SwitchRequest>& grants);
+    void index_requests(const std::vector<SwitchRequest>& requests);
+
+    int m_num_inports, m_num_outports;
+    // inports and outports matched this cycle
+    std::vector<bool> m_inport_busy, m_outport_busy;
+    // [inport][outport] -> first request, -1 if none
+    std::vector<std::vector<int> > m_request_idx;
+};
+
+// Separable input-first allocator with round robin arbiters: each
+// inport requests a single outport (SA-I) and each outport grants one
+// of its requests (SA-II). The original garnet2.0 allocator.
+class SeparableArbiter : public SwitchArbiter
+{
+  public:
+    SeparableArbiter(int num_inports, int num_outports);
+    bool one_request_per_inport() { return true; }
+  protected:
+    void match(const std::vector<SwitchRequest>& requests,
+               std::vector<SwitchRequest>& grants);
+
+  private:
+    std::vector<int> m_round_robin_inport;
+};
+
+// iSLIP: every input vc requests its outport; in each iteration
+// unmatched outports grant the next requesting inport from their
+// grant pointer and unmatched inports accept the next granting
+// outport from their accept pointer. Pointers move past an accepted
+// grant in the first iteration only.
+class ISlipArbiter : public SwitchArbiter
+{
+  public:
+    ISlipArbiter(int num_inports, int num_outports, int iterations);
+  protected:
+    void match(const std::vector<SwitchRequest>& requests,
+               std::vector<SwitchRequest>& grants);
+
+  private:
+    int m_iterations;
+    std::vector<int> m_grant_ptr, m_accept_ptr;
+    std::vector<int> m_granted_inport; // per outport, this iteration
+};
+
+// Wavefront allocator: sweeps the diagonals of the inport x outport
+// request matrix, starting from a diagonal which rotates every cycle,
+// and grants each request whose row and column are still free.
+class WavefrontArbiter : public SwitchArbiter
+{
+  public:
+    WavefrontArbiter(int num_inports, int num_outports);
+  protected:
+    void match(const std::vector<SwitchRequest>& requests,
+               std::vector<SwitchRequest>& grants);
+
+  private:
+    int m_priority_diagonal;
+};
+
+// Age-based allocator: grants the requests oldest flit first, each
+// if its inport and outport are still free.
+class OldestFirstArbiter : public SwitchArbiter
+{
+  public:
+    OldestFirstArbiter(int num_inports, int num_outports);
+  protected:
+    void match(const std::vector<SwitchRequest>& requests,
+               std::vector<SwitchRequest>& grants);
+
+  private:
+    std::vector<int> m_order;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_SWITCHARBITER_HH__
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/TopologyFile.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "sim/byteswap.hh"
+
+TopologyFile::TopologyFile(const std::string& filename)
+    : m_filename(filename), m_rows(0), m_cols(0)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    if (!in.good())
+        fatal("Could not open topology file %s\n", filename);
+
+    char magic[4];
+    in.read(magic, sizeof(magic));
+    if (in.good() && (std::memcmp(magic, "GNTP", sizeof(magic)) == 0)) {
+        read_edge_list(in);
+    } else {
+        in.clear();
+        in.seekg(0);
+        read_matrix(in);
+    }
+}
+
+TopologyFile::TopologyFile(int rows, int cols, const std::string& name)
+    : m_filename(name), m_rows(rows), m_cols(cols)
+{
+}
+
+// Root of the set of router 'r', halving the path on the way
+static int
+find_set(std::vector<int>& parent, int r)
+{
+    while (parent[r] != r) {
+        parent[r] = parent[parent[r]];
+        r = parent[r];
+    }
+    return r;
+}
+
+// Join the sets of routers 'a' and 'b'; false if they already were
+static bool
+join_sets(std::vector<int>& parent, int a, int b)
+{
+    a = find_set(parent, a);
+    b = find_set(parent, b);
+    if (a == b)
+        return false;
+    parent[a] = b;
+    return true;
+}
+
+TopologyFile
+TopologyFile::generate(int rows, int cols, int links_removed,
+                       double fault_prob, uint32_t seed)
+{
+    TopologyFile topology(rows, cols,
+        csprintf("generated %dx%d mesh (seed %d)", rows, cols, seed));
+    int num_routers = rows * cols;
+
+    // the bidirectional links of the full mesh, in random order
+    std::vector<std::pair<int, int> > mesh_links;
+    for (int r = 0; r < num_routers; r++) {
+        if ((r % cols) + 1 < cols)
+            mesh_links.push_back(std::make_pair(r, r + 1));
+        if (r + cols < num_routers)
+            mesh_links.push_back(std::make_pair(r, r + cols));
+    }
+    CounterRNG rng = CounterRNG(seed).split(TOPOLOGY_RNG_);
+    for (int i = mesh_links.size() - 1; i > 0; i--)
+        std::swap(mesh_links[i], mesh_links[rng.random(0, i)]);
+
+    // a connected mesh keeps at least a spanning tree
+    int max_removed = mesh_links.size() - (num_routers - 1);
+    if (links_removed > max_removed)
+        fatal("%s: cannot remove %d of its %d links, at most %d\n",
+              topology.m_filename, links_removed, mesh_links.size(),
+              max_removed);
+
+    // the links that may be removed, in order: all of them (until
+    // 'links_removed' are), or each with probability 'fault_prob'
+    std::vector<bool> candidate(mesh_links.size(), links_removed > 0);
+    std::vector<int> candidates;
+    for (int i = 0; i < mesh_links.size(); i++) {
+        if ((links_removed == 0) && (rng.uniform() < fault_prob))
+            candidate[i] = true;
+        if (candidate[i])
+            candidates.push_back(i);
+    }
+    int num_candidates = candidates.size();
+
+    // Both directions of a link are removed together, so the mesh
+    // stays strongly connected as long as it stays connected: a
+    // candidate goes if its two routers still reach each other
+    // without it. Taking the candidates in order that way removes
+    // exactly the ones Kruskal's algorithm rejects when it takes the
+    // other links first, then the candidates backwards (reverse-delete
+    // builds the same spanning forest), so the checks are a union-find
+    // pass rather than a search of the mesh per candidate.
+    std::vector<int> parent(num_routers);
+    for (int r = 0; r < num_routers; r++)
+        parent[r] = r;
+    int components = num_routers;
+    for (int i = 0; i < mesh_links.size(); i++) {
+        if (!candidate[i] && join_sets(parent, mesh_links[i].first,
+                                       mesh_links[i].second))
+            components--;
+    }
+
+    // With a number to remove, stop at the candidate removing the
+    // last of them: the first j candidates remove j minus the ones
+    // that join the components left by the others.
+    int considered = num_candidates;
+    if (links_removed > 0) {
+        std::vector<int> components_after(num_candidates + 1);
+        components_after[num_candidates] = components;
+        for (int j = num_candidates; j > 0; j--) {
+            const std::pair<int, int>& link = mesh_links[candidates[j - 1]];
+            if (join_sets(parent, link.first, link.second))
+                components--;
+            components_after[j - 1] = components;
+        }
+        for (considered = 0; considered < num_candidates; considered++) {
+            int removed = considered -
+                (components_after[considered] - components_after[0]);
+            if (removed == links_removed)
+                break;
+        }
+
+        for (int r = 0; r < num_routers; r++)
+            parent[r] = r;
+        for (int i = 0; i < mesh_links.size(); i++) {
+            if (!candidate[i])
+                join_sets(parent, mesh_links[i].first, mesh_links[i].second);
+        }
+    }
+
+    std::vector<bool> link_removed(mesh_links.size(), false);
+    for (int j = num_candidates - 1; j >= considered; j--) {
+        const std::pair<int, int>& link = mesh_links[candidates[j]];
+        join_sets(parent, link.first, link.second);
+    }
+    int removed = 0;
+    for (int j = considered - 1; j >= 0; j--) {
+        const std::pair<int, int>& link = mesh_links[candidates[j]];
+        if (!join_sets(parent, link.first, link.second)) {
+            link_removed[candidates[j]] = true;
+            removed++;
+        }
+    }
+    if (removed < links_removed)
+        fatal("%s: only %d of %d links could be removed keeping the "
+              "mesh connected\n", topology.m_filename, removed,
+              links_removed);
+
+    std::vector<std::vector<int> > adj(num_routers);
+    for (int i = 0; i < mesh_links.size(); i++) {
+        if (link_removed[i])
+            continue;
+        adj[mesh_links[i].first].push_back(mesh_links[i].second);
+        adj[mesh_links[i].second].push_back(mesh_links[i].first);
+    }
+    for (int src = 0; src < num_routers; src++) {
+        std::sort(adj[src].begin(), adj[src].end());
+        for (int i = 0; i < adj[src].size(); i++)
+            topology.add_link(src, adj[src][i]);
+    }
+
+    return topology;
+}
+
+void
+TopologyFile::read_matrix(std::istream& in)
+{
+    std::string line;
+    if (!(in >> m_rows >> m_cols) || (m_rows <= 0) || (m_cols <= 0))
+        fatal("%s: no '<rows> <cols>' line\n", m_filename);
+    // the rest of the first line, and the separator line
+    std::getline(in, line);
+    std::getline(in, line);
+
+    int num_routers = m_rows * m_cols;
+    for (int src = 0; src < num_routers; src++) {
+        for (int dest = 0; dest < num_routers; dest++) {
+            int entry;
+            if (!(in >> entry))
+                fatal("%s: expected %d x %d entries\n", m_filename,
+                      num_routers, num_routers);
+            if (entry == 1)
+                add_link(src, dest);
+        }
+    }
+}
+
+void
+TopologyFile::read_edge_list(std::istream& in)
+{
+    uint32_t header[4];
+    in.read((char *) header, sizeof(header));
+    if (!in.good())
+        fatal("%s: truncated header\n", m_filename);
+    uint32_t version = letoh(header[0]);
+    if (version != 1)
+        fatal("%s: unknown version %d\n", m_filename, version);
+    m_rows = letoh(header[1]);
+    m_cols = letoh(header[2]);
+    uint32_t num_links = letoh(header[3]);
+
+    std::vector<uint32_t> links(2 * num_links);
+    in.read((char *) links.data(), links.size() * sizeof(uint32_t));
+    if (!in.good())
+        fatal("%s: truncated after %d of %d links\n", m_filename,
+              in.gcount() / (2 * sizeof(uint32_t)), num_links);
+
+    m_links.reserve(num_links);
+    for (int i = 0; i < num_links; i++)
+        add_link(letoh(links[2 * i]), letoh(links[2 * i + 1]));
+}
+
+void
+TopologyFile::add_link(int src, int dest)
+{
+    int num_routers = m_rows * m_cols;
+    if ((src < 0) || (src >= num_routers) || (dest < 0) ||
+        (dest >= num_routers))
+        fatal("%s: link %d -> %d outside of the %d routers\n",
+              m_filename, src, dest, num_routers);
+
+    // checks the two routers are neighbours
+    PortDirection src_outport, dst_inport;
+    get_directions(src, dest, src_outport, dst_inport);
+    m_links.push_back(std::make_pair(src, dest));
+}
+
+// East/West links join the columns of a row, North/South links the
+// rows of a column (North towards the higher rows).
+void
+TopologyFile::get_directions(int src, int dest, PortDirection& src_outport,
+                             PortDirection& dst_inport) const
+{
+    int src_row = src / m_cols, src_col = src % m_cols;
+    int dest_row = dest / m_cols, dest_col = dest % m_cols;
+
+    if ((src_row == dest_row) && (dest_col == src_col + 1)) {
+        src_outport = "East";
+        dst_inport = "West";
+    } else if ((src_row == dest_row) && (dest_col == src_col - 1)) {
+        src_outport = "West";
+        dst_inport = "East";
+    } else if ((src_col == dest_col) && (dest_row == src_row + 1)) {
+        src_outport = "North";
+        dst_inport = "South";
+    } else if ((src_col == dest_col) && (dest_row == src_row - 1)) {
+        src_outport = "South";
+        dst_inport = "North";
+    } else {
+        fatal("%s: routers %d and %d are not neighbours in a %d x %d "
+              "mesh\n", m_filename, src, dest, m_rows, m_cols);
+    }
+}
+
+// Hierholzer's algorithm from router 0. Every router has as many
+// links in as out, so the walk takes every link once if the mesh is
+// connected, and comes back to router 0 from one of its neighbours
+// (router 1 or the router north of it), as init_spinRing() expects.
+std::vector<std::pair<int, PortDirection> >
+TopologyFile::get_spin_ring() const
+{
+    int num_routers = m_rows * m_cols;
+    std::vector<std::vector<int> > out_links(num_routers);
+    for (int i = 0; i < m_links.size(); i++)
+        out_links[m_links[i].first].push_back(m_links[i].second);
+
+    std::vector<int> path(1, 0), walk;
+    while (!path.empty()) {
+        int router = path.back();
+        if (out_links[router].empty()) {
+            walk.push_back(router);
+            path.pop_back();
+        } else {
+            path.push_back(out_links[router].back());
+            out_links[router].pop_back();
+        }
+    }
+    std::reverse(walk.begin(), walk.end());
+    if (walk.size() != m_links.size() + 1)
+        fatal("%s: no ring through its %d links, the mesh is not "
+              "connected\n", m_filename, m_links.size());
+
+    // the link into router 0 closes the ring: it is spinRing[0]
+    std::vector<std::pair<int, PortDirection> > ring;
+    for (int i = 1; i + 1 < walk.size(); i++) {
+        PortDirection src_outport, dst_inport;
+        get_directions(walk[i - 1], walk[i], src_outport, dst_inport);
+        ring.push_back(std::make_pair(walk[i], dst_inport));
+    }
+    return ring;
+}
+
+void
+TopologyFile::write_matrix(std::ostream& out) const
+{
+    int num_routers = m_rows * m_cols;
+    std::vector<std::vector<int> > matrix(num_routers,
+                                          std::vector<int>(num_routers, 0));
+    for (int i = 0; i < m_links.size(); i++)
+        matrix[m_links[i].first][m_links[i].second] = 1;
+
+    out << m_rows << " " << m_cols << "\n";
+    out << "-------Topology--------\n";
+    for (int src = 0; src < num_routers; src++) {
+        for (int dest = 0; dest < num_routers; dest++)
+            out << ((src == dest) ? -1 : matrix[src][dest]) << " ";
+        out << "\n";
+    }
+}
+
+// "<router> <N|E|S|W>" per line, with no newline after the last one:
+// init_spinRing() would read it twice
+void
+TopologyFile::write_spin_ring(std::ostream& out) const
+{
+    std::vector<std::pair<int, PortDirection> > ring = get_spin_ring();
+    for (int i = 0; i < ring.size(); i++) {
+        out << ring[i].first << " " << ring[i].second[0];
+        if (i + 1 < ring.size())
+            out << "\n";
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_TOPOLOGYFILE_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_TOPOLOGYFILE_HH__
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mem/ruby/network/Topology.hh"
+
+// Router-to-router links of a (possibly irregular) mesh, read from
+// 'filename' in either format:
+//  - a connectivity matrix in text: "<rows> <cols>", a separator
+//    line, then rows*cols lines of rows*cols entries where entry
+//    [i][j] is 1 if there is a link from router i to router j
+//    (see configs/topologies/irregularMesh_XY.py);
+//  - a binary edge list (see util/encode_topology.py),
+//    all fields little-endian uint32:
+//        "GNTP" version(1) rows cols num_links {src dest}*num_links
+// Every link must join two neighbours of the mesh (routers are
+// numbered row by row).
+// A topology may instead be generated (see generate()): a mesh with
+// some of its links removed at random, which stays strongly
+// connected, together with a DRAIN ring covering all of its links.
+class TopologyFile
+{
+  public:
+    TopologyFile(const std::string& filename);
+
+    // A rows x cols mesh without 'links_removed' of its bidirectional
+    // links or, if 'links_removed' is 0, without each of them with
+    // probability 'fault_prob'; links whose removal would disconnect
+    // the mesh are kept. The same seed gives the same topology.
+    static TopologyFile generate(int rows, int cols, int links_removed,
+                                 double fault_prob, uint32_t seed);
+
+    // the file name, or a description of a generated topology
+    const std::string& get_name() const { return m_filename; }
+    int get_rows() const { return m_rows; }
+    int get_cols() const { return m_cols; }
+    // (source router, destination router) of each link
+    const std::vector<std::pair<int, int> >&
+    get_links() const
+    {
+        return m_links;
+    }
+    // outport at the source and inport at the destination of a link
+    void get_directions(int src, int dest, PortDirection& src_outport,
+                        PortDirection& dst_inport) const;
+
+    // A closed walk from router 0 taking every link once (links are
+    // bidirectional, so there is one), as (router, inport) from the
+    // second router on: the spin_file format of
+    // GarnetNetwork::init_spinRing()
+    std::vector<std::pair<int, PortDirection> > get_spin_ring() const;
+    // the topology as a connectivity matrix, and its spin ring, in
+    // the formats of the shipped topology and spin_configs files
+    void write_matrix(std::ostream& out) const;
+    void write_spin_ring(std::ostream& out) const;
+
+  private:
+    TopologyFile(int rows, int cols, const std::string& name);
+
+    void read_matrix(std::istream& in);
+    void read_edge_list(std::istream& in);
+    void add_link(int src, int dest);
+
+    std::string m_filename;
+    int m_rows, m_cols;
+    std::vector<std::pair<int, int> > m_links;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_TOPOLOGYFILE_HH__
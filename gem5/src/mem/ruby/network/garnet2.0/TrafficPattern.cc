@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/TrafficPattern.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "base/logging.hh"
+
+TrafficType
+traffic_type_from_string(const std::string& traffic_type)
+{
+    static std::map<std::string, TrafficType> trafficStringToEnum;
+    if (trafficStringToEnum.empty()) {
+        trafficStringToEnum["bit_complement"] = BIT_COMPLEMENT_;
+        trafficStringToEnum["bit_reverse"] = BIT_REVERSE_;
+        trafficStringToEnum["bit_rotation"] = BIT_ROTATION_;
+        trafficStringToEnum["neighbor"] = NEIGHBOR_;
+        trafficStringToEnum["shuffle"] = SHUFFLE_;
+        trafficStringToEnum["tornado"] = TORNADO_;
+        trafficStringToEnum["transpose"] = TRANSPOSE_;
+        trafficStringToEnum["uniform_random"] = UNIFORM_RANDOM_;
+        trafficStringToEnum["hotspot"] = HOTSPOT_;
+        trafficStringToEnum["permutation"] = PERMUTATION_;
+        trafficStringToEnum["rate_matrix"] = RATE_MATRIX_;
+    }
+
+    if (trafficStringToEnum.count(traffic_type) == 0) {
+        fatal("Unknown Traffic Type: %s!\n", traffic_type);
+    }
+    return trafficStringToEnum[traffic_type];
+}
+
+// Numbers of a pattern file ('#' starts a comment). Every source reads
+// the same file, so it is parsed once.
+static const std::vector<double>&
+read_pattern_file(const std::string& filename)
+{
+    static std::map<std::string, std::vector<double> > files;
+    std::map<std::string, std::vector<double> >::iterator it =
+        files.find(filename);
+    if (it != files.end())
+        return it->second;
+
+    std::ifstream in(filename.c_str());
+    if (!in.good())
+        fatal("Could not open traffic pattern file %s\n", filename);
+
+    std::vector<double>& numbers = files[filename];
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string token;
+        while (tokens >> token) {
+            char *end;
+            double value = strtod(token.c_str(), &end);
+            if (*end != '\0')
+                fatal("%s: '%s' is not a number\n", filename, token);
+            numbers.push_back(value);
+        }
+    }
+    return numbers;
+}
+
+TrafficPattern::TrafficPattern(const TrafficPatternConfig& config,
+                               int source)
+    : m_type(traffic_type_from_string(config.type)), m_source(source),
+      m_num_dest(config.num_dest), m_fixed_dest(-1),
+      m_hotspot_nodes(config.hotspot_nodes),
+      m_hotspot_fraction(config.hotspot_fraction), m_source_rate(-1)
+{
+    assert(m_num_dest > 0);
+
+    if (m_type == UNIFORM_RANDOM_) {
+        // nothing to precompute
+    } else if (m_type == HOTSPOT_) {
+        if (m_hotspot_nodes.empty())
+            fatal("hotspot traffic needs at least one hotspot node\n");
+        for (int i = 0; i < m_hotspot_nodes.size(); i++) {
+            if ((m_hotspot_nodes[i] < 0) ||
+                (m_hotspot_nodes[i] >= m_num_dest)) {
+                fatal("hotspot node %d is not a destination\n",
+                      m_hotspot_nodes[i]);
+            }
+        }
+        if ((m_hotspot_fraction < 0) || (m_hotspot_fraction > 1))
+            fatal("hotspot fraction %f is not in [0, 1]\n",
+                  m_hotspot_fraction);
+    } else if (m_type == RATE_MATRIX_) {
+        const std::vector<double>& rates =
+            read_pattern_file(config.rate_matrix_file);
+        if (rates.size() != m_num_dest * m_num_dest) {
+            fatal("%s: %d rates for %d x %d destinations\n",
+                  config.rate_matrix_file, rates.size(), m_num_dest,
+                  m_num_dest);
+        }
+        if (m_source >= m_num_dest)
+            fatal("no rate matrix row for source %d\n", m_source);
+
+        std::vector<double> row(rates.begin() + m_source * m_num_dest,
+                                rates.begin() + (m_source + 1) * m_num_dest);
+        m_source_rate = 0;
+        for (int dest = 0; dest < m_num_dest; dest++) {
+            if (row[dest] < 0)
+                fatal("%s: negative rate\n", config.rate_matrix_file);
+            m_source_rate += row[dest];
+        }
+        if (m_source_rate > 0)
+            build_alias_table(row);
+    } else {
+        m_fixed_dest = fixed_destination(config);
+        assert((m_fixed_dest >= 0) && (m_fixed_dest < m_num_dest));
+    }
+}
+
+// destination of the patterns that map each source to one destination
+int
+TrafficPattern::fixed_destination(const TrafficPatternConfig& config)
+{
+    int source = m_source;
+    int num_destinations = m_num_dest;
+    if (source >= num_destinations) {
+        fatal("%s traffic: source %d has no destination of its own "
+              "(%d destinations)\n", config.type, source, num_destinations);
+    }
+
+    if (m_type == PERMUTATION_) {
+        const std::vector<double>& perm =
+            read_pattern_file(config.permutation_file);
+        if (perm.size() != num_destinations) {
+            fatal("%s: %d destinations for %d sources\n",
+                  config.permutation_file, perm.size(), num_destinations);
+        }
+        // every entry, so that the file is a permutation whichever
+        // sources are simulated
+        std::vector<bool> used(num_destinations, false);
+        for (int i = 0; i < num_destinations; i++) {
+            if ((perm[i] != std::floor(perm[i])) || (perm[i] < 0) ||
+                (perm[i] >= num_destinations)) {
+                fatal("%s: bad destination %f of source %d\n",
+                      config.permutation_file, perm[i], i);
+            }
+            int destination = (int) perm[i];
+            if (used[destination]) {
+                fatal("%s is not a permutation: destination %d is used "
+                      "twice\n", config.permutation_file, destination);
+            }
+            used[destination] = true;
+        }
+        return (int) perm[source];
+    }
+
+    if (m_type == BIT_REVERSE_) {
+        if ((num_destinations & (num_destinations - 1)) != 0)
+            fatal("bit_reverse traffic needs a power of two nodes\n");
+
+        unsigned int straight = source;
+        unsigned int reverse = source & 1; // LSB
+
+        int num_bits = (int) log2(num_destinations);
+
+        for (int i = 1; i < num_bits; i++)
+        {
+            reverse <<= 1;
+            straight >>= 1;
+            reverse |= (straight & 1); // LSB
+        }
+        return reverse;
+    }
+
+    if ((m_type == BIT_ROTATION_) || (m_type == SHUFFLE_)) {
+        if (num_destinations % 2 != 0)
+            fatal("%s traffic needs an even number of nodes\n", config.type);
+
+        if (m_type == BIT_ROTATION_) {
+            if (source%2 == 0)
+                return source/2;
+            else // (source%2 == 1)
+                return ((source/2) + (num_destinations/2));
+        }
+        if (source < num_destinations/2)
+            return source*2;
+        else
+            return (source*2 - num_destinations + 1);
+    }
+
+    // coordinate based patterns on a (possibly rectangular) mesh
+    int num_rows = config.num_rows;
+    if (num_rows <= 0)
+        num_rows = (int) sqrt(num_destinations);
+    int num_cols = num_destinations / num_rows;
+    if (num_rows * num_cols != num_destinations) {
+        fatal("%s traffic: %d nodes are not a %d-row mesh; set the "
+              "number of rows\n", config.type, num_destinations, num_rows);
+    }
+
+    int src_x = source%num_cols;
+    int src_y = source/num_cols;
+    int dest_x, dest_y;
+
+    if (m_type == BIT_COMPLEMENT_) {
+        dest_x = num_cols - src_x - 1;
+        dest_y = num_rows - src_y - 1;
+        return dest_y*num_cols + dest_x;
+    } else if (m_type == NEIGHBOR_) {
+        dest_x = (src_x + 1) % num_cols;
+        dest_y = src_y;
+        return dest_y*num_cols + dest_x;
+    } else if (m_type == TRANSPOSE_) {
+        // (x, y) -> (y, x); on a rectangle the transposed mesh has
+        // num_rows columns
+        return src_x*num_rows + src_y;
+    } else if (m_type == TORNADO_) {
+        dest_x = (src_x + (int) ceil(num_cols/2) - 1) % num_cols;
+        dest_y = src_y;
+        return dest_y*num_cols + dest_x;
+    }
+
+    fatal("Unknown Traffic Type: %s!\n", config.type);
+    return -1;
+}
+
+// Walker/Vose alias table: destination i with probability
+// weights[i] / sum(weights), in O(1) per packet
+void
+TrafficPattern::build_alias_table(const std::vector<double>& weights)
+{
+    int n = weights.size();
+    double sum = 0;
+    for (int i = 0; i < n; i++)
+        sum += weights[i];
+    assert(sum > 0);
+
+    m_alias_prob.assign(n, 1.0);
+    m_alias.resize(n);
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (int i = 0; i < n; i++) {
+        m_alias[i] = i;
+        scaled[i] = weights[i] * n / sum;
+        if (scaled[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        large.pop_back();
+
+        m_alias_prob[s] = scaled[s];
+        m_alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0)
+            small.push_back(l);
+        else
+            large.push_back(l);
+    }
+    // the rest are (up to rounding) exactly 1
+}
+
+int
+TrafficPattern::destination(CounterRNG& rng)
+{
+    if (m_fixed_dest >= 0)
+        return m_fixed_dest;
+
+    if (m_type == HOTSPOT_) {
+        if (rng.uniform() < m_hotspot_fraction) {
+            int idx = rng.random(0, m_hotspot_nodes.size() - 1);
+            return m_hotspot_nodes[idx];
+        }
+    } else if (m_type == RATE_MATRIX_) {
+        assert(m_source_rate > 0);
+        int idx = rng.random(0, m_num_dest - 1);
+        return (rng.uniform() < m_alias_prob[idx]) ? idx : m_alias[idx];
+    }
+
+    return rng.random(0, m_num_dest - 1);
+}
+
+bool
+injection_trial(double inj_rate, int precision, CounterRNG& rng)
+{
+    // make new request based on injection rate
+    // (injection rate's range depends on precision)
+    // - generate a random number between 0 and 10^precision
+    // - send pkt if this number is < injRate*(10^precision)
+    double injRange = pow((double) 10, (double) precision);
+    unsigned trySending = rng.random(0, (int) injRange);
+    return (trySending < inj_rate*injRange);
+}
+
+double
+injection_probability(double inj_rate, int precision)
+{
+    // number of draws in [0, injRange] below inj_rate*injRange
+    double injRange = pow((double) 10, (double) precision);
+    double num_draws = (int) injRange + 1;
+    double threshold = inj_rate*injRange;
+    if (threshold <= 0)
+        return 0;
+    return std::min(ceil(threshold), num_draws) / num_draws;
+}
+
+InjectionProcess::InjectionProcess(double inj_rate, int precision,
+                                   SkipAheadMode mode,
+                                   double burst_on_cycles,
+                                   double burst_off_cycles,
+                                   CounterRNG& rng)
+    : m_inj_rate(inj_rate), m_precision(precision), m_mode(mode),
+      m_bursty(false), m_leave_on_prob(1), m_leave_off_prob(1),
+      m_on(true), m_state_left(0)
+{
+    if ((m_mode < NO_SKIP_) || (m_mode >= NUM_SKIP_AHEAD_MODES_))
+        fatal("Unknown skip_ahead mode: %d\n", m_mode);
+
+    if ((burst_on_cycles <= 0) || (burst_off_cycles <= 0))
+        return;
+
+    if ((burst_on_cycles < 1) || (burst_off_cycles < 1))
+        fatal("mean burst on/off periods must be at least a cycle\n");
+
+    m_bursty = true;
+    m_inj_rate = inj_rate * (burst_on_cycles + burst_off_cycles) /
+        burst_on_cycles;
+    if (m_inj_rate > 1) {
+        fatal("injection rate %f needs %f while on: too high for the "
+              "burst on/off periods\n", inj_rate, m_inj_rate);
+    }
+    m_leave_on_prob = 1.0 / burst_on_cycles;
+    m_leave_off_prob = 1.0 / burst_off_cycles;
+
+    // start in the stationary distribution
+    m_on = (rng.uniform() <
+            burst_on_cycles / (burst_on_cycles + burst_off_cycles));
+    m_state_left = geometric(m_on ? m_leave_on_prob : m_leave_off_prob,
+                             rng);
+}
+
+// number of trials (>= 1) up to the first success
+uint64_t
+InjectionProcess::geometric(double p, CounterRNG& rng)
+{
+    assert(p > 0);
+    if (p >= 1)
+        return 1;
+    // inverse transform of the geometric distribution, u in (0, 1]
+    double u = 1.0 - rng.uniform();
+    return 1 + (uint64_t) floor(log(u) / log1p(-p));
+}
+
+void
+InjectionProcess::next_state(CounterRNG& rng)
+{
+    m_on = !m_on;
+    m_state_left = geometric(m_on ? m_leave_on_prob : m_leave_off_prob,
+                             rng);
+}
+
+bool
+InjectionProcess::trial(CounterRNG& rng)
+{
+    if (!m_bursty)
+        return injection_trial(m_inj_rate, m_precision, rng);
+
+    if (m_state_left == 0)
+        next_state(rng);
+    m_state_left--;
+    return m_on && injection_trial(m_inj_rate, m_precision, rng);
+}
+
+uint64_t
+InjectionProcess::gap(CounterRNG& rng)
+{
+    double p = injection_probability(m_inj_rate, m_precision);
+    if (p <= 0)
+        return INJECTION_NEVER;
+
+    if (m_mode == SKIP_SEED_COMPAT_) {
+        uint64_t gap = 1;
+        while (!trial(rng))
+            gap++;
+        return gap;
+    }
+
+    assert(m_mode == SKIP_GEOMETRIC_);
+    if (!m_bursty)
+        return geometric(p, rng);
+
+    // the process is memoryless within a state: sample the gap in
+    // the current on period, or skip to the next one
+    uint64_t gap = 0;
+    while (true) {
+        if (m_state_left == 0)
+            next_state(rng);
+        if (m_on) {
+            uint64_t g = geometric(p, rng);
+            if (g <= m_state_left) {
+                m_state_left -= g;
+                return gap + g;
+            }
+        }
+        gap += m_state_left;
+        m_state_left = 0;
+    }
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_TRAFFICPATTERN_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_TRAFFICPATTERN_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+
+// Synthetic traffic patterns, shared by the GarnetSyntheticTraffic
+// tester and the GarnetTrafficSource of a network interface
+enum TrafficType {BIT_COMPLEMENT_ = 0,
+                  BIT_REVERSE_ = 1,
+                  BIT_ROTATION_ = 2,
+                  NEIGHBOR_ = 3,
+                  SHUFFLE_ = 4,
+                  TORNADO_ = 5,
+                  TRANSPOSE_ = 6,
+                  UNIFORM_RANDOM_ = 7,
+                  HOTSPOT_ = 8,     // a fraction of the packets to a few
+                                    // nodes, the rest uniform random
+                  PERMUTATION_ = 9, // destinations read from a file
+                  RATE_MATRIX_ = 10,// per (source, dest) rates from a file
+                  NUM_TRAFFIC_PATTERNS_};
+
+// e.g. "uniform_random"; fatal if unknown
+TrafficType traffic_type_from_string(const std::string& traffic_type);
+
+struct TrafficPatternConfig
+{
+    std::string type;
+    int num_dest;
+    // the destinations are laid out as a mesh of num_rows rows for
+    // the coordinate based patterns; <= 0: a square mesh
+    int num_rows;
+    std::vector<int> hotspot_nodes;
+    double hotspot_fraction;
+    // whitespace separated destination of each source, in order
+    std::string permutation_file;
+    // num_dest x num_dest packets/cycle, one row per source
+    std::string rate_matrix_file;
+};
+
+// Destinations of the packets of one source. Fixed destinations are
+// computed once, and random ones drawn from precomputed tables
+// (Walker alias table for a rate matrix row), so a packet costs a
+// lookup and at most two draws.
+class TrafficPattern
+{
+  public:
+    TrafficPattern(const TrafficPatternConfig& config, int source);
+
+    // destination (0 .. num_dest-1) of the next packet
+    int destination(CounterRNG& rng);
+
+    // injection rate of this source from the rate matrix;
+    // -1 if the pattern does not set it
+    double source_rate() { return m_source_rate; }
+
+  private:
+    int fixed_destination(const TrafficPatternConfig& config);
+    void build_alias_table(const std::vector<double>& weights);
+
+    TrafficType m_type;
+    int m_source;
+    int m_num_dest;
+    int m_fixed_dest;
+
+    std::vector<int> m_hotspot_nodes;
+    double m_hotspot_fraction;
+
+    std::vector<double> m_alias_prob;
+    std::vector<int> m_alias;
+    double m_source_rate;
+};
+
+// Injection process: a Bernoulli trial every cycle, succeeding with
+// probability 'inj_rate' at 'precision' decimal digits.
+enum SkipAheadMode { NO_SKIP_ = 0,         // a trial every cycle
+                     SKIP_GEOMETRIC_ = 1,  // sample the gap directly
+                     SKIP_SEED_COMPAT_ = 2,// run the trials of the gap
+                     NUM_SKIP_AHEAD_MODES_};
+
+#define INJECTION_NEVER UINT64_MAX
+
+// the trial of one cycle
+bool injection_trial(double inj_rate, int precision, CounterRNG& rng);
+
+// exact success probability of injection_trial()
+double injection_probability(double inj_rate, int precision);
+
+// Injection process of a source, optionally bursty: a two-state
+// (on/off) Markov-modulated process whose mean on and off periods
+// are given in cycles; the rate while on is raised so that the
+// average stays 'inj_rate'.
+class InjectionProcess
+{
+  public:
+    InjectionProcess(double inj_rate, int precision, SkipAheadMode mode,
+                     double burst_on_cycles, double burst_off_cycles,
+                     CounterRNG& rng);
+
+    SkipAheadMode get_mode() { return m_mode; }
+
+    // whether to inject in the next cycle (NO_SKIP_)
+    bool trial(CounterRNG& rng);
+
+    // Cycles from the current cycle to the next injection (>= 1), or
+    // INJECTION_NEVER. SKIP_GEOMETRIC_ draws one number per gap (and
+    // per burst); with SKIP_SEED_COMPAT_ the draws (and so the packets
+    // for a seed) are the same as with a trial every cycle.
+    uint64_t gap(CounterRNG& rng);
+
+  private:
+    uint64_t geometric(double p, CounterRNG& rng);
+    void next_state(CounterRNG& rng);
+
+    double m_inj_rate; // while on, for a bursty process
+    int m_precision;
+    SkipAheadMode m_mode;
+
+    bool m_bursty;
+    double m_leave_on_prob;
+    double m_leave_off_prob;
+    bool m_on;
+    uint64_t m_state_left; // cycles left in the current state
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_TRAFFICPATTERN_HH__
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include "mem/ruby/network/garnet2.0/VcStateStore.hh"
+
+#include "base/logging.hh"
+
+VcStateStore::VcStateStore(int vcs_per_vnet)
+    : m_vcs_per_vnet(vcs_per_vnet)
+{
+    // one bit per vc of a vnet in the idle masks
+    if ((vcs_per_vnet < 1) || (vcs_per_vnet > 64))
+        fatal("%d vcs per vnet: between 1 and 64 are supported\n",
+              vcs_per_vnet);
+}
+
+int
+VcStateStore::add_input_vc()
+{
+    m_state.push_back(IDLE_);
+    m_occupancy.push_back(0);
+    m_outport.push_back(-1);
+    m_outvc.push_back(-1);
+    m_state_time.push_back(Cycles(0));
+    m_enqueue_time.push_back(Cycles(INFINITE_));
+    m_buffers.push_back(flitBuffer());
+    return m_state.size() - 1;
+}
+
+int
+VcStateStore::add_output_vc(int id, int max_credits)
+{
+    assert(max_credits >= 1);
+    int vc = m_out_state.size();
+    // ports have a whole number of vnets, and their vcs are added in
+    // order: the vcs of a vnet share their masks
+    assert((vc % m_vcs_per_vnet) == (id % m_vcs_per_vnet));
+    if (vc % m_vcs_per_vnet == 0) {
+        m_idle_mask.push_back(0);
+        m_vnet_credits.push_back(0);
+    }
+
+    m_out_state.push_back(IDLE_);
+    m_out_time.push_back(Cycles(0));
+    m_credits.push_back(max_credits);
+    m_max_credits.push_back(max_credits);
+    m_idle_mask.back() |= 1ULL << (vc % m_vcs_per_vnet);
+    m_vnet_credits.back() += max_credits;
+    return vc;
+}
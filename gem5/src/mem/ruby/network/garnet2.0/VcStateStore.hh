@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#ifndef __MEM_RUBY_NETWORK_GARNET2_0_VCSTATESTORE_HH__
+#define __MEM_RUBY_NETWORK_GARNET2_0_VCSTATESTORE_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "mem/ruby/network/garnet2.0/CommonTypes.hh"
+#include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+
+// State of every vc of the network, one array per field (structure
+// of arrays), indexed by a network-wide vc index:
+//  - input vcs of the routers: state, outport and outvc assignment,
+//    occupancy and flit buffer;
+//  - output vcs of the routers and NIs: state and credits of the
+//    input vc they feed downstream, with, for the vcs of each vnet
+//    of a port, a mask of the idle ones and their total credits.
+// The vcs of a port get consecutive indices, so the walks over the
+// vcs of a port or of the whole network (switch allocation, DRAIN)
+// read a few dense arrays rather than one heap object per vc, and
+// the free vc queries of routing and SA are a popcount or a find
+// first set on a mask.
+// VirtualChannel and OutVcState are views of an entry.
+class VcStateStore
+{
+  public:
+    VcStateStore(int vcs_per_vnet);
+
+    // a new input vc (idle and empty), or output vc 'id' of its port
+    // (idle, with 'max_credits' credits); returns its index
+    int add_input_vc();
+    int add_output_vc(int id, int max_credits);
+
+    int get_num_input_vcs() const { return m_state.size(); }
+    int get_num_output_vcs() const { return m_out_state.size(); }
+
+    // input vcs
+    VC_state_type
+    get_state(int vc) const
+    {
+        return (VC_state_type) m_state[vc];
+    }
+    Cycles get_state_time(int vc) const { return m_state_time[vc]; }
+    void
+    set_state(int vc, VC_state_type state, Cycles time)
+    {
+        m_state[vc] = state;
+        m_state_time[vc] = time;
+    }
+    void
+    set_idle(int vc, Cycles time)
+    {
+        set_state(vc, IDLE_, time);
+        m_enqueue_time[vc] = Cycles(INFINITE_);
+        m_outport[vc] = -1;
+        m_outvc[vc] = -1;
+    }
+    void
+    set_active(int vc, Cycles time)
+    {
+        set_state(vc, ACTIVE_, time);
+        m_enqueue_time[vc] = time;
+    }
+
+    int get_outport(int vc) const { return m_outport[vc]; }
+    void set_outport(int vc, int outport) { m_outport[vc] = outport; }
+    int get_outvc(int vc) const { return m_outvc[vc]; }
+    void set_outvc(int vc, int outvc) { m_outvc[vc] = outvc; }
+    Cycles get_enqueue_time(int vc) const { return m_enqueue_time[vc]; }
+    void set_enqueue_time(int vc, Cycles time) { m_enqueue_time[vc] = time; }
+
+    int get_size(int vc) const { return m_occupancy[vc]; }
+    bool is_empty(int vc) const { return (m_occupancy[vc] == 0); }
+    bool
+    is_ready(int vc, Cycles time)
+    {
+        return ((m_occupancy[vc] > 0) && m_buffers[vc].isReady(time));
+    }
+    bool
+    need_stage(int vc, flit_stage stage, Cycles time)
+    {
+        if (!is_ready(vc, time))
+            return false;
+        assert((m_state[vc] == ACTIVE_) && (m_state_time[vc] <= time));
+        return m_buffers[vc].peekTopFlit()->is_stage(stage, time);
+    }
+
+    void
+    insert_flit(int vc, flit *t_flit)
+    {
+        assert(m_occupancy[vc] < UINT16_MAX);
+        m_buffers[vc].insert(t_flit);
+        m_occupancy[vc]++;
+    }
+    flit *peek_top_flit(int vc) { return m_buffers[vc].peekTopFlit(); }
+    flit *
+    get_top_flit(int vc)
+    {
+        m_occupancy[vc]--;
+        return m_buffers[vc].getTopFlit();
+    }
+    flitBuffer *get_buffer(int vc) { return &m_buffers[vc]; }
+
+    // output vcs
+    bool
+    is_out_vc_in_state(int vc, VC_state_type state, Cycles time) const
+    {
+        return ((m_out_state[vc] == state) && (time >= m_out_time[vc]));
+    }
+    void
+    set_out_state(int vc, VC_state_type state, Cycles time)
+    {
+        uint64_t bit = 1ULL << (vc % m_vcs_per_vnet);
+        if (state == IDLE_)
+            m_idle_mask[vc / m_vcs_per_vnet] |= bit;
+        else
+            m_idle_mask[vc / m_vcs_per_vnet] &= ~bit;
+        m_out_state[vc] = state;
+        m_out_time[vc] = time;
+    }
+
+    // The output vcs [first, first + num) are all of one vnet. The
+    // states of the output vcs change at the current cycle of their
+    // router or NI, the cycle of these queries: the time condition
+    // of is_out_vc_in_state() holds for all of them.
+    int
+    get_num_idle_out_vcs(int first, int num) const
+    {
+        return popCount(idle_mask(first, num));
+    }
+    // the first idle one, or -1
+    int
+    find_idle_out_vc(int first, int num) const
+    {
+        uint64_t mask = idle_mask(first, num);
+        return (mask == 0) ? -1 : (first + findLsbSet(mask));
+    }
+    // total credits of the output vcs of the vnet of 'vc'
+    int
+    get_vnet_credit_count(int vc) const
+    {
+        return m_vnet_credits[vc / m_vcs_per_vnet];
+    }
+
+    int get_credit_count(int vc) const { return m_credits[vc]; }
+    bool has_credit(int vc) const { return (m_credits[vc] > 0); }
+    void
+    increment_credit(int vc)
+    {
+        m_credits[vc]++;
+        m_vnet_credits[vc / m_vcs_per_vnet]++;
+        assert(m_credits[vc] <= m_max_credits[vc]);
+    }
+    void
+    decrement_credit(int vc)
+    {
+        m_credits[vc]--;
+        m_vnet_credits[vc / m_vcs_per_vnet]--;
+        assert(m_credits[vc] >= 0);
+    }
+
+  private:
+    uint64_t
+    idle_mask(int first, int num) const
+    {
+        int shift = first % m_vcs_per_vnet;
+        assert(shift + num <= m_vcs_per_vnet);
+        if (num <= 0)
+            return 0;
+        uint64_t mask = m_idle_mask[first / m_vcs_per_vnet] >> shift;
+        return (num == 64) ? mask : (mask & ((1ULL << num) - 1));
+    }
+
+    int m_vcs_per_vnet;
+
+    // input vcs
+    std::vector<uint8_t> m_state;
+    std::vector<uint16_t> m_occupancy; // flits in m_buffers
+    std::vector<int16_t> m_outport;
+    std::vector<int16_t> m_outvc;
+    std::vector<Cycles> m_state_time;
+    std::vector<Cycles> m_enqueue_time;
+    std::vector<flitBuffer> m_buffers;
+
+    // output vcs
+    std::vector<uint8_t> m_out_state;
+    std::vector<Cycles> m_out_time;
+    std::vector<int32_t> m_credits;
+    std::vector<int32_t> m_max_credits;
+    // per vnet of each port, i.e., per m_vcs_per_vnet output vcs:
+    // bit i is set if its vc i is idle; total credits of its vcs
+    std::vector<uint64_t> m_idle_mask;
+    std::vector<int32_t> m_vnet_credits;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET2_0_VCSTATESTORE_HH__
@@ -33,53 +33,13 @@
 
 #include "mem/ruby/network/garnet2.0/VirtualChannel.hh"
 
-VirtualChannel::VirtualChannel(int id)
-    : m_enqueue_time(INFINITE_)
+VirtualChannel::VirtualChannel(int id, VcStateStore *store)
+    : m_id(id), m_store(store), m_index(store->add_input_vc())
 {
-    m_id = id;
-    m_input_buffer = new flitBuffer();
-    m_vc_state.first = IDLE_;
-    m_vc_state.second = Cycles(0);
-    m_output_vc = -1;
-    m_output_port = -1;
-}
-
-VirtualChannel::~VirtualChannel()
-{
-    delete m_input_buffer;
-}
-
-void
-VirtualChannel::set_idle(Cycles curTime)
-{
-    m_vc_state.first = IDLE_;
-    m_vc_state.second = curTime;
-    m_enqueue_time = Cycles(INFINITE_);
-    m_output_port = -1;
-    m_output_vc = -1;
-}
-
-void
-VirtualChannel::set_active(Cycles curTime)
-{
-    m_vc_state.first = ACTIVE_;
-    m_vc_state.second = curTime;
-    m_enqueue_time = curTime;
-}
-
-bool
-VirtualChannel::need_stage(flit_stage stage, Cycles time)
-{
-    if (m_input_buffer->isReady(time)) {
-        assert(m_vc_state.first == ACTIVE_ && m_vc_state.second <= time);
-        flit *t_flit = m_input_buffer->peekTopFlit();
-        return(t_flit->is_stage(stage, time));
-    }
-    return false;
 }
 
 uint32_t
 VirtualChannel::functionalWrite(Packet *pkt)
 {
-    return m_input_buffer->functionalWrite(pkt);
+    return m_store->get_buffer(m_index)->functionalWrite(pkt);
 }
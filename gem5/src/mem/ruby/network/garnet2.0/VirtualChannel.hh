@@ -34,69 +34,89 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET2_0_VIRTUALCHANNEL_HH__
 #define __MEM_RUBY_NETWORK_GARNET2_0_VIRTUALCHANNEL_HH__
 
-#include <utility>
-
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
-#include "mem/ruby/network/garnet2.0/flitBuffer.hh"
+#include "mem/ruby/network/garnet2.0/VcStateStore.hh"
 
+// An input vc of a router: a view of its entry in the VcStateStore
+// of the network
 class VirtualChannel
 {
   public:
-    VirtualChannel(int id);
-    ~VirtualChannel();
+    VirtualChannel(int id, VcStateStore *store);
 
-    bool need_stage(flit_stage stage, Cycles time);
-    void set_idle(Cycles curTime);
-    void set_active(Cycles curTime);
-    void set_outvc(int outvc)               { m_output_vc = outvc; }
-    inline int get_outvc()                  { return m_output_vc; }
-    void set_outport(int outport)           { m_output_port = outport; };
-    inline int get_outport()                  { return m_output_port; }
+    bool
+    need_stage(flit_stage stage, Cycles time)
+    {
+        return m_store->need_stage(m_index, stage, time);
+    }
+    void set_idle(Cycles curTime)     { m_store->set_idle(m_index, curTime); }
+    void
+    set_active(Cycles curTime)
+    {
+        m_store->set_active(m_index, curTime);
+    }
+    void set_outvc(int outvc)         { m_store->set_outvc(m_index, outvc); }
+    inline int get_outvc()            { return m_store->get_outvc(m_index); }
+    void
+    set_outport(int outport)
+    {
+        m_store->set_outport(m_index, outport);
+    }
+    inline int get_outport()          { return m_store->get_outport(m_index); }
 
-    inline Cycles get_enqueue_time()          { return m_enqueue_time; }
-    inline void set_enqueue_time(Cycles time) { m_enqueue_time = time; }
-    inline VC_state_type get_state()        { return m_vc_state.first; }
-    inline bool isEmpty()                   { return m_input_buffer->isEmpty(); }
+    inline Cycles
+    get_enqueue_time()
+    {
+        return m_store->get_enqueue_time(m_index);
+    }
+    inline void
+    set_enqueue_time(Cycles time)
+    {
+        m_store->set_enqueue_time(m_index, time);
+    }
+    inline VC_state_type get_state() { return m_store->get_state(m_index); }
+    inline bool isEmpty()             { return m_store->is_empty(m_index); }
+    inline int get_size()             { return m_store->get_size(m_index); }
 
-    inline bool isReady(Cycles curTime)
+    inline bool
+    isReady(Cycles curTime)
     {
-        return m_input_buffer->isReady(curTime);
+        return m_store->is_ready(m_index, curTime);
     }
 
     inline void
     insertFlit(flit *t_flit)
     {
-        m_input_buffer->insert(t_flit);
+        m_store->insert_flit(m_index, t_flit);
     }
 
     inline void
     set_state(VC_state_type m_state, Cycles curTime)
     {
-        m_vc_state.first = m_state;
-        m_vc_state.second = curTime;
+        m_store->set_state(m_index, m_state, curTime);
     }
 
     inline flit*
     peekTopFlit()
     {
-        return m_input_buffer->peekTopFlit();
+        return m_store->peek_top_flit(m_index);
     }
 
     inline flit*
     getTopFlit()
     {
-        return m_input_buffer->getTopFlit();
+        return m_store->get_top_flit(m_index);
     }
 
+    // index of this vc in the store
+    int get_index() const { return m_index; }
+
     uint32_t functionalWrite(Packet *pkt);
 
   private:
     int m_id;
-    flitBuffer *m_input_buffer;
-    std::pair<VC_state_type, Cycles> m_vc_state;
-    int m_output_port;
-    Cycles m_enqueue_time;
-    int m_output_vc;
+    VcStateStore *m_store;
+    int m_index;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET2_0_VIRTUALCHANNEL_HH__
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+
+TEST(CounterRNGTest, SameSeedSameSequence)
+{
+    CounterRNG a(42, 3), b(42, 3);
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(a.next(), b.next());
+    EXPECT_EQ(a.get_counter(), 100);
+}
+
+TEST(CounterRNGTest, SeedsAndStreamsDiffer)
+{
+    EXPECT_NE(CounterRNG(1).next(), CounterRNG(2).next());
+    EXPECT_NE(CounterRNG(1, 0).next(), CounterRNG(1, 1).next());
+}
+
+// A draw only depends on its position in its own stream
+TEST(CounterRNGTest, DrawsArePositional)
+{
+    CounterRNG root(7);
+    CounterRNG a = root.split(DRAIN_RNG_), b = root.split(ROUTING_RNG_);
+    std::vector<uint64_t> alone;
+    for (int i = 0; i < 10; i++)
+        alone.push_back(a.at(i));
+
+    // interleaving draws from another stream changes nothing
+    for (int i = 0; i < 10; i++) {
+        b.next();
+        EXPECT_EQ(a.next(), alone[i]);
+        b.next();
+    }
+}
+
+TEST(CounterRNGTest, SplitIsDeterministic)
+{
+    CounterRNG root(11);
+    root.next();
+    CounterRNG a = root.split(TRAFFIC_RNG_).split(5);
+    CounterRNG b = CounterRNG(11).split(TRAFFIC_RNG_).split(5);
+    // a child starts at the beginning of its stream
+    EXPECT_EQ(a.get_counter(), 0);
+    for (int i = 0; i < 10; i++)
+        EXPECT_EQ(a.next(), b.next());
+
+    std::set<uint64_t> firsts;
+    for (int id = 0; id < 64; id++)
+        firsts.insert(CounterRNG(11).split(TRAFFIC_RNG_).split(id).next());
+    EXPECT_EQ(firsts.size(), 64);
+}
+
+TEST(CounterRNGTest, RandomStaysInRange)
+{
+    CounterRNG rng(3);
+    std::vector<int> counts(7, 0);
+    for (int i = 0; i < 7000; i++) {
+        uint64_t r = rng.random(10, 16);
+        ASSERT_GE(r, 10);
+        ASSERT_LE(r, 16);
+        counts[r - 10]++;
+    }
+    // roughly uniform: 1000 expected per value
+    for (int i = 0; i < 7; i++) {
+        EXPECT_GT(counts[i], 800);
+        EXPECT_LT(counts[i], 1200);
+    }
+    EXPECT_EQ(rng.random(5, 5), 5);
+}
+
+TEST(CounterRNGTest, UniformIsInUnitInterval)
+{
+    CounterRNG rng(9);
+    double sum = 0;
+    for (int i = 0; i < 10000; i++) {
+        double u = rng.uniform();
+        ASSERT_GE(u, 0.0);
+        ASSERT_LT(u, 1.0);
+        sum += u;
+    }
+    EXPECT_NEAR(sum / 10000, 0.5, 0.02);
+}
@@ -53,6 +53,14 @@ flit::flit()
     m_outport_dir = "Unknown";
     hops_needed_before_spin = -1;
     hops_needed_after_spin = -1;
+    m_drain_count = 0;
+    m_drain_misroutes = 0;
+    m_req_id = -1;
+    m_is_resp = false;
+    m_packet_id = 0;
+    m_la_router = m_la_inport = m_la_outport = -1;
+    m_bypass = false;
+    m_smart_hops = 0;
 
 }
 
@@ -76,6 +84,14 @@ flit::flit(int id, int  vc, int vnet, RouteInfo route, int size,
     hops_needed_after_spin = -1;
     m_marked = marked;
     m_request_uturn = false;
+    m_drain_count = 0;
+    m_drain_misroutes = 0;
+    m_req_id = -1;
+    m_is_resp = false;
+    m_packet_id = 0;
+    m_la_router = m_la_inport = m_la_outport = -1;
+    m_bypass = false;
+    m_smart_hops = 0;
 
     if (size == 1) {
         m_type = HEAD_TAIL_;
@@ -112,6 +128,9 @@ flit::print(std::ostream& out) const
 bool
 flit::functionalWrite(Packet *pkt)
 {
+    // trace packets carry no message
+    if (m_msg_ptr == nullptr)
+        return false;
     Message *msg = m_msg_ptr.get();
     return msg->functionalWrite(pkt);
 }
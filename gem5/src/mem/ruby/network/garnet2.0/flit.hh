@@ -75,6 +75,44 @@ class flit
     void set_dequeue_time(Cycles time) { m_dequeue_time = time; }
 
     void increment_hops() { m_route.hops_traversed++; }
+
+    // forward-progress tracking across DRAIN spins
+    void
+    increment_drain_count(bool misrouted)
+    {
+        m_drain_count++;
+        if (misrouted)
+            m_drain_misroutes++;
+    }
+    int get_drain_count() { return m_drain_count; }
+    int get_drain_misroutes() { return m_drain_misroutes; }
+
+    // closed-loop direct traffic: id of the request (-1 for other
+    // packets), carried back by its response
+    int64_t get_req_id() { return m_req_id; }
+    bool is_response() { return m_is_resp; }
+    // deflection routing: flits of a packet arrive in any order and
+    // are reassembled by (source NI, packet id)
+    uint64_t get_packet_id() { return m_packet_id; }
+    void set_type(flit_type type) { m_type = type; }
+
+    // lookahead routing: outport at inport 'inport' of router
+    // 'router', computed by the upstream router; -1 if the flit
+    // arrives elsewhere (or no lookahead was computed)
+    void
+    set_lookahead(int router, int inport, int outport)
+    {
+        m_la_router = router;
+        m_la_inport = inport;
+        m_la_outport = outport;
+    }
+    int
+    get_lookahead_outport(int router, int inport)
+    {
+        if ((m_la_router != router) || (m_la_inport != inport))
+            return -1;
+        return m_la_outport;
+    }
     void print(std::ostream& out) const;
 
     bool
@@ -107,6 +145,14 @@ class flit
     bool m_request_uturn; // set it inside flit
     int hops_needed_before_spin;
     int hops_needed_after_spin;
+    int m_drain_count; // times this flit was moved by a DRAIN spin
+    int m_drain_misroutes; // ... of which the move was not productive
+    int64_t m_req_id;
+    bool m_is_resp;
+    uint64_t m_packet_id;
+    int m_la_router, m_la_inport, m_la_outport;
+    bool m_bypass; // on the bypass path of the router it just reached
+    int m_smart_hops; // links crossed in the current cycle (SMART)
   // protected:
     int m_id;
     int m_vnet;
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "mem/ruby/network/garnet2.0/FlitStatsAccumulator.hh"
+
+// the sample(value, count) interface of a Stats::Histogram
+struct CountingHistogram
+{
+    std::map<uint64_t, int64_t> counts;
+
+    void sample(uint64_t val, int count) { counts[val] += count; }
+};
+
+// What GarnetNetwork::merge_flit_stats() adds up, in plain values
+struct FlitStatsTotals
+{
+    std::vector<uint64_t> flits_received, packets_received;
+    std::vector<uint64_t> flit_network_latency, packet_queueing_latency;
+    uint64_t total_hops;
+    std::vector<uint64_t> network_latency_histogram;
+    CountingHistogram latency_hist, network_latency_hist;
+    CountingHistogram queueing_latency_hist, drain_count_hist;
+    Cycles max_latency, min_latency, max_age;
+    int max_drain_count;
+
+    FlitStatsTotals(int num_vnets)
+        : flits_received(num_vnets, 0), packets_received(num_vnets, 0),
+          flit_network_latency(num_vnets, 0),
+          packet_queueing_latency(num_vnets, 0), total_hops(0),
+          network_latency_histogram(21, 0), max_latency(0),
+          min_latency(MaxTick), max_age(0), max_drain_count(0)
+    {}
+
+    void
+    merge(FlitStatsAccumulator& flit_stats)
+    {
+        for (int vnet = 0; vnet < flits_received.size(); vnet++) {
+            flits_received[vnet] += flit_stats.flits_received[vnet];
+            packets_received[vnet] += flit_stats.packets_received[vnet];
+            flit_network_latency[vnet] +=
+                flit_stats.flit_network_latency[vnet];
+            packet_queueing_latency[vnet] +=
+                flit_stats.packet_queueing_latency[vnet];
+        }
+        total_hops += flit_stats.total_hops;
+        for (int i = 0; i < network_latency_histogram.size(); i++)
+            network_latency_histogram[i] +=
+                flit_stats.network_latency_histogram[i];
+        flit_stats.latency_hist.flush(latency_hist);
+        flit_stats.network_latency_hist.flush(network_latency_hist);
+        flit_stats.queueing_latency_hist.flush(queueing_latency_hist);
+        flit_stats.drain_count_hist.flush(drain_count_hist);
+        max_latency = std::max(max_latency, flit_stats.max_latency);
+        min_latency = std::min(min_latency, flit_stats.min_latency);
+        max_age = std::max(max_age, flit_stats.max_age);
+        max_drain_count = std::max(max_drain_count,
+                                   flit_stats.max_drain_count);
+        flit_stats.clear();
+    }
+
+    bool
+    operator==(const FlitStatsTotals& other) const
+    {
+        return (flits_received == other.flits_received) &&
+            (packets_received == other.packets_received) &&
+            (flit_network_latency == other.flit_network_latency) &&
+            (packet_queueing_latency == other.packet_queueing_latency) &&
+            (total_hops == other.total_hops) &&
+            (network_latency_histogram ==
+             other.network_latency_histogram) &&
+            (latency_hist.counts == other.latency_hist.counts) &&
+            (network_latency_hist.counts ==
+             other.network_latency_hist.counts) &&
+            (queueing_latency_hist.counts ==
+             other.queueing_latency_hist.counts) &&
+            (drain_count_hist.counts == other.drain_count_hist.counts) &&
+            (max_latency == other.max_latency) &&
+            (min_latency == other.min_latency) &&
+            (max_age == other.max_age) &&
+            (max_drain_count == other.max_drain_count);
+    }
+};
+
+struct FlitSample
+{
+    int vnet;
+    Cycles network_delay, queueing_delay, age;
+    int hops, drain_count;
+    bool is_tail;
+};
+
+static const int num_vnets = 3;
+
+// latencies mostly in the dense range of the histograms, some above
+static std::vector<FlitSample>
+random_samples(CounterRNG& rng, int num_samples)
+{
+    std::vector<FlitSample> samples(num_samples);
+    for (int i = 0; i < num_samples; i++) {
+        FlitSample& s = samples[i];
+        s.vnet = rng.random(0, num_vnets - 1);
+        s.network_delay = Cycles(rng.random(1, rng.uniform() < 0.1 ?
+                                                1000 : 100));
+        s.queueing_delay = Cycles(rng.random(0, 200));
+        s.age = Cycles(s.network_delay + s.queueing_delay +
+                       rng.random(0, 10));
+        s.hops = rng.random(0, 14);
+        s.drain_count = rng.random(0, 20);
+        s.is_tail = rng.uniform() < 0.4;
+    }
+    return samples;
+}
+
+static void
+sample(FlitStatsAccumulator& flit_stats, const FlitSample& s)
+{
+    flit_stats.sample(s.vnet, s.network_delay, s.queueing_delay, s.age,
+                      s.hops, s.drain_count, s.is_tail);
+}
+
+TEST(LocalHistogramTest, FlushCountsEveryValue)
+{
+    LocalHistogram local(16);
+    uint64_t values[] = {0, 3, 3, 15, 16, 1000000, 16};
+    for (int i = 0; i < 7; i++)
+        local.sample(values[i]);
+
+    CountingHistogram hist;
+    local.flush(hist);
+    std::map<uint64_t, int64_t> expected = {{0, 1}, {3, 2}, {15, 1},
+                                            {16, 2}, {1000000, 1}};
+    EXPECT_EQ(hist.counts, expected);
+
+    // a flush empties the local histogram
+    CountingHistogram empty;
+    local.flush(empty);
+    EXPECT_TRUE(empty.counts.empty());
+    local.sample(2);
+    local.flush(hist);
+    EXPECT_EQ(hist.counts[2], 1);
+}
+
+TEST(FlitStatsAccumulatorTest, SampleCounters)
+{
+    FlitStatsAccumulator flit_stats(num_vnets);
+    flit_stats.sample(1, Cycles(12), Cycles(3), Cycles(20), 4, 0, false);
+    flit_stats.sample(1, Cycles(14), Cycles(1), Cycles(22), 4, 2, true);
+
+    EXPECT_EQ(flit_stats.num_flits, 2);
+    EXPECT_EQ(flit_stats.flits_received[1], 2);
+    EXPECT_EQ(flit_stats.packets_received[1], 1);
+    EXPECT_EQ(flit_stats.flit_network_latency[1], 26);
+    EXPECT_EQ(flit_stats.packet_queueing_latency[1], 1);
+    EXPECT_EQ(flit_stats.total_hops, 8);
+    EXPECT_EQ(flit_stats.network_latency_histogram[2], 2);
+    EXPECT_EQ(uint64_t(flit_stats.max_latency), 15);
+    EXPECT_EQ(uint64_t(flit_stats.min_latency), 15);
+    EXPECT_EQ(uint64_t(flit_stats.max_age), 22);
+    EXPECT_EQ(flit_stats.max_drain_count, 2);
+
+    flit_stats.clear();
+    EXPECT_EQ(flit_stats.num_flits, 0);
+    EXPECT_EQ(flit_stats.flits_received[1], 0);
+    EXPECT_EQ(uint64_t(flit_stats.min_latency), MaxTick);
+}
+
+// The samples ejected at several NIs, merged from time to time in
+// any NI order, add up to the same stats as one stream of samples
+TEST(FlitStatsAccumulatorTest, MergeOrderDoesNotMatter)
+{
+    CounterRNG rng(5);
+    std::vector<FlitSample> samples = random_samples(rng, 5000);
+
+    FlitStatsTotals expected(num_vnets);
+    FlitStatsAccumulator all(num_vnets);
+    for (int i = 0; i < samples.size(); i++)
+        sample(all, samples[i]);
+    expected.merge(all);
+
+    for (int trial = 0; trial < 20; trial++) {
+        const int num_nis = 4;
+        std::vector<FlitStatsAccumulator> nis(num_nis,
+                                              FlitStatsAccumulator(num_vnets));
+        std::vector<int> order(num_nis);
+        for (int ni = 0; ni < num_nis; ni++)
+            order[ni] = ni;
+
+        FlitStatsTotals totals(num_vnets);
+        for (int i = 0; i < samples.size(); i++) {
+            sample(nis[rng.random(0, num_nis - 1)], samples[i]);
+            // a collation or reset merges every NI, in some order
+            if (rng.uniform() < 0.01) {
+                for (int ni = num_nis - 1; ni > 0; ni--)
+                    std::swap(order[ni], order[rng.random(0, ni)]);
+                for (int ni = 0; ni < num_nis; ni++)
+                    totals.merge(nis[order[ni]]);
+            }
+        }
+        for (int ni = num_nis - 1; ni >= 0; ni--)
+            totals.merge(nis[ni]);
+
+        EXPECT_TRUE(totals == expected) << "trial " << trial;
+    }
+}
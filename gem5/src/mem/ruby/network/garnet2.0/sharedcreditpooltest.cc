@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "mem/ruby/network/garnet2.0/SharedCreditPool.hh"
+
+TEST(SharedCreditPoolTest, EmptyPool)
+{
+    // 4 vcs, 10 slots: 1 reserved per vc, 6 shared
+    SharedCreditPool pool(4, 10, 1);
+    for (int vc = 0; vc < 4; vc++) {
+        EXPECT_TRUE(pool.has_credit(vc));
+        EXPECT_EQ(pool.get_credit_count(vc), 7);
+    }
+}
+
+// a vc taking every shared slot leaves the others their reserved ones
+TEST(SharedCreditPoolTest, ReservedSlotsStayFree)
+{
+    SharedCreditPool pool(4, 12, 2);
+    int sent = 0;
+    while (pool.has_credit(0)) {
+        pool.decrement_credit(0);
+        sent++;
+    }
+    EXPECT_EQ(sent, 2 + 4);
+    EXPECT_EQ(pool.get_credit_count(0), 0);
+    for (int vc = 1; vc < 4; vc++) {
+        EXPECT_TRUE(pool.has_credit(vc));
+        EXPECT_EQ(pool.get_credit_count(vc), 2);
+    }
+
+    // a flit in a reserved slot of vc 1 frees no shared slot
+    pool.decrement_credit(1);
+    pool.increment_credit(1);
+    EXPECT_FALSE(pool.has_credit(0));
+    // one leaving vc 0 does
+    pool.increment_credit(0);
+    EXPECT_TRUE(pool.has_credit(0));
+    EXPECT_EQ(pool.get_credit_count(1), 3);
+}
+
+// Flits sent only with a credit never overflow the port, and the
+// credits match a count of the slots in use
+TEST(SharedCreditPoolTest, RandomTraffic)
+{
+    const int num_vcs = 4, num_slots = 16, reserved = 2;
+    SharedCreditPool pool(num_vcs, num_slots, reserved);
+    std::vector<int> occupancy(num_vcs, 0);
+    CounterRNG rng(1);
+    for (int step = 0; step < 100000; step++) {
+        int vc = rng.random(0, num_vcs - 1);
+        if (rng.uniform() < 0.55) {
+            if (pool.has_credit(vc)) {
+                pool.decrement_credit(vc);
+                occupancy[vc]++;
+            }
+        } else if (occupancy[vc] > 0) {
+            pool.increment_credit(vc);
+            occupancy[vc]--;
+        }
+
+        int total = 0, shared_used = 0;
+        for (int v = 0; v < num_vcs; v++) {
+            total += occupancy[v];
+            shared_used += std::max(occupancy[v] - reserved, 0);
+        }
+        ASSERT_LE(total, num_slots);
+        int shared_free = num_slots - num_vcs * reserved - shared_used;
+        for (int v = 0; v < num_vcs; v++) {
+            int count = std::max(reserved - occupancy[v], 0) + shared_free;
+            ASSERT_EQ(pool.get_credit_count(v), count);
+            ASSERT_EQ(pool.has_credit(v), count > 0);
+        }
+    }
+}
+
+// a DRAIN spin may overcommit the pool; the credits come back as the
+// flits leave
+TEST(SharedCreditPoolTest, Overcommit)
+{
+    SharedCreditPool pool(2, 4, 1);
+    for (int i = 0; i < 5; i++)
+        pool.decrement_credit(0);
+    EXPECT_FALSE(pool.has_credit(0));
+    EXPECT_EQ(pool.get_credit_count(0), 0);
+    EXPECT_TRUE(pool.has_credit(1));
+    EXPECT_EQ(pool.get_credit_count(1), 1);
+
+    for (int i = 0; i < 4; i++)
+        pool.increment_credit(0);
+    EXPECT_EQ(pool.get_credit_count(0), 2);
+    pool.increment_credit(0);
+    EXPECT_EQ(pool.get_credit_count(0), 3);
+    EXPECT_EQ(pool.get_credit_count(1), 3);
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/CounterRNG.hh"
+#include "mem/ruby/network/garnet2.0/SwitchArbiter.hh"
+
+// fatal() adds a failure and throws (see base/gtest/logging.cc)
+#define EXPECT_FATAL(statement, message)                        \
+    EXPECT_NONFATAL_FAILURE({ try { statement; } catch (...) {} }, message)
+
+static const char *arbiters[] = {"separable", "islip", "wavefront",
+                                 "oldest_first"};
+static const int num_ports = 5;
+
+// Up to 'max_vcs' requests per inport for random outports, in inport
+// order, as SA-I places them
+static std::vector<SwitchRequest>
+random_requests(CounterRNG& rng, int max_vcs, double escalated_prob)
+{
+    std::vector<SwitchRequest> requests;
+    for (int inport = 0; inport < num_ports; inport++) {
+        int num_vcs = rng.random(0, max_vcs);
+        for (int vc = 0; vc < num_vcs; vc++) {
+            requests.push_back(SwitchRequest(inport, vc,
+                rng.random(0, num_ports - 1), Cycles(rng.random(0, 100)),
+                rng.uniform() < escalated_prob));
+        }
+    }
+    return requests;
+}
+
+// what the allocator gives an arbiter wanting one request per inport
+static std::vector<SwitchRequest>
+arbiter_requests(SwitchArbiter *arbiter,
+                 const std::vector<SwitchRequest>& requests)
+{
+    if (!arbiter->one_request_per_inport())
+        return requests;
+    std::vector<SwitchRequest> first;
+    for (int i = 0; i < requests.size(); i++) {
+        if (first.empty() || (first.back().inport != requests[i].inport))
+            first.push_back(requests[i]);
+    }
+    return first;
+}
+
+static bool
+augment(int inport, const std::vector<std::vector<bool> >& edges,
+        std::vector<int>& matched_inport, std::vector<bool>& visited)
+{
+    for (int outport = 0; outport < num_ports; outport++) {
+        if (!edges[inport][outport] || visited[outport])
+            continue;
+        visited[outport] = true;
+        if ((matched_inport[outport] == -1) ||
+            augment(matched_inport[outport], edges, matched_inport,
+                    visited)) {
+            matched_inport[outport] = inport;
+            return true;
+        }
+    }
+    return false;
+}
+
+// size of a maximum matching of the requests (augmenting paths)
+static int
+max_matching(const std::vector<SwitchRequest>& requests)
+{
+    std::vector<std::vector<bool> > edges(num_ports,
+        std::vector<bool>(num_ports, false));
+    for (int i = 0; i < requests.size(); i++)
+        edges[requests[i].inport][requests[i].outport] = true;
+    std::vector<int> matched_inport(num_ports, -1);
+    int size = 0;
+    for (int inport = 0; inport < num_ports; inport++) {
+        std::vector<bool> visited(num_ports, false);
+        size += augment(inport, edges, matched_inport, visited);
+    }
+    return size;
+}
+
+// every grant is a request, and no port is granted twice
+static void
+expect_matching(const std::vector<SwitchRequest>& requests,
+                const std::vector<SwitchRequest>& grants)
+{
+    std::vector<bool> inport_used(num_ports, false);
+    std::vector<bool> outport_used(num_ports, false);
+    for (int g = 0; g < grants.size(); g++) {
+        bool requested = false;
+        for (int i = 0; i < requests.size(); i++) {
+            requested |= ((requests[i].inport == grants[g].inport) &&
+                          (requests[i].invc == grants[g].invc) &&
+                          (requests[i].outport == grants[g].outport));
+        }
+        EXPECT_TRUE(requested);
+        EXPECT_FALSE(inport_used[grants[g].inport]);
+        EXPECT_FALSE(outport_used[grants[g].outport]);
+        inport_used[grants[g].inport] = true;
+        outport_used[grants[g].outport] = true;
+    }
+}
+
+// no request is left with both of its ports free
+static bool
+is_maximal(const std::vector<SwitchRequest>& requests,
+           const std::vector<SwitchRequest>& grants)
+{
+    std::vector<bool> inport_used(num_ports, false);
+    std::vector<bool> outport_used(num_ports, false);
+    for (int g = 0; g < grants.size(); g++) {
+        inport_used[grants[g].inport] = true;
+        outport_used[grants[g].outport] = true;
+    }
+    for (int i = 0; i < requests.size(); i++) {
+        if (!inport_used[requests[i].inport] &&
+            !outport_used[requests[i].outport])
+            return false;
+    }
+    return true;
+}
+
+TEST(SwitchArbiterTest, GrantsAreMatchings)
+{
+    for (int a = 0; a < 4; a++) {
+        std::unique_ptr<SwitchArbiter> arbiter(
+            SwitchArbiter::create(arbiters[a], num_ports, num_ports,
+                                  num_ports));
+        CounterRNG rng(1);
+        for (int cycle = 0; cycle < 1000; cycle++) {
+            std::vector<SwitchRequest> requests =
+                random_requests(rng, 4, 0.05);
+            std::vector<SwitchRequest> seen =
+                arbiter_requests(arbiter.get(), requests);
+            std::vector<SwitchRequest> grants;
+            arbiter->allocate(seen, grants);
+            expect_matching(seen, grants);
+            // no allocator beats a maximum matching
+            EXPECT_LE(grants.size(), max_matching(requests)) << arbiters[a];
+            // the allocators other than separable see every request
+            // and leave none that could still be granted
+            if (a > 0) {
+                EXPECT_TRUE(is_maximal(seen, grants)) << arbiters[a];
+            }
+        }
+    }
+}
+
+// the maximum matching the allocator stats compare against is at
+// least what separable allocation finds
+TEST(SwitchArbiterTest, MaxMatchingBoundsSeparable)
+{
+    std::unique_ptr<SwitchArbiter> arbiter(
+        SwitchArbiter::create("separable", num_ports, num_ports, 1));
+    CounterRNG rng(2);
+    for (int cycle = 0; cycle < 1000; cycle++) {
+        std::vector<SwitchRequest> requests = random_requests(rng, 4, 0);
+        std::vector<SwitchRequest> grants;
+        arbiter->allocate(arbiter_requests(arbiter.get(), requests),
+                          grants);
+        EXPECT_GE(max_matching(requests), grants.size());
+    }
+}
+
+TEST(SwitchArbiterTest, EscalatedFirst)
+{
+    for (int a = 0; a < 4; a++) {
+        std::unique_ptr<SwitchArbiter> arbiter(
+            SwitchArbiter::create(arbiters[a], num_ports, num_ports, 1));
+        // the old request of inport 0 would win oldest-first
+        std::vector<SwitchRequest> requests;
+        requests.push_back(SwitchRequest(0, 0, 2, Cycles(1), false));
+        requests.push_back(SwitchRequest(3, 0, 2, Cycles(9), true));
+        std::vector<SwitchRequest> grants;
+        arbiter->allocate(requests, grants);
+        ASSERT_EQ(grants.size(), 1) << arbiters[a];
+        EXPECT_EQ(grants[0].inport, 3) << arbiters[a];
+    }
+}
+
+TEST(SwitchArbiterTest, OldestFirstGrantsOldest)
+{
+    std::unique_ptr<SwitchArbiter> arbiter(
+        SwitchArbiter::create("oldest_first", num_ports, num_ports, 1));
+    CounterRNG rng(3);
+    for (int cycle = 0; cycle < 1000; cycle++) {
+        std::vector<SwitchRequest> requests = random_requests(rng, 4, 0);
+        if (requests.empty())
+            continue;
+        Cycles oldest = requests[0].age;
+        for (int i = 1; i < requests.size(); i++)
+            oldest = std::min(oldest, requests[i].age);
+        std::vector<SwitchRequest> grants;
+        arbiter->allocate(requests, grants);
+        ASSERT_FALSE(grants.empty());
+        EXPECT_EQ(uint64_t(grants[0].age), uint64_t(oldest));
+    }
+}
+
+// The round robin pointer of an outport moves one inport per grant:
+// an inport contending for it is granted within a turn of the pointer
+TEST(SwitchArbiterTest, SeparableRoundRobin)
+{
+    std::unique_ptr<SwitchArbiter> arbiter(
+        SwitchArbiter::create("separable", num_ports, num_ports, 1));
+    std::vector<SwitchRequest> requests;
+    requests.push_back(SwitchRequest(1, 0, 4, Cycles(0), false));
+    requests.push_back(SwitchRequest(2, 0, 4, Cycles(0), false));
+    for (int turn = 0; turn < 3; turn++) {
+        std::vector<int> num_grants(num_ports, 0);
+        for (int cycle = 0; cycle < num_ports; cycle++) {
+            std::vector<SwitchRequest> grants;
+            arbiter->allocate(requests, grants);
+            ASSERT_EQ(grants.size(), 1);
+            num_grants[grants[0].inport]++;
+        }
+        EXPECT_GE(num_grants[1], 1);
+        EXPECT_GE(num_grants[2], 1);
+    }
+}
+
+// Under full load every inport requests every outport: the iSLIP
+// pointers desynchronize and the wavefront diagonals are perfect
+// matchings, so both reach a full matching
+TEST(SwitchArbiterTest, FullLoadThroughput)
+{
+    std::vector<SwitchRequest> requests;
+    for (int inport = 0; inport < num_ports; inport++) {
+        for (int outport = 0; outport < num_ports; outport++) {
+            requests.push_back(SwitchRequest(inport, outport, outport,
+                                             Cycles(0), false));
+        }
+    }
+    const char *full[] = {"islip", "wavefront"};
+    for (int a = 0; a < 2; a++) {
+        std::unique_ptr<SwitchArbiter> arbiter(
+            SwitchArbiter::create(full[a], num_ports, num_ports, 1));
+        std::vector<SwitchRequest> grants;
+        for (int cycle = 0; cycle < num_ports; cycle++)
+            arbiter->allocate(requests, grants);
+        for (int cycle = 0; cycle < 10; cycle++) {
+            arbiter->allocate(requests, grants);
+            EXPECT_EQ(grants.size(), num_ports) << full[a];
+        }
+    }
+}
+
+TEST(SwitchArbiterTest, UnknownArbiter)
+{
+    EXPECT_FATAL(SwitchArbiter::create("fifo", num_ports, num_ports, 1),
+                 "Unknown switch allocator 'fifo'");
+    EXPECT_FATAL(SwitchArbiter::create("islip", num_ports, num_ports, 0),
+                 "at least one iteration");
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mem/ruby/network/garnet2.0/TopologyFile.hh"
+
+// fatal() adds a failure and throws (see base/gtest/logging.cc)
+#define EXPECT_FATAL(statement, message)                        \
+    EXPECT_NONFATAL_FAILURE({ try { statement; } catch (...) {} }, message)
+
+typedef std::vector<std::pair<int, int> > LinkList;
+typedef std::set<std::pair<int, int> > LinkSet;
+
+// A topology file holding 'contents', removed at the end of the test
+struct TopologyTempFile
+{
+    std::string name;
+
+    TopologyTempFile(const std::string& contents)
+    {
+        char path[] = "/tmp/topologyfiletest.XXXXXX";
+        int fd = mkstemp(path);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(write(fd, contents.data(), contents.size()),
+                  (ssize_t) contents.size());
+        close(fd);
+        name = path;
+    }
+    ~TopologyTempFile() { unlink(name.c_str()); }
+};
+
+// every router reaches every other one over the (directed) links
+static bool
+strongly_connected(int num_routers, const LinkList& links)
+{
+    std::vector<std::vector<int> > out(num_routers), in(num_routers);
+    for (int i = 0; i < links.size(); i++) {
+        out[links[i].first].push_back(links[i].second);
+        in[links[i].second].push_back(links[i].first);
+    }
+    // router 0 reaches every router, and every router reaches it
+    for (int dir = 0; dir < 2; dir++) {
+        const std::vector<std::vector<int> >& adj = dir ? in : out;
+        std::vector<bool> seen(num_routers, false);
+        std::queue<int> bfs;
+        seen[0] = true;
+        bfs.push(0);
+        int num_seen = 1;
+        while (!bfs.empty()) {
+            int v = bfs.front();
+            bfs.pop();
+            for (int i = 0; i < adj[v].size(); i++) {
+                if (!seen[adj[v][i]]) {
+                    seen[adj[v][i]] = true;
+                    num_seen++;
+                    bfs.push(adj[v][i]);
+                }
+            }
+        }
+        if (num_seen != num_routers)
+            return false;
+    }
+    return true;
+}
+
+static int
+mesh_links(int rows, int cols)
+{
+    return (rows - 1) * cols + rows * (cols - 1);
+}
+
+TEST(TopologyFileTest, GeneratedStaysConnected)
+{
+    for (int rows = 2; rows <= 6; rows++) {
+        for (int cols = 2; cols <= 6; cols++) {
+            int max_removed = mesh_links(rows, cols) - (rows * cols - 1);
+            for (int removed = 0; removed <= max_removed; removed++) {
+                for (uint32_t seed = 1; seed <= 3; seed++) {
+                    TopologyFile topology = TopologyFile::generate(
+                        rows, cols, removed, 0.0, seed);
+                    const LinkList& links = topology.get_links();
+                    // both directions of the links left
+                    ASSERT_EQ(links.size(),
+                              2 * (mesh_links(rows, cols) - removed));
+                    LinkSet all(links.begin(), links.end());
+                    for (int i = 0; i < links.size(); i++) {
+                        EXPECT_TRUE(all.count(std::make_pair(
+                            links[i].second, links[i].first)));
+                    }
+                    ASSERT_TRUE(strongly_connected(rows * cols, links))
+                        << rows << "x" << cols << " without " << removed
+                        << " links, seed " << seed;
+                }
+            }
+        }
+    }
+}
+
+TEST(TopologyFileTest, GeneratedWithFaultProbability)
+{
+    // no faults: the full mesh; all faults: a spanning tree
+    TopologyFile full = TopologyFile::generate(8, 8, 0, 0.0, 1);
+    EXPECT_EQ(full.get_links().size(), 2 * mesh_links(8, 8));
+    TopologyFile tree = TopologyFile::generate(8, 8, 0, 1.0, 1);
+    EXPECT_EQ(tree.get_links().size(), 2 * (64 - 1));
+    EXPECT_TRUE(strongly_connected(64, tree.get_links()));
+
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        TopologyFile topology = TopologyFile::generate(8, 8, 0, 0.3, seed);
+        EXPECT_TRUE(strongly_connected(64, topology.get_links()));
+        EXPECT_LT(topology.get_links().size(), 2 * mesh_links(8, 8));
+    }
+}
+
+TEST(TopologyFileTest, GeneratedIsReproducible)
+{
+    TopologyFile a = TopologyFile::generate(16, 16, 100, 0.0, 7);
+    TopologyFile b = TopologyFile::generate(16, 16, 100, 0.0, 7);
+    TopologyFile c = TopologyFile::generate(16, 16, 100, 0.0, 8);
+    EXPECT_EQ(a.get_links(), b.get_links());
+    EXPECT_NE(a.get_links(), c.get_links());
+}
+
+TEST(TopologyFileTest, TooManyRemoved)
+{
+    // a 3x3 mesh has 12 links, and keeps a spanning tree of 8
+    EXPECT_FATAL(TopologyFile::generate(3, 3, 5, 0.0, 1),
+                 "cannot remove 5 of its 12 links, at most 4");
+}
+
+// a closed walk from router 0 over every link once, entering each
+// router through the inport of the link
+TEST(TopologyFileTest, SpinRingCoversLinks)
+{
+    for (uint32_t seed = 1; seed <= 10; seed++) {
+        TopologyFile topology = TopologyFile::generate(6, 5, 8, 0.0, seed);
+        std::vector<std::pair<int, PortDirection> > ring =
+            topology.get_spin_ring();
+        ASSERT_EQ(ring.size() + 1, topology.get_links().size());
+
+        LinkSet used;
+        int router = 0;
+        for (int i = 0; i <= ring.size(); i++) {
+            int next = (i < ring.size()) ? ring[i].first : 0;
+            PortDirection src_outport, dst_inport;
+            topology.get_directions(router, next, src_outport, dst_inport);
+            if (i < ring.size()) {
+                EXPECT_EQ(ring[i].second, dst_inport);
+            }
+            EXPECT_TRUE(used.insert(std::make_pair(router, next)).second);
+            router = next;
+        }
+        const LinkList& links = topology.get_links();
+        LinkSet all(links.begin(), links.end());
+        EXPECT_EQ(used, all);
+    }
+}
+
+TEST(TopologyFileTest, MatrixRoundTrip)
+{
+    TopologyFile topology = TopologyFile::generate(4, 5, 6, 0.0, 3);
+    std::ostringstream matrix;
+    topology.write_matrix(matrix);
+    TopologyTempFile file(matrix.str());
+    TopologyFile parsed(file.name);
+    EXPECT_EQ(parsed.get_rows(), 4);
+    EXPECT_EQ(parsed.get_cols(), 5);
+    EXPECT_EQ(parsed.get_links(), topology.get_links());
+}
+
+TEST(TopologyFileTest, EdgeList)
+{
+    // 1 x 3 mesh, links 0 <-> 1 and 1 -> 2
+    uint32_t words[] = {1, 1, 3, 3, 0, 1, 1, 0, 1, 2};
+    std::string contents("GNTP");
+    for (int i = 0; i < 10; i++) {
+        for (int byte = 0; byte < 4; byte++)
+            contents += (char) ((words[i] >> (8 * byte)) & 0xff);
+    }
+    TopologyTempFile file(contents);
+    TopologyFile parsed(file.name);
+    EXPECT_EQ(parsed.get_rows(), 1);
+    EXPECT_EQ(parsed.get_cols(), 3);
+    LinkList expected = {{0, 1}, {1, 0}, {1, 2}};
+    EXPECT_EQ(parsed.get_links(), expected);
+
+    PortDirection src_outport, dst_inport;
+    parsed.get_directions(1, 2, src_outport, dst_inport);
+    EXPECT_EQ(src_outport, "East");
+    EXPECT_EQ(dst_inport, "West");
+
+    TopologyTempFile truncated(contents.substr(0, contents.size() - 4));
+    EXPECT_FATAL(TopologyFile(truncated.name),
+                 "truncated after 2 of 3 links");
+}
+
+TEST(TopologyFileTest, BadLinks)
+{
+    // routers 0 and 3 of a 2x2 mesh are not neighbours
+    TopologyTempFile diagonal("2 2\n\n"
+                              "0 0 0 1\n0 0 0 0\n0 0 0 0\n0 0 0 0\n");
+    EXPECT_FATAL(TopologyFile(diagonal.name),
+                 "routers 0 and 3 are not neighbours");
+
+    TopologyTempFile short_matrix("2 2\n\n0 1 1 0\n1 0\n");
+    EXPECT_FATAL(TopologyFile(short_matrix.name),
+                 "expected 4 x 4 entries");
+}
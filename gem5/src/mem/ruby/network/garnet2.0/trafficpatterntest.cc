@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2026 The DRAIN contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: see the git history of this file
+ */
+
+
+#include <gtest/gtest-spi.h>
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "mem/ruby/network/garnet2.0/TrafficPattern.hh"
+
+// fatal() adds a failure and throws (see base/gtest/logging.cc)
+#define EXPECT_FATAL(statement, message)                        \
+    EXPECT_NONFATAL_FAILURE({ try { statement; } catch (...) {} }, message)
+
+// A pattern file holding 'contents', removed at the end of the test;
+// files are cached by name, so no two of them share one
+struct PatternFile
+{
+    std::string name;
+
+    PatternFile(const std::string& contents)
+    {
+        static int num_files = 0;
+        std::string path = csprintf("/tmp/trafficpatterntest.%d.XXXXXX",
+                                    num_files++);
+        int fd = mkstemp(&path[0]);
+        EXPECT_GE(fd, 0);
+        EXPECT_EQ(write(fd, contents.c_str(), contents.size()),
+                  (ssize_t) contents.size());
+        close(fd);
+        name = path;
+    }
+    ~PatternFile() { unlink(name.c_str()); }
+};
+
+static TrafficPatternConfig
+pattern_config(const std::string& type, int num_dest)
+{
+    TrafficPatternConfig config;
+    config.type = type;
+    config.num_dest = num_dest;
+    config.num_rows = -1;
+    config.hotspot_fraction = 0;
+    return config;
+}
+
+TEST(TrafficPatternTest, PermutationFile)
+{
+    TrafficPatternConfig config = pattern_config("permutation", 4);
+    PatternFile file("2 0 # comment\n3 1\n");
+    config.permutation_file = file.name;
+    CounterRNG rng(1);
+    int expected[] = {2, 0, 3, 1};
+    for (int source = 0; source < 4; source++) {
+        TrafficPattern pattern(config, source);
+        EXPECT_EQ(pattern.destination(rng), expected[source]);
+        EXPECT_EQ(pattern.source_rate(), -1);
+    }
+}
+
+// every entry is checked, whichever source reads the file
+TEST(TrafficPatternTest, PermutationRepeatsDestination)
+{
+    TrafficPatternConfig config = pattern_config("permutation", 4);
+    PatternFile file("1 0 3 3\n");
+    config.permutation_file = file.name;
+    EXPECT_FATAL(TrafficPattern(config, 0),
+                 "is not a permutation");
+}
+
+TEST(TrafficPatternTest, PermutationNotIntegral)
+{
+    TrafficPatternConfig config = pattern_config("permutation", 4);
+    PatternFile file("1 0 2.5 3\n");
+    config.permutation_file = file.name;
+    EXPECT_FATAL(TrafficPattern(config, 0),
+                 "bad destination 2.5");
+}
+
+TEST(TrafficPatternTest, PermutationOutOfRange)
+{
+    TrafficPatternConfig config = pattern_config("permutation", 4);
+    PatternFile file("1 0 2 4\n");
+    config.permutation_file = file.name;
+    EXPECT_FATAL(TrafficPattern(config, 0),
+                 "bad destination 4");
+    PatternFile file2("1 0 -2 3\n");
+    config.permutation_file = file2.name;
+    EXPECT_FATAL(TrafficPattern(config, 0),
+                 "bad destination -2");
+}
+
+TEST(TrafficPatternTest, PermutationWrongSize)
+{
+    TrafficPatternConfig config = pattern_config("permutation", 4);
+    PatternFile file("1 0 2\n");
+    config.permutation_file = file.name;
+    EXPECT_FATAL(TrafficPattern(config, 0),
+                 "3 destinations for 4 sources");
+}
+
+// the fixed patterns map the sources to distinct destinations
+TEST(TrafficPatternTest, FixedPatternsArePermutations)
+{
+    const char *types[] = {"bit_complement", "bit_reverse", "bit_rotation",
+                           "neighbor", "shuffle", "transpose"};
+    CounterRNG rng(1);
+    for (int t = 0; t < 6; t++) {
+        std::set<int> destinations;
+        for (int source = 0; source < 16; source++) {
+            TrafficPattern pattern(pattern_config(types[t], 16), source);
+            int dest = pattern.destination(rng);
+            EXPECT_GE(dest, 0) << types[t];
+            EXPECT_LT(dest, 16) << types[t];
+            destinations.insert(dest);
+        }
+        EXPECT_EQ(destinations.size(), 16) << types[t];
+    }
+}
+
+TEST(TrafficPatternTest, TransposeRectangle)
+{
+    // (x, y) of a 2-row mesh to (y, x) of a 2-column one
+    TrafficPatternConfig config = pattern_config("transpose", 8);
+    config.num_rows = 2;
+    CounterRNG rng(1);
+    int expected[] = {0, 2, 4, 6, 1, 3, 5, 7};
+    for (int source = 0; source < 8; source++) {
+        TrafficPattern pattern(config, source);
+        EXPECT_EQ(pattern.destination(rng), expected[source]);
+    }
+}
+
+TEST(TrafficPatternTest, UniformRandomCoversDestinations)
+{
+    TrafficPattern pattern(pattern_config("uniform_random", 8), 0);
+    CounterRNG rng(5);
+    std::vector<int> counts(8, 0);
+    for (int i = 0; i < 8000; i++) {
+        int dest = pattern.destination(rng);
+        ASSERT_GE(dest, 0);
+        ASSERT_LT(dest, 8);
+        counts[dest]++;
+    }
+    for (int dest = 0; dest < 8; dest++)
+        EXPECT_GT(counts[dest], 800);
+}
+
+TEST(TrafficPatternTest, HotspotOnly)
+{
+    TrafficPatternConfig config = pattern_config("hotspot", 16);
+    config.hotspot_nodes = {3, 12};
+    config.hotspot_fraction = 1.0;
+    TrafficPattern pattern(config, 0);
+    CounterRNG rng(5);
+    for (int i = 0; i < 100; i++) {
+        int dest = pattern.destination(rng);
+        EXPECT_TRUE((dest == 3) || (dest == 12));
+    }
+}
+
+TEST(TrafficPatternTest, HotspotNotADestination)
+{
+    TrafficPatternConfig config = pattern_config("hotspot", 16);
+    config.hotspot_nodes = {16};
+    EXPECT_FATAL(TrafficPattern(config, 0),
+                 "hotspot node 16 is not a destination");
+}
+
+// the alias table draws each destination in proportion to its rate
+TEST(TrafficPatternTest, RateMatrixRow)
+{
+    TrafficPatternConfig config = pattern_config("rate_matrix", 3);
+    PatternFile file("0 0 0\n"
+                     "0.1 0 0.3\n"
+                     "0 0 0\n");
+    config.rate_matrix_file = file.name;
+    TrafficPattern pattern(config, 1);
+    EXPECT_DOUBLE_EQ(pattern.source_rate(), 0.4);
+    CounterRNG rng(3);
+    std::vector<int> counts(3, 0);
+    for (int i = 0; i < 40000; i++)
+        counts[pattern.destination(rng)]++;
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(counts[0] / 40000.0, 0.25, 0.01);
+    EXPECT_NEAR(counts[2] / 40000.0, 0.75, 0.01);
+
+    TrafficPattern idle(config, 0);
+    EXPECT_EQ(idle.source_rate(), 0);
+}
+
+TEST(InjectionProcessTest, NeverAtZeroRate)
+{
+    CounterRNG rng(1);
+    InjectionProcess process(0, 3, SKIP_GEOMETRIC_, 0, 0, rng);
+    EXPECT_EQ(process.gap(rng), INJECTION_NEVER);
+    for (int i = 0; i < 100; i++)
+        EXPECT_FALSE(process.trial(rng));
+}
+
+TEST(InjectionProcessTest, TrialRate)
+{
+    CounterRNG rng(2);
+    InjectionProcess process(0.1, 3, NO_SKIP_, 0, 0, rng);
+    int injections = 0;
+    for (int i = 0; i < 100000; i++)
+        injections += process.trial(rng);
+    EXPECT_NEAR(injections / 100000.0, injection_probability(0.1, 3),
+                0.005);
+}
+
+// skip-ahead compatible with a trial every cycle: the same cycles
+TEST(InjectionProcessTest, SeedCompatibleGaps)
+{
+    CounterRNG trial_rng(4), gap_rng(4);
+    InjectionProcess trials(0.05, 3, NO_SKIP_, 0, 0, trial_rng);
+    InjectionProcess gaps(0.05, 3, SKIP_SEED_COMPAT_, 0, 0, gap_rng);
+    uint64_t cycle = 0, next = 0;
+    for (int i = 0; i < 100; i++) {
+        next += gaps.gap(gap_rng);
+        do {
+            cycle++;
+        } while (!trials.trial(trial_rng));
+        EXPECT_EQ(cycle, next);
+    }
+}
+
+TEST(InjectionProcessTest, GeometricGapMean)
+{
+    CounterRNG rng(6);
+    InjectionProcess process(0.02, 3, SKIP_GEOMETRIC_, 0, 0, rng);
+    double sum = 0;
+    for (int i = 0; i < 20000; i++) {
+        uint64_t gap = process.gap(rng);
+        ASSERT_GE(gap, 1);
+        sum += gap;
+    }
+    EXPECT_NEAR(sum / 20000, 1 / injection_probability(0.02, 3), 1.5);
+}
+
+// bursts keep the average rate
+TEST(InjectionProcessTest, BurstyAverageRate)
+{
+    CounterRNG rng(8);
+    InjectionProcess process(0.05, 3, SKIP_GEOMETRIC_, 20, 60, rng);
+    uint64_t cycles = 0;
+    int injections = 20000;
+    for (int i = 0; i < injections; i++)
+        cycles += process.gap(rng);
+    EXPECT_NEAR((double) injections / cycles, 0.05, 0.005);
+}
+
+TEST(InjectionProcessTest, BurstRateTooHigh)
+{
+    CounterRNG rng(8);
+    EXPECT_FATAL(InjectionProcess(0.5, 3, NO_SKIP_, 10, 30, rng),
+                 "too high for the burst");
+}
@@ -0,0 +1,104 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2026 The DRAIN contributors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: see the git history of this file
+
+# This script converts a text network trace for garnet2.0 trace replay
+# (--network-trace-enable) into the binary format read by
+# src/mem/ruby/network/garnet2.0/NetworkTraceReader.cc.
+#
+# The text trace has one packet per line:
+# <cycle> <src-ni> <dest-ni> <vnet> <num-flits>
+# Lines starting with '#' or "info" are header lines and are skipped.
+#
+# The binary trace is the magic "GNTR", a uint32 version and a uint64
+# number of packets, followed by one 24-byte record per packet:
+# uint64 cycle, uint32 src-ni, uint32 dest-ni, uint16 vnet,
+# uint16 num-flits and uint32 reserved (all little endian).
+#
+# Either file is gzipped if its name ends in ".gz". Name the output
+# *.gntr or *.gntr.gz for gem5 to read it as a binary trace.
+
+import gzip
+import struct
+import sys
+
+MAGIC = "GNTR"
+VERSION = 1
+HEADER = struct.Struct("<4sIQ")
+RECORD = struct.Struct("<QIIHHI")
+
+def open_trace(name, mode):
+    if name.endswith(".gz"):
+        return gzip.open(name, mode)
+    return open(name, mode)
+
+def main():
+    if len(sys.argv) != 3:
+        print "Usage: ", sys.argv[0], " <text trace> <binary trace>"
+        exit(-1)
+
+    try:
+        text_in = open_trace(sys.argv[1], 'r')
+    except IOError:
+        print "Failed to open ", sys.argv[1], " for reading"
+        exit(-1)
+
+    try:
+        bin_out = open_trace(sys.argv[2], 'wb')
+    except IOError:
+        print "Failed to open ", sys.argv[2], " for writing"
+        exit(-1)
+
+    # the number of packets is patched in at the end when the output
+    # is seekable; 0 means unknown
+    bin_out.write(HEADER.pack(MAGIC, VERSION, 0))
+
+    num_packets = 0
+    for line_num, line in enumerate(text_in, 1):
+        line = line.strip()
+        if not line or line.startswith('#') or line.startswith("info"):
+            continue
+        fields = line.split()
+        if len(fields) < 5:
+            print "%s:%d: bad trace record" % (sys.argv[1], line_num)
+            exit(-1)
+        cycle, src, dest, vnet, num_flits = [long(f) for f in fields[:5]]
+        bin_out.write(RECORD.pack(cycle, src, dest, vnet, num_flits, 0))
+        num_packets += 1
+
+    if not sys.argv[2].endswith(".gz"):
+        bin_out.seek(0)
+        bin_out.write(HEADER.pack(MAGIC, VERSION, num_packets))
+
+    text_in.close()
+    bin_out.close()
+    print "Wrote %d packets to %s" % (num_packets, sys.argv[2])
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,108 @@
+#!/usr/bin/env python2
+
+# Copyright (c) 2026 The DRAIN contributors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: see the git history of this file
+
+# This script converts a text connectivity matrix of a (possibly
+# irregular) mesh, as used by configs/topologies/irregularMesh_XY.py,
+# into the binary edge list read by
+# src/mem/ruby/network/garnet2.0/TopologyFile.cc.
+#
+# The text matrix starts with a "<rows> <cols>" line and a separator
+# line, followed by one line of rows*cols entries per router: entry j
+# of line i is 1 if there is a link from router i to router j.
+#
+# The binary edge list is the magic "GNTP" and four uint32: version,
+# rows, cols and number of links, followed by one uint32 pair
+# (source router, destination router) per link (all little endian).
+
+import struct
+import sys
+
+MAGIC = "GNTP"
+VERSION = 1
+HEADER = struct.Struct("<4sIIII")
+LINK = struct.Struct("<II")
+
+def main():
+    if len(sys.argv) != 3:
+        print "Usage: ", sys.argv[0], " <connectivity matrix> <edge list>"
+        exit(-1)
+
+    try:
+        text_in = open(sys.argv[1], 'r')
+    except IOError:
+        print "Failed to open ", sys.argv[1], " for reading"
+        exit(-1)
+
+    fields = text_in.readline().split()
+    if len(fields) < 2:
+        print "%s: no '<rows> <cols>' line" % sys.argv[1]
+        exit(-1)
+    rows, cols = int(fields[0]), int(fields[1])
+    num_routers = rows * cols
+    text_in.readline() # separator
+
+    # only the links are kept, never the whole matrix; whatever
+    # follows the matrix (e.g. a spin ring) is ignored
+    links = []
+    src = 0
+    for line in text_in:
+        if src == num_routers:
+            break
+        entries = line.split()
+        if not entries:
+            continue
+        if len(entries) != num_routers:
+            print "%s: expected %d lines of %d entries" % \
+                (sys.argv[1], num_routers, num_routers)
+            exit(-1)
+        links.extend((src, dest) for dest, entry in enumerate(entries)
+                     if entry == "1")
+        src += 1
+    text_in.close()
+    if src != num_routers:
+        print "%s: expected %d lines of %d entries" % \
+            (sys.argv[1], num_routers, num_routers)
+        exit(-1)
+
+    try:
+        bin_out = open(sys.argv[2], 'wb')
+    except IOError:
+        print "Failed to open ", sys.argv[2], " for writing"
+        exit(-1)
+
+    bin_out.write(HEADER.pack(MAGIC, VERSION, rows, cols, len(links)))
+    for link in links:
+        bin_out.write(LINK.pack(*link))
+    bin_out.close()
+    print "Wrote %d links between %d routers to %s" % \
+        (len(links), num_routers, sys.argv[2])
+
+if __name__ == "__main__":
+    main()